@@ -1,25 +1,54 @@
 #include "charon/charon/charon.h"
 #include "charon/processor/processor_config.h"
+#include "charon/processor/processor_matcher_index.h"
 #include "charon/util/logger.h"
 #include "charon/watcher/directory_watcher_factory.h"
 
 #include <algorithm>
 #include <vector>
 
+namespace {
+// Directories of the matchers accepted by the filter, each listed once. A directory is handled recursively if at least
+// one of its matchers is recursive. Directories are compared the same way the matcher index does, so every matcher
+// finds events produced for its directory.
+template <typename MatcherFilter>
+std::vector<std::pair<fs::path, bool>> getMatcherDirectories(const ProcessorConfig::Matchers &matchers, MatcherFilter &&filter) {
+    std::vector<std::pair<fs::path, bool>> directories = {};
+    for (const ProcessorActionMatcher &matcher : matchers.matchers) {
+        if (!filter(matcher)) {
+            continue;
+        }
+        const fs::path matcherDirectory = ProcessorMatcherIndex::normalizeWatchedFolder(matcher.watchedFolder);
+        const auto isMatcherDirectory = [&matcherDirectory](const auto &directory) { return directory.first.native() == matcherDirectory.native(); };
+        if (auto it = std::find_if(directories.begin(), directories.end(), isMatcherDirectory); it != directories.end()) {
+            it->second = it->second || matcher.recursive;
+        } else {
+            directories.emplace_back(matcherDirectory, matcher.recursive);
+        }
+    }
+    return directories;
+}
+} // namespace
+
 Charon::Charon(const ProcessorConfig &config, Filesystem &filesystem, DirectoryWatcherFactory &watcherFactory)
-    : deferredFileLocker(deferredFileLockerEventQueue, processorEventQueue, filesystem),
-      processor(config, processorEventQueue, filesystem) {
+    : eventCoalescer(eventCoalescerEventQueue, processorEventQueue, deferredFileLockerEventQueue),
+      deferredFileLocker(deferredFileLockerEventQueue, processorEventQueue, filesystem),
+      processorPool(config, processorEventQueue, filesystem),
+      startupScanner(eventCoalescerEventQueue) {
 
     if (auto matchers = config.matchers(); matchers != nullptr) {
-        std::vector<fs::path> directoriesToWatch = {};
-        for (const ProcessorActionMatcher &matcher : matchers->matchers) {
-            if (std::find(directoriesToWatch.begin(), directoriesToWatch.end(), matcher.watchedFolder) == directoriesToWatch.end()) {
-                directoriesToWatch.push_back(matcher.watchedFolder);
-            }
+        const auto directoriesToWatch = getMatcherDirectories(*matchers, [](const ProcessorActionMatcher &) { return true; });
+        for (const auto &[directoryToWatch, recursive] : directoriesToWatch) {
+            this->directoryWatchers.push_back(watcherFactory.create(directoryToWatch, recursive, eventCoalescerEventQueue, eventCoalescerEventQueue));
         }
 
-        for (const fs::path &directoryToWatch : directoriesToWatch) {
-            this->directoryWatchers.push_back(watcherFactory.create(directoryToWatch, processorEventQueue, deferredFileLockerEventQueue));
+        // Scan covers whole directories, so the Processor skips scanned files matched to matchers which didn't request it
+        const auto directoriesToScan = getMatcherDirectories(*matchers, [](const ProcessorActionMatcher &matcher) { return matcher.scanOnStartup; });
+        for (const auto &[directoryToScan, recursive] : directoriesToScan) {
+            startupScanner.addDirectory(directoryToScan, recursive);
+        }
+        if (startupScanner.hasDirectories()) {
+            eventCoalescer.setStartupScanner(startupScanner);
         }
     }
 }
@@ -45,9 +74,14 @@ bool Charon::start() {
         }
     }
 
+    // Run event coalescer
+    eventCoalescerThread = std::make_unique<std::thread>([this]() {
+        eventCoalescer.run();
+    });
+
     // Run processor
     processorThread = std::make_unique<std::thread>([this]() {
-        processor.run();
+        processorPool.run();
     });
 
     // Run deferred file locker
@@ -55,6 +89,11 @@ bool Charon::start() {
         deferredFileLocker.run();
     });
 
+    // Scan directories after watchers have started, so no file is missed. Files reported by both are filtered by the event coalescer.
+    if (startupScanner.hasDirectories()) {
+        startupScanner.start();
+    }
+
     log(LogLevel::Info) << "Charon started";
     isStarted.signal();
     return true;
@@ -65,20 +104,30 @@ bool Charon::stop() {
         return false;
     }
 
-    // Stop deferred file locker
+    // Stop producers first. Consumers are still running, so producers blocked on a full queue can always finish.
+    // Stopping a watcher waits for its thread, which may be blocked pushing to the event coalescer's queue.
+    startupScanner.stop();
+    for (auto &watcher : this->directoryWatchers) {
+        watcher->stop();
+    }
+
+    // Stop consumers in the order of the pipeline. Each of them publishes all pending events before exiting.
+    eventCoalescerEventQueue.push(FileEvent::interruptEvent);
+    eventCoalescerThread->join();
+    eventCoalescerThread = nullptr;
+
     deferredFileLockerEventQueue.push(FileEvent::interruptEvent);
     deferredFileLockerThread->join();
     deferredFileLockerThread = nullptr;
 
-    // Stop processor
     processorEventQueue.push(FileEvent::interruptEvent);
     processorThread->join();
     processorThread = nullptr;
 
-    // Stop watchers
-    for (auto &watcher : this->directoryWatchers) {
-        watcher->stop();
-    }
+    log(LogLevel::VerboseInfo) << "EventCoalescer folded " << eventCoalescer.getCoalescedEventsCount() << " events";
+    logEventQueueStatistics("EventCoalescer", eventCoalescerEventQueue);
+    logEventQueueStatistics("Processor", processorEventQueue);
+    logEventQueueStatistics("DeferredFileLocker", deferredFileLockerEventQueue);
 
     log(LogLevel::Info) << "Charon stopped";
     isStarted.reset();
@@ -89,6 +138,19 @@ void Charon::waitForCompletion() {
     isStarted.wait(false);
 }
 
+void Charon::setEventQueueCapacity(size_t capacity, FileEventQueue::OverflowPolicy overflowPolicy, const fs::path &journalDirectory) {
+    eventCoalescerEventQueue.setCapacity(capacity, overflowPolicy, journalDirectory / "charon_event_coalescer_events.journal");
+    processorEventQueue.setCapacity(capacity, overflowPolicy, journalDirectory / "charon_processor_events.journal");
+    deferredFileLockerEventQueue.setCapacity(capacity, overflowPolicy, journalDirectory / "charon_deferred_file_locker_events.journal");
+    processorPool.setWorkerQueueCapacity(capacity, overflowPolicy, journalDirectory);
+}
+
+void Charon::logEventQueueStatistics(const char *queueName, const FileEventQueue &queue) {
+    log(LogLevel::VerboseInfo) << queueName << " event queue: highWaterMark=" << queue.getHighWaterMark()
+                               << ", spilledEvents=" << queue.getSpilledEventsCount()
+                               << ", coalescedEvents=" << queue.getCoalescedEventsCount();
+}
+
 void Charon::processImmediate(const std::vector<fs::path> &paths) {
     for (auto &path : paths) {
         FileEvent event = {};
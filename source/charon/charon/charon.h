@@ -1,11 +1,13 @@
 #pragma once
 
 #include "charon/processor/deferred_file_locker.h"
-#include "charon/processor/processor.h"
+#include "charon/processor/event_coalescer.h"
+#include "charon/processor/processor_pool.h"
 #include "charon/util/class_traits.h"
 #include "charon/util/filesystem.h"
 #include "charon/util/notification.h"
 #include "charon/watcher/directory_watcher.h"
+#include "charon/watcher/startup_scanner.h"
 
 #include <vector>
 
@@ -21,15 +23,31 @@ public:
 
     void processImmediate(const std::vector<fs::path> &paths);
 
+    // Has to be called before start(). Journal directory is used only with OverflowPolicy::Spill.
+    void setEventQueueCapacity(size_t capacity, FileEventQueue::OverflowPolicy overflowPolicy, const fs::path &journalDirectory);
+    // Has to be called before start(). Window equal to 0 disables coalescing.
+    void setEventCoalescingWindow(std::chrono::milliseconds window) { eventCoalescer.setWindow(window); }
+    // Has to be called before start(). Max wait equal to 0 means waiting indefinitely for files used by other processes.
+    void setFileLockingMaxWait(std::chrono::milliseconds maxWait) { deferredFileLocker.setMaxWait(maxWait); }
+    // Has to be called before start(). Rate equal to 0 means no limit.
+    void setStartupScanRateLimit(size_t filesPerSecond) { startupScanner.setRateLimit(filesPerSecond); }
+    // Has to be called before start()
+    void setProcessorWorkersCount(size_t workersCount) { processorPool.setWorkersCount(workersCount); }
+    // Has to be called before start(). Depth equal to 0 executes filesystem operations synchronously.
+    void setFilesystemQueueDepth(size_t depth) { processorPool.setFilesystemQueueDepth(depth); }
+
     void setLogFilePath(const fs::path &path) { logFilePath = path; }
     void setConfigFilePath(const fs::path &path) { configFilePath = path; }
     auto &getLogFilePath() const { return logFilePath; }
     auto &getConfigFilePath() const { return configFilePath; }
 
 private:
+    static void logEventQueueStatistics(const char *queueName, const FileEventQueue &queue);
+
     // Components
+    EventCoalescer eventCoalescer;
     DeferredFileLocker deferredFileLocker;
-    Processor processor;
+    ProcessorPool processorPool;
     std::vector<std::unique_ptr<DirectoryWatcher>> directoryWatchers{};
 
     // Saved file paths
@@ -37,13 +55,18 @@ private:
     fs::path configFilePath;
 
     // Threads for running the components
+    std::unique_ptr<std::thread> eventCoalescerThread{};
     std::unique_ptr<std::thread> processorThread{};
     std::unique_ptr<std::thread> deferredFileLockerThread{};
 
     // Queues for communication between components
+    FileEventQueue eventCoalescerEventQueue{};
     FileEventQueue processorEventQueue{};
     FileEventQueue deferredFileLockerEventQueue{};
 
+    // Declared after the queues, so they are initialized before it
+    StartupScanner startupScanner;
+
     // Basic data
     Notification isStarted{};
 };
@@ -4,43 +4,102 @@
 #include "charon/user_interface/console_user_interface.h"
 #include "charon/user_interface/daemon_user_interface.h"
 #include "charon/util/argument_parser.h"
+#include "charon/util/async_logger.h"
+#include "charon/util/binary_logger.h"
 #include "charon/util/filesystem_impl.h"
 #include "charon/util/logger.h"
 #include "charon/util/time.h"
 #include "charon/watcher/directory_watcher_factory.h"
 
+#include <memory>
+#include <optional>
+
 int charonMain(int argc, char **argv, bool isDaemon) {
     ArgumentParser argParser{argc, argv};
     const fs::path logPath = argParser.getArgumentValue<fs::path>(ArgNames{"-l", "--log"}, {});
+    const std::string logFormatName = argParser.getArgumentValue<std::string>(ArgNames{"--log-format"}, "text");
+    const size_t logMaxSize = argParser.getArgumentValue<size_t>(ArgNames{"--log-max-size"}, 0u);
+    const size_t logMaxAge = argParser.getArgumentValue<size_t>(ArgNames{"--log-max-age"}, 0u);
     const fs::path configPath = argParser.getArgumentValue<fs::path>(ArgNames{"-c", "--config"}, fs::current_path() / "config.json");
     const bool verbose = argParser.getArgumentValue<bool>(ArgNames{"-v", "--verbose"}, false);
     const bool isImmediateMode = argParser.getArgumentValue<bool>(ArgNames{"-i", "--immediate"}, false);
     const std::vector<fs::path> immediateModePaths = argParser.getArgumentValues<fs::path>(ArgNames{"-f", "--immediate-files"});
+    const std::string watcherBackendName = argParser.getArgumentValue<std::string>(ArgNames{"--watcher-backend"}, "per-directory");
+    const size_t watcherBufferSize = argParser.getArgumentValue<size_t>(ArgNames{"--watcher-buffer-size"}, DirectoryWatcherFactoryImpl::defaultReadBufferSize);
+    const size_t processorWorkersCount = argParser.getArgumentValue<size_t>(ArgNames{"--processor-workers"}, 1u);
+    const size_t filesystemQueueDepth = argParser.getArgumentValue<size_t>(ArgNames{"--filesystem-queue-depth"}, 0u);
+    const size_t eventCoalescingWindow = argParser.getArgumentValue<size_t>(ArgNames{"--coalescing-window"}, 0u);
+    const size_t startupScanRateLimit = argParser.getArgumentValue<size_t>(ArgNames{"--startup-scan-rate"}, 1000u);
+    const size_t fileLockingMaxWait = argParser.getArgumentValue<size_t>(ArgNames{"--lock-max-wait"}, 0u);
+    const size_t queueCapacity = argParser.getArgumentValue<size_t>(ArgNames{"--queue-capacity"}, 0u);
+    const std::string queueOverflowPolicyName = argParser.getArgumentValue<std::string>(ArgNames{"--queue-overflow-policy"}, "block");
+    const fs::path queueJournalDirectory = argParser.getArgumentValue<fs::path>(ArgNames{"--queue-journal-dir"}, fs::temp_directory_path());
+    const size_t logQueueCapacity = argParser.getArgumentValue<size_t>(ArgNames{"--log-queue-capacity"}, 0u);
+    const std::string logOverflowPolicyName = argParser.getArgumentValue<std::string>(ArgNames{"--log-overflow-policy"}, "block");
 
     // Setup logger
     LogLevel allowedLogLevels = defaultLogLevel;
     if (verbose) {
         allowedLogLevels = allowedLogLevels | LogLevel::VerboseInfo;
     }
+    const bool isBinaryLog = logFormatName == "binary";
+    LogRotationPolicy logRotationPolicy{};
+    logRotationPolicy.maxSize = static_cast<uint64_t>(logMaxSize) * 1024 * 1024;
+    logRotationPolicy.maxAge = std::chrono::hours(logMaxAge);
     TimeImpl time{};
-    FileLogger fileLogger{time, logPath, allowedLogLevels};
+    FileLogger fileLogger{time, isBinaryLog ? fs::path{} : logPath, allowedLogLevels, logRotationPolicy};
     ConsoleLogger consoleLogger{time, allowedLogLevels};
+    std::unique_ptr<BinaryLogger> binaryLogger{};
     MultiplexedLogger logger{};
     if (!isDaemon) {
         logger.add(&consoleLogger);
     }
-    if (!logPath.empty()) {
+    if (!logPath.empty() && isBinaryLog) {
+        binaryLogger = std::make_unique<BinaryLogger>(logPath, allowedLogLevels);
+        logger.add(binaryLogger.get());
+    } else if (!logPath.empty()) {
         logger.add(&fileLogger);
     }
-    const auto loggerSetup = logger.raiiSetup();
+
+    std::optional<AsyncLogger::OverflowPolicy> logOverflowPolicy{};
+    if (logOverflowPolicyName == "block") {
+        logOverflowPolicy = AsyncLogger::OverflowPolicy::Block;
+    } else if (logOverflowPolicyName == "drop") {
+        logOverflowPolicy = AsyncLogger::OverflowPolicy::Drop;
+    }
+
+    std::unique_ptr<AsyncLogger> asyncLogger{};
+    Logger *activeLogger = &logger;
+    if (logQueueCapacity > 0 && logOverflowPolicy.has_value()) {
+        fileLogger.setAutoFlush(false);
+        consoleLogger.setAutoFlush(false);
+        asyncLogger = std::make_unique<AsyncLogger>(logger, logQueueCapacity, logOverflowPolicy.value());
+        activeLogger = asyncLogger.get();
+    }
+    const auto loggerSetup = activeLogger->raiiSetup();
 
     // Log arguments
     log(LogLevel::Info) << "";
     log(LogLevel::Info) << "Arguments:";
     log(LogLevel::Info) << "    logPath = " << logPath;
+    log(LogLevel::Info) << "    logFormat = " << logFormatName;
+    log(LogLevel::Info) << "    logMaxSize = " << logMaxSize;
+    log(LogLevel::Info) << "    logMaxAge = " << logMaxAge;
     log(LogLevel::Info) << "    configPath = " << configPath;
     log(LogLevel::Info) << "    isDaemon = " << isDaemon;
     log(LogLevel::Info) << "    isImmediateMode = " << isImmediateMode;
+    log(LogLevel::Info) << "    watcherBackend = " << watcherBackendName;
+    log(LogLevel::Info) << "    watcherBufferSize = " << watcherBufferSize;
+    log(LogLevel::Info) << "    processorWorkersCount = " << processorWorkersCount;
+    log(LogLevel::Info) << "    filesystemQueueDepth = " << filesystemQueueDepth;
+    log(LogLevel::Info) << "    eventCoalescingWindow = " << eventCoalescingWindow;
+    log(LogLevel::Info) << "    fileLockingMaxWait = " << fileLockingMaxWait;
+    log(LogLevel::Info) << "    startupScanRateLimit = " << startupScanRateLimit;
+    log(LogLevel::Info) << "    queueCapacity = " << queueCapacity;
+    log(LogLevel::Info) << "    queueOverflowPolicy = " << queueOverflowPolicyName;
+    log(LogLevel::Info) << "    queueJournalDirectory = " << queueJournalDirectory;
+    log(LogLevel::Info) << "    logQueueCapacity = " << logQueueCapacity;
+    log(LogLevel::Info) << "    logOverflowPolicy = " << logOverflowPolicyName;
     if (isImmediateMode) {
         auto logLine = log(LogLevel::Info);
         logLine << "    immediateModePaths = {";
@@ -64,6 +123,48 @@ int charonMain(int argc, char **argv, bool isDaemon) {
         return EXIT_SUCCESS;
     }
 
+    DirectoryWatcherFactoryImpl::Backend watcherBackend{};
+    if (watcherBackendName == "auto") {
+        watcherBackend = DirectoryWatcherFactoryImpl::Backend::Auto;
+    } else if (watcherBackendName == "per-directory") {
+        watcherBackend = DirectoryWatcherFactoryImpl::Backend::PerDirectory;
+    } else if (watcherBackendName == "mount-wide") {
+        watcherBackend = DirectoryWatcherFactoryImpl::Backend::MountWide;
+    } else {
+        log(LogLevel::Error) << "Invalid watcher backend: " << watcherBackendName << ". Valid values are auto, per-directory and mount-wide.";
+        return EXIT_FAILURE;
+    }
+
+    FileEventQueue::OverflowPolicy queueOverflowPolicy{};
+    if (queueOverflowPolicyName == "block") {
+        queueOverflowPolicy = FileEventQueue::OverflowPolicy::Block;
+    } else if (queueOverflowPolicyName == "spill") {
+        queueOverflowPolicy = FileEventQueue::OverflowPolicy::Spill;
+    } else if (queueOverflowPolicyName == "coalesce") {
+        queueOverflowPolicy = FileEventQueue::OverflowPolicy::Coalesce;
+    } else {
+        log(LogLevel::Error) << "Invalid queue overflow policy: " << queueOverflowPolicyName << ". Valid values are block, spill and coalesce.";
+        return EXIT_FAILURE;
+    }
+
+    if (logFormatName != "text" && logFormatName != "binary") {
+        log(LogLevel::Error) << "Invalid log format: " << logFormatName << ". Valid values are text and binary.";
+        return EXIT_FAILURE;
+    }
+    if (isBinaryLog && logRotationPolicy.isEnabled()) {
+        log(LogLevel::Error) << "Log rotation is supported only for the text log format.";
+        return EXIT_FAILURE;
+    }
+    if (binaryLogger != nullptr && !binaryLogger->isOpen()) {
+        log(LogLevel::Error) << "Could not open log file " << logPath;
+        return EXIT_FAILURE;
+    }
+
+    if (!logOverflowPolicy.has_value()) {
+        log(LogLevel::Error) << "Invalid log overflow policy: " << logOverflowPolicyName << ". Valid values are block and drop.";
+        return EXIT_FAILURE;
+    }
+
     // Read config
     ProcessConfigReader reader{};
     ProcessorConfig config{};
@@ -81,10 +182,16 @@ int charonMain(int argc, char **argv, bool isDaemon) {
 
     // Run Charon
     FilesystemImpl filesystem{};
-    DirectoryWatcherFactoryImpl watcherFactory{};
+    DirectoryWatcherFactoryImpl watcherFactory{watcherBackend, watcherBufferSize};
     Charon charon{config, filesystem, watcherFactory};
     charon.setLogFilePath(logPath);
     charon.setConfigFilePath(configPath);
+    charon.setEventQueueCapacity(queueCapacity, queueOverflowPolicy, queueJournalDirectory);
+    charon.setEventCoalescingWindow(std::chrono::milliseconds(eventCoalescingWindow));
+    charon.setFileLockingMaxWait(std::chrono::milliseconds(fileLockingMaxWait));
+    charon.setStartupScanRateLimit(startupScanRateLimit);
+    charon.setProcessorWorkersCount(processorWorkersCount);
+    charon.setFilesystemQueueDepth(filesystemQueueDepth);
     if (!charon.start()) {
         log(LogLevel::Error) << "Error starting Charon.";
         return EXIT_FAILURE;
@@ -2,72 +2,134 @@
 #include "charon/util/error.h"
 #include "charon/util/logger.h"
 
+#include <algorithm>
+
 DeferredFileLocker::DeferredFileLocker(FileEventQueue &inputQueue, FileEventQueue &outputQueue, Filesystem &filesystem)
     : inputQueue(inputQueue),
       outputQueue(outputQueue),
-      filesystem(filesystem),
-      fetchTimeout(std::chrono::milliseconds(100)) {}
+      filesystem(filesystem) {}
+
+void DeferredFileLocker::setRetryPolicy(std::chrono::milliseconds initialDelay, std::chrono::milliseconds maxDelay, std::chrono::milliseconds maxWait) {
+    this->initialDelay = initialDelay;
+    this->maxDelay = std::max(initialDelay, maxDelay);
+    this->maxWait = maxWait;
+}
 
 void DeferredFileLocker::run() {
     bool running = true;
     while (running) {
-        fetchFromInputQueue();
-        running = !processEvents();
+        running = fetchFromInputQueue();
+
+        // Files waiting for their retry get the last chance before stopping
+        retryDueFiles(Clock::now(), !running);
+        outputQueue.pushBatch(eventsToPublish);
     }
 }
 
-void DeferredFileLocker::fetchFromInputQueue() {
+bool DeferredFileLocker::fetchFromInputQueue() {
     FileEvent event{};
-    if (inputQueue.blockingPop(event, fetchTimeout)) {
-        do {
-            events.push_back(std::move(event));
-        } while (inputQueue.nonBlockingPop(event));
+    bool popped = false;
+    if (scheduledRetries.empty()) {
+        popped = inputQueue.blockingPop(event);
+    } else {
+        const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(scheduledRetries.top().deadline - Clock::now());
+        popped = inputQueue.blockingPop(event, std::max(timeout, std::chrono::milliseconds(0)));
+    }
+    if (!popped) {
+        return true;
     }
-}
-
-bool DeferredFileLocker::processEvents() {
-    bool interrupt = false;
-    for (auto it = events.begin(); it != events.end();) {
-        bool removeFromFurtherChecks = false;
-        bool passToOutputQueue = false;
 
-        if (it->isInterrupt()) {
-            // Interrupt event can be handled immediately (just interrupt the loop),
-            // but we don't pass it through to the output queue
-            interrupt = true;
-            removeFromFurtherChecks = true;
-            passToOutputQueue = false;
+    // Interrupt event can be handled immediately (just interrupt the loop), but we don't pass it through to the output
+    // queue. Events fetched together with it are still handled.
+    bool running = true;
+    const auto now = Clock::now();
+    do {
+        if (event.isInterrupt()) {
+            running = false;
         } else {
-            auto [handle, result] = filesystem.lockFile(it->path);
-            switch (result) {
-            case Filesystem::LockResult::NotSupported:
-            case Filesystem::LockResult::Success:
-                // We have access to the file, we can pass it to the processor
-                it->lockedFileHandle = handle;
-                removeFromFurtherChecks = true;
-                passToOutputQueue = true;
-                break;
-            case Filesystem::LockResult::UsedByOtherProcess:
-                // We don't do anything with this file, maybe it won't be used next time we check
-                break;
-            default:
-                // We're giving up on this file, it's been removed or we don't have access
-                removeFromFurtherChecks = true;
-                passToOutputQueue = false;
-            }
+            addEvent(std::move(event), now);
         }
+    } while (inputQueue.nonBlockingPop(event));
+    return running;
+}
 
-        if (removeFromFurtherChecks) {
-            FileEvent event = std::move(*it);
-            it = events.erase(it);
+void DeferredFileLocker::addEvent(FileEvent &&event, Clock::time_point now) {
+    const PathStringType &path = event.path.native();
+    if (auto it = deferredFiles.find(path); it != deferredFiles.end()) {
+        // Keep the order of events for the same file
+        it->second.events.push_back(std::move(event));
+        return;
+    }
+
+    auto [handle, result] = filesystem.lockFile(event.path);
+    switch (result) {
+    case Filesystem::LockResult::NotSupported:
+    case Filesystem::LockResult::Success:
+        // We have access to the file, we can pass it to the processor
+        event.lockedFileHandle = handle;
+        eventsToPublish.push_back(std::move(event));
+        break;
+    case Filesystem::LockResult::UsedByOtherProcess: {
+        // We don't do anything with this file, maybe it won't be used next time we check
+        DeferredFile file{{}, now, initialDelay};
+        file.events.push_back(std::move(event));
+        auto [it, inserted] = deferredFiles.emplace(file.events.back().path.native(), std::move(file));
+        scheduleRetry(it->first, it->second, now);
+        break;
+    }
+    case Filesystem::LockResult::Unknown:
+        log(LogLevel::Warning) << "Failed to check whether " << event.path << " is used by other process. Skipping it.";
+        break;
+    default:
+        // We're giving up on this file, it's been removed or we don't have access
+        break;
+    }
+}
+
+void DeferredFileLocker::retryDueFiles(Clock::time_point now, bool retryAll) {
+    while (!scheduledRetries.empty() && (retryAll || scheduledRetries.top().deadline <= now)) {
+        const PathStringType path = scheduledRetries.top().path;
+        scheduledRetries.pop();
+        auto fileIt = deferredFiles.find(path);
+        FATAL_ERROR_IF(fileIt == deferredFiles.end(), "Retry scheduled for unknown file");
+        DeferredFile &file = fileIt->second;
 
-            if (passToOutputQueue) {
-                outputQueue.push(std::move(event));
+        auto [handle, result] = filesystem.lockFile(file.events.front().path);
+        switch (result) {
+        case Filesystem::LockResult::NotSupported:
+        case Filesystem::LockResult::Success:
+            // Only the first event holds the lock. The Processor handles the rest after it, so they don't need one.
+            file.events.front().lockedFileHandle = handle;
+            for (FileEvent &event : file.events) {
+                eventsToPublish.push_back(std::move(event));
             }
-        } else {
-            it++;
+            break;
+        case Filesystem::LockResult::UsedByOtherProcess:
+            if (retryAll) {
+                break;
+            }
+            if (maxWait.count() == 0 || now - file.firstAttempt < maxWait) {
+                file.delay = std::min(file.delay * 2, maxDelay);
+                scheduleRetry(path, file, now);
+                continue;
+            }
+            log(LogLevel::Warning) << "File " << file.events.front().path << " is still used by other process after "
+                                   << maxWait.count() << "ms. Skipping it.";
+            break;
+        case Filesystem::LockResult::Unknown:
+            log(LogLevel::Warning) << "Failed to check whether " << file.events.front().path << " is used by other process. Skipping it.";
+            break;
+        default:
+            // We're giving up on this file, it's been removed or we don't have access
+            break;
         }
+        deferredFiles.erase(fileIt);
     }
+}
 
-    return interrupt;
+void DeferredFileLocker::scheduleRetry(const PathStringType &path, DeferredFile &file, Clock::time_point now) {
+    const auto maxJitter = file.delay.count() / 5;
+    std::uniform_int_distribution<decltype(maxJitter)> jitterDistribution{-maxJitter, maxJitter};
+    const auto jitter = std::chrono::milliseconds(jitterDistribution(randomEngine));
+    scheduledRetries.push(ScheduledRetry{now + file.delay + jitter, path});
 }
@@ -2,23 +2,60 @@
 
 #include "charon/util/class_traits.h"
 #include "charon/util/filesystem.h"
-#include "charon/watcher/file_event.h"
+#include "charon/watcher/file_event_queue.h"
 
+#include <chrono>
+#include <queue>
+#include <random>
+#include <unordered_map>
 #include <vector>
 
+// Locks files before passing their events to the Processor, so files still written by other processes are not
+// processed prematurely. Locking of a file used by someone else is retried with exponential backoff. Retries are kept
+// in a min-heap ordered by their deadlines, so files which are still in use cost nothing until their retry is due.
+// Events for a file which is already waiting are queued behind the first one and published together, in order.
 class DeferredFileLocker : NonCopyableAndMovable {
 public:
     DeferredFileLocker(FileEventQueue &inputQueue, FileEventQueue &outputQueue, Filesystem &filesystem);
 
+    // Has to be called before run(). First retry happens after initialDelay and each following one waits twice as
+    // long, up to maxDelay. Delays are randomized by up to 20%, so files released at once are not retried at once.
+    // Files still in use after maxWait are skipped. Max wait equal to 0 means waiting indefinitely.
+    void setRetryPolicy(std::chrono::milliseconds initialDelay, std::chrono::milliseconds maxDelay, std::chrono::milliseconds maxWait);
+    void setMaxWait(std::chrono::milliseconds maxWait) { this->maxWait = maxWait; }
+
     void run();
 
 private:
-    void fetchFromInputQueue();
-    bool processEvents();
+    using Clock = std::chrono::steady_clock;
+    struct DeferredFile {
+        std::vector<FileEvent> events;
+        Clock::time_point firstAttempt;
+        std::chrono::milliseconds delay;
+    };
+    struct ScheduledRetry {
+        Clock::time_point deadline;
+        PathStringType path;
+
+        bool operator>(const ScheduledRetry &other) const { return deadline > other.deadline; }
+    };
+
+    bool fetchFromInputQueue();
+    void addEvent(FileEvent &&event, Clock::time_point now);
+    void retryDueFiles(Clock::time_point now, bool retryAll);
+    void scheduleRetry(const PathStringType &path, DeferredFile &file, Clock::time_point now);
 
-    std::vector<FileEvent> events{};
     FileEventQueue &inputQueue;
     FileEventQueue &outputQueue;
     Filesystem &filesystem;
-    std::chrono::milliseconds fetchTimeout;
+    std::chrono::milliseconds initialDelay = std::chrono::milliseconds(100);
+    std::chrono::milliseconds maxDelay = std::chrono::milliseconds(3200);
+    std::chrono::milliseconds maxWait = {};
+
+    std::unordered_map<PathStringType, DeferredFile> deferredFiles = {};
+    std::priority_queue<ScheduledRetry, std::vector<ScheduledRetry>, std::greater<ScheduledRetry>> scheduledRetries = {};
+    std::minstd_rand randomEngine{std::random_device{}()};
+
+    // Events are published to the output queue in batches
+    std::vector<FileEvent> eventsToPublish = {};
 };
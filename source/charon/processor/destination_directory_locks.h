@@ -0,0 +1,31 @@
+#pragma once
+
+#include "charon/util/class_traits.h"
+#include "charon/util/filesystem.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Mutexes for destination directories shared between Processor workers. A worker resolving a counter in a destination
+// filename has to hold the lock until the file is created, so other workers don't select the same counter value.
+// Destination directories come from the config, so the number of mutexes is bounded.
+class DestinationDirectoryLocks : NonCopyableAndMovable {
+public:
+    std::unique_lock<std::mutex> lock(const std::filesystem::path &directory) {
+        std::mutex *directoryMutex = nullptr;
+        {
+            std::lock_guard lock{mapMutex};
+            auto &entry = mutexes[directory.native()];
+            if (entry == nullptr) {
+                entry = std::make_unique<std::mutex>();
+            }
+            directoryMutex = entry.get();
+        }
+        return std::unique_lock{*directoryMutex};
+    }
+
+private:
+    std::mutex mapMutex = {};
+    std::unordered_map<PathStringType, std::unique_ptr<std::mutex>> mutexes = {};
+};
@@ -0,0 +1,154 @@
+#include "charon/processor/directory_counter_cache.h"
+
+DirectoryCounterCache::DirectoryCounterCache(Filesystem &filesystem)
+    : filesystem(filesystem) {}
+
+std::optional<size_t> DirectoryCounterCache::findFreeCounter(const fs::path &directory, NameTemplate::StringView prefix, size_t digits,
+                                                             NameTemplate::StringView suffix, NameTemplate::StringView extension, size_t counterStart) {
+    const std::optional<fs::file_time_type> lastWriteTime = filesystem.getLastWriteTime(directory);
+    if (!lastWriteTime.has_value()) {
+        return std::nullopt;
+    }
+
+    // Drop everything we know about the directory if it was modified by someone else
+    Directory &cachedDirectory = directories[getDirectoryKey(directory)];
+    if (cachedDirectory.path.empty() || cachedDirectory.lastWriteTime != lastWriteTime.value()) {
+        cachedDirectory.path = directory;
+        cachedDirectory.lastWriteTime = lastWriteTime.value();
+        cachedDirectory.patterns.clear();
+    }
+
+    patternKeyBuffer.assign(prefix);
+    patternKeyBuffer.push_back(PathCharType{});
+    patternKeyBuffer += suffix;
+    patternKeyBuffer.push_back(static_cast<PathCharType>(digits));
+    auto patternIt = cachedDirectory.patterns.find(patternKeyBuffer);
+    if (patternIt == cachedDirectory.patterns.end()) {
+        Pattern pattern{PathStringType{prefix}, digits, PathStringType{suffix}, {}};
+        for (const fs::path &file : filesystem.listFiles(directory)) {
+            if (const std::optional<size_t> counter = pattern.parseCounter(NameTemplate::getStem(file)); counter.has_value()) {
+                pattern.markTaken(counter.value());
+            }
+        }
+        patternIt = cachedDirectory.patterns.emplace(patternKeyBuffer, std::move(pattern)).first;
+    }
+
+    Pattern &pattern = patternIt->second;
+    while (true) {
+        const size_t counter = pattern.findFreeCounter(counterStart);
+        if (counter > pattern.getMaxCounter()) {
+            // All values are taken, caller will handle it
+            return counter;
+        }
+
+        candidateBuffer.assign(prefix);
+        candidateBuffer.append(digits, '0');
+        candidateBuffer += suffix;
+        NameTemplate::writeCounter(candidateBuffer.data() + prefix.size(), counter, digits);
+        if (!filesystem.getLastWriteTime((directory / candidateBuffer).replace_extension(extension)).has_value()) {
+            return counter;
+        }
+
+        // Cache is outdated, the file was created after the directory has been listed
+        pattern.markTaken(counter);
+    }
+}
+
+void DirectoryCounterCache::notifyFileCreated(const fs::path &file) {
+    auto directoryIt = directories.find(getDirectoryKey(file.parent_path()));
+    if (directoryIt == directories.end()) {
+        return;
+    }
+
+    const NameTemplate::StringView stem = NameTemplate::getStem(file);
+    for (auto &[patternKey, pattern] : directoryIt->second.patterns) {
+        if (const std::optional<size_t> counter = pattern.parseCounter(stem); counter.has_value()) {
+            pattern.markTaken(counter.value());
+        }
+    }
+
+    // Our own write changed the last write time, so don't treat it as an external modification
+    const std::optional<fs::file_time_type> lastWriteTime = filesystem.getLastWriteTime(directoryIt->second.path);
+    if (lastWriteTime.has_value()) {
+        directoryIt->second.lastWriteTime = lastWriteTime.value();
+    } else {
+        directories.erase(directoryIt);
+    }
+}
+
+PathStringType DirectoryCounterCache::getDirectoryKey(const fs::path &directory) {
+    // Directory may be passed with or without trailing separator
+    fs::path result = directory.lexically_normal();
+    if (!result.has_filename()) {
+        result = result.parent_path();
+    }
+    return result.native();
+}
+
+std::optional<size_t> DirectoryCounterCache::Pattern::parseCounter(NameTemplate::StringView stem) const {
+    if (stem.size() != prefix.size() + digits + suffix.size()) {
+        return std::nullopt;
+    }
+    if (stem.compare(0, prefix.size(), prefix) != 0 || stem.compare(prefix.size() + digits, suffix.size(), suffix) != 0) {
+        return std::nullopt;
+    }
+
+    size_t counter = 0;
+    for (size_t i = prefix.size(); i < prefix.size() + digits; i++) {
+        if (stem[i] < '0' || stem[i] > '9') {
+            return std::nullopt;
+        }
+        counter = counter * 10 + static_cast<size_t>(stem[i] - '0');
+    }
+    return counter;
+}
+
+size_t DirectoryCounterCache::Pattern::getMaxCounter() const {
+    size_t result = 1;
+    for (size_t i = 0; i < digits; i++) {
+        result *= 10;
+    }
+    return result - 1;
+}
+
+size_t DirectoryCounterCache::Pattern::findFreeCounter(size_t counterStart) const {
+    auto range = takenCounters.upper_bound(counterStart);
+    if (range == takenCounters.begin()) {
+        return counterStart;
+    }
+    range--;
+    if (range->second < counterStart) {
+        return counterStart;
+    }
+    return range->second + 1;
+}
+
+void DirectoryCounterCache::Pattern::markTaken(size_t counter) {
+    auto next = takenCounters.upper_bound(counter);
+    if (next != takenCounters.begin()) {
+        auto previous = std::prev(next);
+        if (previous->second >= counter) {
+            // Already taken
+            return;
+        }
+        if (previous->second + 1 == counter) {
+            // Extend previous range and merge it with the next one if they touch
+            previous->second = counter;
+            if (next != takenCounters.end() && next->first == counter + 1) {
+                previous->second = next->second;
+                takenCounters.erase(next);
+            }
+            return;
+        }
+    }
+
+    if (next != takenCounters.end() && next->first == counter + 1) {
+        // Extend next range backwards
+        const size_t last = next->second;
+        takenCounters.erase(next);
+        takenCounters.emplace(counter, last);
+        return;
+    }
+
+    takenCounters.emplace(counter, counter);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "charon/processor/name_template.h"
+#include "charon/util/class_traits.h"
+#include "charon/util/filesystem.h"
+
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+// Remembers which counter values are taken in destination directories, so PathResolver doesn't have to list and sort
+// the whole directory for every file. A filename pattern with a counter is described by a prefix, a number of digits
+// and a suffix. Taken counter values are stored as disjoint ranges, so the first free value can be found in O(log n).
+//
+// Directory is listed again when its last write time changes, which means someone else created or removed files there.
+// Files created by Charon itself are reported with notifyFileCreated(), which updates the cache without listing. The
+// last write time may not change for modifications done in quick succession, so the selected filename is additionally
+// checked for existence before returning it.
+class DirectoryCounterCache : NonCopyableAndMovable {
+public:
+    explicit DirectoryCounterCache(Filesystem &filesystem);
+
+    // Returns first counter value, starting from counterStart, which is not used by any file in the directory. Returns
+    // std::nullopt if the directory cannot be cached and the caller has to fall back to listing it.
+    std::optional<size_t> findFreeCounter(const fs::path &directory, NameTemplate::StringView prefix, size_t digits,
+                                          NameTemplate::StringView suffix, NameTemplate::StringView extension, size_t counterStart);
+
+    void notifyFileCreated(const fs::path &file);
+
+private:
+    // Maps first value of each range of taken counters to the last value of this range
+    using TakenCounters = std::map<size_t, size_t>;
+
+    struct Pattern {
+        PathStringType prefix;
+        size_t digits;
+        PathStringType suffix;
+        TakenCounters takenCounters;
+
+        std::optional<size_t> parseCounter(NameTemplate::StringView stem) const;
+        size_t getMaxCounter() const;
+        size_t findFreeCounter(size_t counterStart) const;
+        void markTaken(size_t counter);
+    };
+
+    struct Directory {
+        fs::path path;
+        fs::file_time_type lastWriteTime;
+        std::unordered_map<PathStringType, Pattern> patterns;
+    };
+
+    static PathStringType getDirectoryKey(const fs::path &directory);
+
+    Filesystem &filesystem;
+    std::unordered_map<PathStringType, Directory> directories = {};
+
+    // Reused between calls to avoid allocations
+    PathStringType patternKeyBuffer = {};
+    PathStringType candidateBuffer = {};
+};
@@ -0,0 +1,139 @@
+#include "charon/processor/event_coalescer.h"
+
+#include <algorithm>
+
+EventCoalescer::EventCoalescer(FileEventQueue &inputQueue, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue)
+    : inputQueue(inputQueue),
+      outputQueue(outputQueue),
+      deferredOutputQueue(deferredOutputQueue) {}
+
+void EventCoalescer::run() {
+    bool running = true;
+    while (running) {
+        running = fetchFromInputQueue();
+        publishEvents(running ? Clock::now() : Clock::time_point::max());
+        outputQueue.pushBatch(eventsToPublish);
+        deferredOutputQueue.pushBatch(deferredEventsToPublish);
+    }
+}
+
+bool EventCoalescer::fetchFromInputQueue() {
+    FileEvent event{};
+    bool popped = false;
+    if (pendingEvents.empty()) {
+        popped = inputQueue.blockingPop(event);
+    } else {
+        const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(pendingEvents.front().deadline - Clock::now());
+        popped = inputQueue.blockingPop(event, std::max(timeout, std::chrono::milliseconds(0)));
+    }
+    if (!popped) {
+        return true;
+    }
+
+    const auto now = Clock::now();
+    do {
+        if (event.isInterrupt()) {
+            // Pending events are published before stopping. Interrupt event is not passed through.
+            return false;
+        }
+        if (startupScanner != nullptr && !startupScanner->filterEvent(event)) {
+            continue;
+        }
+        addEvent(std::move(event), now);
+    } while (inputQueue.nonBlockingPop(event));
+    return true;
+}
+
+void EventCoalescer::addEvent(FileEvent &&event, Clock::time_point now) {
+    if (window.count() == 0) {
+        publishEvent(std::move(event));
+        return;
+    }
+
+    const PathStringType key = getKey(event);
+    if (auto it = lastPendingEventForPath.find(key); it != lastPendingEventForPath.end()) {
+        PendingEvent &previous = pendingEvents[it->second - firstPendingEventSequenceNumber];
+        const bool previousIsNewFile = previous.event.type == FileEvent::Type::Add || previous.event.type == FileEvent::Type::RenameNew;
+        const bool previousIsModify = previous.event.type == FileEvent::Type::Modify;
+        const bool previousIsRemove = previous.event.type == FileEvent::Type::Remove || previous.event.type == FileEvent::Type::RenameOld;
+
+        switch (event.type) {
+        case FileEvent::Type::Modify:
+            if (previousIsNewFile || previousIsModify) {
+                // File will be processed anyway
+                coalescedEventsCount++;
+                return;
+            }
+            break;
+        case FileEvent::Type::Add:
+        case FileEvent::Type::RenameNew:
+            if (previousIsNewFile) {
+                coalescedEventsCount++;
+                return;
+            }
+            if (previousIsModify) {
+                // Modified file has been replaced, process it as a new one
+                previous.event.type = event.type;
+                coalescedEventsCount++;
+                return;
+            }
+            break;
+        case FileEvent::Type::Remove:
+        case FileEvent::Type::RenameOld:
+            if (previousIsNewFile) {
+                // File was transient, there's nothing to process
+                previous.cancelled = true;
+                lastPendingEventForPath.erase(it);
+                coalescedEventsCount += 2;
+                return;
+            }
+            if (previousIsModify) {
+                previous.event.type = event.type;
+                coalescedEventsCount++;
+                return;
+            }
+            if (previousIsRemove) {
+                coalescedEventsCount++;
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Event cannot be folded. Removal followed by a creation also lands here, since the new file has to be
+    // processed, but the removal of the old one may be awaited by the Processor.
+    lastPendingEventForPath[key] = firstPendingEventSequenceNumber + pendingEvents.size();
+    pendingEvents.push_back(PendingEvent{std::move(event), now + window, false});
+}
+
+void EventCoalescer::publishEvents(Clock::time_point now) {
+    while (!pendingEvents.empty() && pendingEvents.front().deadline <= now) {
+        PendingEvent &pendingEvent = pendingEvents.front();
+        if (!pendingEvent.cancelled) {
+            auto it = lastPendingEventForPath.find(getKey(pendingEvent.event));
+            if (it != lastPendingEventForPath.end() && it->second == firstPendingEventSequenceNumber) {
+                lastPendingEventForPath.erase(it);
+            }
+            publishEvent(std::move(pendingEvent.event));
+        }
+        pendingEvents.pop_front();
+        firstPendingEventSequenceNumber++;
+    }
+}
+
+void EventCoalescer::publishEvent(FileEvent &&event) {
+    if (event.needsFileLocking()) {
+        deferredEventsToPublish.push_back(std::move(event));
+    } else {
+        eventsToPublish.push_back(std::move(event));
+    }
+}
+
+PathStringType EventCoalescer::getKey(const FileEvent &event) {
+    PathStringType key = event.watchedRootPath.native();
+    key.push_back(PathCharType{});
+    key += event.path.native();
+    return key;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "charon/util/class_traits.h"
+#include "charon/watcher/file_event_queue.h"
+#include "charon/watcher/startup_scanner.h"
+
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+// Sits between directory watchers and the rest of the pipeline. Events are held for a configurable window, during
+// which redundant events for the same path are folded, so only their net effect is processed:
+//  - repeated modifications of a file are reported once and modifications of a new file are not reported at all,
+//  - a file created (or moved in) and then removed (or moved out) within the window is not reported at all,
+//  - duplicated removals are reported once.
+// Rename chains collapse naturally, because intermediate names are created and removed within the window.
+// Folded events are routed to the DeferredFileLocker or directly to the Processor, like watchers would do. Events of
+// the startup scan are passed through the StartupScanner's filter, so files reported by watchers are not scanned again.
+//
+// Window equal to 0 disables coalescing and events are passed through unchanged.
+class EventCoalescer : NonCopyableAndMovable {
+public:
+    EventCoalescer(FileEventQueue &inputQueue, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue);
+
+    // Have to be called before run()
+    void setWindow(std::chrono::milliseconds window) { this->window = window; }
+    void setStartupScanner(StartupScanner &startupScanner) { this->startupScanner = &startupScanner; }
+
+    void run();
+
+    size_t getCoalescedEventsCount() const { return coalescedEventsCount; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct PendingEvent {
+        FileEvent event;
+        Clock::time_point deadline;
+        bool cancelled;
+    };
+
+    bool fetchFromInputQueue();
+    void addEvent(FileEvent &&event, Clock::time_point now);
+    void publishEvents(Clock::time_point now);
+    void publishEvent(FileEvent &&event);
+
+    static PathStringType getKey(const FileEvent &event);
+
+    FileEventQueue &inputQueue;
+    FileEventQueue &outputQueue;
+    FileEventQueue &deferredOutputQueue;
+    std::chrono::milliseconds window = {};
+    StartupScanner *startupScanner = nullptr;
+
+    // Events are kept in the order of arrival, which is also the order of their deadlines. Each path is mapped to
+    // the sequence number of its last pending event, so it can be folded with the new ones.
+    std::deque<PendingEvent> pendingEvents = {};
+    size_t firstPendingEventSequenceNumber = 0u;
+    std::unordered_map<PathStringType, size_t> lastPendingEventForPath = {};
+    size_t coalescedEventsCount = 0u;
+
+    // Events are published to output queues in batches
+    std::vector<FileEvent> eventsToPublish = {};
+    std::vector<FileEvent> deferredEventsToPublish = {};
+};
@@ -0,0 +1,60 @@
+#include "charon/processor/ignored_events.h"
+
+IgnoredEvents::IgnoredEvents(std::chrono::milliseconds expiryTime, size_t maxSize)
+    : expiryTime(expiryTime),
+      maxSize(maxSize) {}
+
+void IgnoredEvents::add(const FileEvent &event, Clock::time_point now) {
+    removeExpired(now);
+    while (!entries.empty() && entries.size() >= maxSize) {
+        removeOldest();
+    }
+
+    PathStringType key = getKey(event);
+    auto &entriesForKey = liveEntries[key];
+    entries.push_back(Entry{now + expiryTime, std::move(key)});
+    entriesForKey.push_back(std::prev(entries.end()));
+}
+
+bool IgnoredEvents::consume(const FileEvent &event, Clock::time_point now) {
+    removeExpired(now);
+    if (entries.empty()) {
+        return false;
+    }
+
+    auto it = liveEntries.find(getKey(event));
+    if (it == liveEntries.end()) {
+        return false;
+    }
+
+    entries.erase(it->second.front());
+    it->second.pop_front();
+    if (it->second.empty()) {
+        liveEntries.erase(it);
+    }
+    return true;
+}
+
+void IgnoredEvents::removeExpired(Clock::time_point now) {
+    while (!entries.empty() && entries.front().expiryTime <= now) {
+        removeOldest();
+    }
+}
+
+void IgnoredEvents::removeOldest() {
+    // Oldest entry is also the oldest one registered for its event
+    auto it = liveEntries.find(entries.front().key);
+    it->second.pop_front();
+    if (it->second.empty()) {
+        liveEntries.erase(it);
+    }
+    entries.pop_front();
+}
+
+PathStringType IgnoredEvents::getKey(const FileEvent &event) {
+    PathStringType key = event.watchedRootPath.native();
+    key.push_back(PathCharType{});
+    key += event.path.native();
+    key.push_back(static_cast<PathCharType>('0' + static_cast<int>(event.type)));
+    return key;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "charon/util/class_traits.h"
+#include "charon/watcher/file_event.h"
+
+#include <chrono>
+#include <deque>
+#include <list>
+#include <unordered_map>
+
+// Set of events expected to be caused by Processor's own actions (e.g. removal of a moved file), which should not be
+// processed again. Each registered event is ignored once. Events which never arrive (e.g. because the watcher missed
+// them) expire after some time and the oldest ones are dropped if there are too many of them, so the set doesn't grow
+// indefinitely on long-running instances.
+class IgnoredEvents : NonCopyableAndMovable {
+public:
+    using Clock = std::chrono::steady_clock;
+    constexpr static inline std::chrono::seconds defaultExpiryTime = std::chrono::seconds(60);
+    constexpr static inline size_t defaultMaxSize = 65536;
+
+    explicit IgnoredEvents(std::chrono::milliseconds expiryTime = defaultExpiryTime, size_t maxSize = defaultMaxSize);
+
+    void add(const FileEvent &event, Clock::time_point now = Clock::now());
+    // Returns true and removes the event from the set if it was registered.
+    bool consume(const FileEvent &event, Clock::time_point now = Clock::now());
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Entry {
+        Clock::time_point expiryTime;
+        PathStringType key;
+    };
+    using EntryIt = std::list<Entry>::iterator;
+
+    void removeExpired(Clock::time_point now);
+    void removeOldest();
+    static PathStringType getKey(const FileEvent &event);
+
+    const std::chrono::milliseconds expiryTime;
+    const size_t maxSize;
+
+    // Registered entries in order of registration, which is also the order of expiry. Consumed entries are removed
+    // right away, so maxSize bounds the memory used.
+    std::list<Entry> entries = {};
+    // Registered entries for each event. Events are always consumed starting from the oldest one.
+    std::unordered_map<PathStringType, std::deque<EntryIt>> liveEntries = {};
+};
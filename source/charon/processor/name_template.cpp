@@ -0,0 +1,117 @@
+#include "charon/processor/name_template.h"
+#include "charon/util/string_literal.h"
+
+#include <array>
+#include <charconv>
+
+NameTemplate::NameTemplate(const std::filesystem::path &namePattern) {
+    const PathStringType namePatternStr = namePattern.generic_string<PathCharType>();
+    const StringView pattern = namePatternStr;
+
+    static const std::pair<StringView, Segment::Type> variables[] = {
+        {CSTRING("${name}"), Segment::Type::Name},
+        {CSTRING("${previousName}"), Segment::Type::PreviousName},
+        {CSTRING("${extension}"), Segment::Type::Extension},
+    };
+
+    const auto appendLiteral = [this](PathCharType character) {
+        if (segments.empty() || segments.back().type != Segment::Type::Literal) {
+            segments.push_back(Segment{Segment::Type::Literal, {}});
+        }
+        segments.back().literal.push_back(character);
+    };
+
+    for (size_t position = 0u; position < pattern.size();) {
+        // Counter. Validated patterns have at most one contiguous sequence of hashes.
+        if (pattern[position] == '#' && counterDigits == 0) {
+            while (position < pattern.size() && pattern[position] == '#') {
+                counterDigits++;
+                position++;
+            }
+            segments.push_back(Segment{Segment::Type::Counter, {}});
+            continue;
+        }
+
+        // Pseudo-variables
+        bool variableFound = false;
+        for (const auto &[variableName, segmentType] : variables) {
+            if (pattern.compare(position, variableName.size(), variableName) == 0) {
+                segments.push_back(Segment{segmentType, {}});
+                position += variableName.size();
+                variableFound = true;
+                break;
+            }
+        }
+
+        // Literal text
+        if (!variableFound) {
+            appendLiteral(pattern[position]);
+            position++;
+        }
+    }
+}
+
+size_t NameTemplate::render(PathStringType &buffer, StringView name, StringView extension, StringView previousName) const {
+    size_t counterPosition = StringView::npos;
+    buffer.clear();
+    for (const Segment &segment : segments) {
+        switch (segment.type) {
+        case Segment::Type::Literal:
+            buffer += segment.literal;
+            break;
+        case Segment::Type::Name:
+            buffer += name;
+            break;
+        case Segment::Type::PreviousName:
+            buffer += previousName;
+            break;
+        case Segment::Type::Extension:
+            buffer += extension;
+            break;
+        case Segment::Type::Counter:
+            counterPosition = buffer.size();
+            buffer.append(counterDigits, '0');
+            break;
+        }
+    }
+    return counterPosition;
+}
+
+void NameTemplate::writeCounter(PathCharType *address, size_t counter, size_t digits) {
+    std::array<char, 32> counterString{};
+    const auto [end, error] = std::to_chars(counterString.data(), counterString.data() + counterString.size(), counter);
+    const size_t length = static_cast<size_t>(end - counterString.data());
+
+    const size_t zeros = digits > length ? digits - length : 0u;
+    std::fill_n(address, zeros, static_cast<PathCharType>('0'));
+    std::copy(end - (digits - zeros), end, address + zeros);
+}
+
+NameTemplate::StringView NameTemplate::getStem(const std::filesystem::path &path) {
+    const StringView filename = getFilename(path);
+    const StringView extension = getExtension(path);
+    return filename.substr(0, filename.size() - extension.size());
+}
+
+NameTemplate::StringView NameTemplate::getExtension(const std::filesystem::path &path) {
+    const StringView filename = getFilename(path);
+    if (filename == CSTRING(".") || filename == CSTRING("..")) {
+        return {};
+    }
+
+    const size_t dotPosition = filename.rfind('.');
+    if (dotPosition == StringView::npos || dotPosition == 0) {
+        return {};
+    }
+    return filename.substr(dotPosition);
+}
+
+NameTemplate::StringView NameTemplate::getFilename(const std::filesystem::path &path) {
+    const StringView pathString = path.native();
+    const PathCharType separators[] = {'/', std::filesystem::path::preferred_separator, 0};
+    const size_t separatorPosition = pathString.find_last_of(separators);
+    if (separatorPosition == StringView::npos) {
+        return pathString;
+    }
+    return pathString.substr(separatorPosition + 1);
+}
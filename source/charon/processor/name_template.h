@@ -0,0 +1,48 @@
+#pragma once
+
+#include "charon/util/filesystem.h"
+
+#include <string_view>
+#include <vector>
+
+// Destination name pattern compiled into a list of segments: literal text, pseudo-variables and a counter slot. It is
+// created once for each action, so resolving a name for a file is just appending the segments to a reusable buffer.
+class NameTemplate {
+public:
+    using StringView = std::basic_string_view<PathCharType>;
+
+    explicit NameTemplate(const std::filesystem::path &namePattern);
+
+    bool hasCounter() const { return counterDigits > 0; }
+    size_t getCounterDigits() const { return counterDigits; }
+
+    // Writes the name to the buffer, replacing its previous contents. The counter slot is filled with zeros and its
+    // position is returned. If there is no counter, StringView::npos is returned.
+    size_t render(PathStringType &buffer, StringView name, StringView extension, StringView previousName) const;
+
+    // Writes the counter value padded with zeros. Only the last digits are written if the value is too big.
+    static void writeCounter(PathCharType *address, size_t counter, size_t digits);
+
+    // Parts of the filename, as defined by std::filesystem::path, without any allocations
+    static StringView getStem(const std::filesystem::path &path);
+    static StringView getExtension(const std::filesystem::path &path);
+
+private:
+    struct Segment {
+        enum class Type {
+            Literal,
+            Name,
+            PreviousName,
+            Extension,
+            Counter,
+        };
+
+        Type type;
+        PathStringType literal;
+    };
+
+    static StringView getFilename(const std::filesystem::path &path);
+
+    std::vector<Segment> segments = {};
+    size_t counterDigits = 0u;
+};
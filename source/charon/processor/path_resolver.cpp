@@ -5,10 +5,10 @@
 #include "charon/util/string_literal.h"
 
 #include <regex>
-#include <sstream>
 
 PathResolver::PathResolver(Filesystem &filesystem)
-    : filesystem(filesystem) {}
+    : filesystem(filesystem),
+      counterCache(filesystem) {}
 
 bool PathResolver::validateCounterStartForResolve(const std::filesystem::path &namePattern, size_t counterStart) {
     const PathStringType namePatternStr = namePattern.generic_string<PathCharType>();
@@ -88,35 +88,37 @@ bool PathResolver::validateNameForResolve(const std::filesystem::path &namePatte
 
 std::filesystem::path PathResolver::resolvePath(const std::filesystem::path &newDir,
                                                 const std::filesystem::path &oldName,
-                                                const std::filesystem::path &namePattern,
+                                                const NameTemplate &nameTemplate,
                                                 const std::filesystem::path &lastResolvedName,
                                                 size_t counterStart) const {
-    PathStringType result = namePattern.generic_string<PathCharType>();
-    const std::filesystem::path extension = oldName.extension();
-
-    applyVariableSubstitutions(result, oldName, extension, lastResolvedName);
-    applyCounterSubstitution(result, newDir, counterStart);
+    const NameTemplate::StringView extension = NameTemplate::getExtension(oldName);
+    const NameTemplate::StringView extensionWithoutDot = extension.empty() ? extension : extension.substr(1);
+    const size_t counterPosition = nameTemplate.render(nameBuffer, NameTemplate::getStem(oldName), extensionWithoutDot,
+                                                       NameTemplate::getStem(lastResolvedName));
+    if (nameTemplate.hasCounter()) {
+        applyCounterSubstitution(nameBuffer, counterPosition, nameTemplate.getCounterDigits(), newDir, extension, counterStart);
+    }
 
-    if (result.empty()) {
-        return result;
+    if (nameBuffer.empty()) {
+        return {};
     } else {
-        return finalizePath(newDir, result, extension);
+        return finalizePath(newDir, nameBuffer, extension);
     }
 }
 
-void PathResolver::applyVariableSubstitutions(PathStringType &name,
-                                              const std::filesystem::path &oldName,
-                                              const std::filesystem::path &oldNameExtension,
-                                              const std::filesystem::path &lastResolvedName) {
-    StringHelper<PathCharType>::replace(name, CSTRING("${name}"), oldName.stem().generic_string<PathCharType>());
-    StringHelper<PathCharType>::replace(name, CSTRING("${previousName}"), lastResolvedName.stem().generic_string<PathCharType>());
-    StringHelper<PathCharType>::replace(name, CSTRING("${extension}"), StringHelper<PathCharType>::removeLeadingDot(oldNameExtension));
-}
-
-void PathResolver::applyCounterSubstitution(PathStringType &name, const std::filesystem::path &newDir, size_t counterStart) const {
-    // If no counter is present, then we're done
-    const size_t digits = std::count(name.begin(), name.end(), '#');
-    if (digits == 0) {
+void PathResolver::applyCounterSubstitution(PathStringType &name, size_t counterPosition, size_t digits, const std::filesystem::path &newDir,
+                                            NameTemplate::StringView extension, size_t counterStart) const {
+    const NameTemplate::StringView prefix = NameTemplate::StringView{name}.substr(0, counterPosition);
+    const NameTemplate::StringView suffix = NameTemplate::StringView{name}.substr(counterPosition + digits);
+    PathCharType *const counterAddress = name.data() + counterPosition;
+
+    // Try to use the cache first
+    if (const auto counter = counterCache.findFreeCounter(newDir, prefix, digits, suffix, extension, counterStart); counter.has_value()) {
+        if (counter.value() > getMaxIndex(digits)) {
+            name.resize(0);
+        } else {
+            NameTemplate::writeCounter(counterAddress, counter.value(), digits);
+        }
         return;
     }
 
@@ -127,13 +129,12 @@ void PathResolver::applyCounterSubstitution(PathStringType &name, const std::fil
     // Define a predicate, which will tell us if a filename with given counter value is already taken
     // The predicate ignores the extension.
     const auto isNameTaken = [&name](const fs::path &p) {
-        return name == p.stem().generic_string<PathCharType>();
+        return NameTemplate::StringView{name} == NameTemplate::getStem(p);
     };
 
     // Substitute first counter value in place of hashes
     size_t counter = counterStart;
-    const auto counterAddress = name.begin() + name.find('#');
-    setCounter(counterAddress, counter, digits);
+    NameTemplate::writeCounter(counterAddress, counter, digits);
 
     // If we don't find a conflicting file, we can just take this name
     auto existingFile = std::find_if(filesInNewDir.begin(), filesInNewDir.end(), isNameTaken);
@@ -143,11 +144,11 @@ void PathResolver::applyCounterSubstitution(PathStringType &name, const std::fil
 
     // We have a conflict. Check rest of names. The list is sorted, so we don't have to check anything before existingFile.
     existingFile++;
-    setCounter(counterAddress, ++counter, digits);
+    NameTemplate::writeCounter(counterAddress, ++counter, digits);
     for (; existingFile != filesInNewDir.end(); existingFile++) {
         // If it's taken, go to the next one
         if (isNameTaken(*existingFile)) {
-            setCounter(counterAddress, ++counter, digits);
+            NameTemplate::writeCounter(counterAddress, ++counter, digits);
         }
     }
 
@@ -165,16 +166,8 @@ size_t PathResolver::getMaxIndex(size_t digits) {
     return result - 1;
 }
 
-void PathResolver::setCounter(PathStringType::iterator counterAddress, size_t index, size_t digits) {
-    std::ostringstream counterStringStream{};
-    counterStringStream << std::setfill('0') << std::setw(digits) << index;
-    const std::string counterString = counterStringStream.str();
-
-    std::copy_n(counterString.data(), digits, counterAddress);
-}
-
 std::filesystem::path PathResolver::finalizePath(const std::filesystem::path &destinationDir,
                                                  const PathStringType &name,
-                                                 const std::filesystem::path &extension) {
+                                                 NameTemplate::StringView extension) {
     return (destinationDir / name).replace_extension(extension);
 }
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include "charon/processor/directory_counter_cache.h"
+#include "charon/processor/name_template.h"
 #include "charon/util/class_traits.h"
 #include "charon/util/filesystem.h"
 
@@ -17,26 +19,28 @@ public:
 
     std::filesystem::path resolvePath(const std::filesystem::path &newDir,
                                       const std::filesystem::path &oldName,
-                                      const std::filesystem::path &namePattern,
+                                      const NameTemplate &nameTemplate,
                                       const std::filesystem::path &lastResolvedName,
                                       size_t counterStart) const;
 
+    // Has to be called after a file is created at the resolved path to keep the counter cache up to date
+    void notifyFileCreated(const std::filesystem::path &path) { counterCache.notifyFileCreated(path); }
+
 private:
-    static void applyVariableSubstitutions(PathStringType &name,
-                                           const std::filesystem::path &oldName,
-                                           const std::filesystem::path &oldNameExtension,
-                                           const std::filesystem::path &lastResolvedName);
     void applyCounterSubstitution(PathStringType &name,
+                                  size_t counterPosition,
+                                  size_t digits,
                                   const std::filesystem::path &newDir,
+                                  NameTemplate::StringView extension,
                                   size_t counterStart) const;
 
     static size_t getMaxIndex(size_t digits);
 
-    static void setCounter(PathStringType::iterator counterAddress, size_t index, size_t digits);
-
     static std::filesystem::path finalizePath(const std::filesystem::path &destinationDir,
                                               const PathStringType &name,
-                                              const std::filesystem::path &extension);
+                                              NameTemplate::StringView extension);
 
     Filesystem &filesystem;
+    mutable DirectoryCounterCache counterCache;
+    mutable PathStringType nameBuffer = {};
 };
@@ -1,19 +1,52 @@
 
+#include "charon/processor/destination_directory_locks.h"
 #include "charon/processor/processor.h"
 #include "charon/util/error.h"
 #include "charon/util/filesystem.h"
 #include "charon/util/logger.h"
-#include "charon/util/string_helper.h"
 
 #include <algorithm>
 
-Processor::Processor(const ProcessorConfig &config, FileEventQueue &eventQueue, Filesystem &filesystem)
+Processor::Processor(const ProcessorConfig &config, FileEventQueue &eventQueue, Filesystem &filesystem,
+                     DestinationDirectoryLocks *destinationDirectoryLocks)
     : pathResolver(filesystem),
+      matcherIndex(config),
       config(config),
       eventQueue(eventQueue),
-      filesystem(filesystem) {}
+      filesystem(filesystem),
+      destinationDirectoryLocks(destinationDirectoryLocks) {
+    compileNameTemplates();
+}
+
+void Processor::compileNameTemplates() {
+    const auto compileNameTemplatesForActions = [this](const std::vector<ProcessorAction> &actions) {
+        for (const ProcessorAction &action : actions) {
+            if (auto data = std::get_if<ProcessorAction::MoveOrCopy>(&action.data); data != nullptr) {
+                nameTemplates.emplace(&action, NameTemplate{data->destinationName});
+            }
+        }
+    };
+
+    if (auto matchers = config.matchers(); matchers != nullptr) {
+        for (const ProcessorActionMatcher &matcher : matchers->matchers) {
+            compileNameTemplatesForActions(matcher.actions);
+        }
+    } else if (auto actions = config.actions(); actions != nullptr) {
+        compileNameTemplatesForActions(actions->actions);
+    }
+}
+
+void Processor::setFilesystemExecutor(FilesystemExecutor *filesystemExecutor, size_t maxEventsInFlight) {
+    this->filesystemExecutor = filesystemExecutor;
+    this->maxEventsInFlight = maxEventsInFlight;
+}
 
 void Processor::run() {
+    if (filesystemExecutor != nullptr) {
+        runWithExecutor();
+        return;
+    }
+
     while (true) {
         FileEvent event{};
         if (!eventQueue.blockingPop(event)) {
@@ -26,13 +59,51 @@ void Processor::run() {
     }
 }
 
+void Processor::runWithExecutor() {
+    using namespace std::chrono_literals;
+    const auto pollInterval = 5ms;
+
+    bool running = true;
+    while (running || !pendingEvents.empty()) {
+        filesystemExecutor->reap(0ms);
+        retryStalledEvents();
+
+        // When too many events are in flight, new ones wait in the queue
+        FileEvent event{};
+        bool eventPopped = false;
+        if (running && pendingEvents.size() < maxEventsInFlight) {
+            if (pendingEvents.empty()) {
+                eventPopped = eventQueue.blockingPop(event);
+                running = eventPopped;
+            } else {
+                eventPopped = eventQueue.nonBlockingPop(event);
+            }
+        }
+
+        if (eventPopped) {
+            if (event.isInterrupt()) {
+                running = false;
+            } else {
+                processEvent(event);
+            }
+        } else if (!pendingEvents.empty()) {
+            filesystemExecutor->reap(pollInterval);
+        }
+    }
+}
+
 void Processor::processEvent(FileEvent &event) {
+    // Events for a file which is still being processed have to wait, so they are handled in order
+    if (auto busyIt = busySourcePaths.find(event.path.native()); busyIt != busySourcePaths.end()) {
+        busyIt->second.push_back(std::move(event));
+        return;
+    }
+
     if (event.isLocked()) {
         filesystem.unlockFile(event.lockedFileHandle);
     }
 
-    if (auto it = std::find(eventsToIgnore.begin(), eventsToIgnore.end(), event); it != eventsToIgnore.end()) {
-        eventsToIgnore.erase(it);
+    if (eventsToIgnore.consume(event)) {
         return;
     }
 
@@ -40,137 +111,244 @@ void Processor::processEvent(FileEvent &event) {
         return;
     }
 
-    if (auto matchers = config.matchers(); matchers != nullptr) {
-        processEventMatchers(*matchers, event);
+    if (config.matchers() != nullptr) {
+        const ProcessorActionMatcher *matcher = matcherIndex.find(event, isEventInSubdirectory(event));
+        if (matcher == nullptr) {
+            log(LogLevel::Info) << "Processor could not match file " << event.path << " to any action matcher";
+            return;
+        }
+        if (event.isFromStartupScan && !matcher->scanOnStartup) {
+            // Directory was scanned for another matcher
+            return;
+        }
+        startEvent(event, matcher->actions, true);
     } else if (auto actions = config.actions(); actions != nullptr) {
-        processEventActions(*actions, event);
+        startEvent(event, actions->actions, false);
     } else {
         FATAL_ERROR("Invalid processor config type");
     }
 }
 
-void Processor::processEventMatchers(const ProcessorConfig::Matchers &configData, FileEvent &event) {
-    const ProcessorActionMatcher *matcher = findActionMatcher(configData, event);
-    if (matcher == nullptr) {
-        log(LogLevel::Info) << "Processor could not match file " << event.path << " to any action matcher";
-        return;
+void Processor::startEvent(FileEvent &event, const std::vector<ProcessorAction> &actions, bool filterActionsByEventType) {
+    if (filesystemExecutor != nullptr) {
+        busySourcePaths.emplace(event.path.native(), std::deque<FileEvent>{});
     }
 
-    ActionMatcherState actionMatcherState{};
-    for (const ProcessorAction &action : matcher->actions) {
-        if (shouldActionBeExecutedForGivenEventType(event.type, action.type)) {
-            executeProcessorAction(event, action, actionMatcherState);
-        }
-    }
-}
-
-void Processor::processEventActions(const ProcessorConfig::Actions &configData, FileEvent &event) {
-    ActionMatcherState actionMatcherState{};
-    for (const ProcessorAction &action : configData.actions) {
-        executeProcessorAction(event, action, actionMatcherState);
-    }
+    pendingEvents.push_back(PendingEvent{std::move(event), &actions, filterActionsByEventType, 0u, {}, {}, {}, 0u, false});
+    continueEvent(std::prev(pendingEvents.end()));
 }
 
-const ProcessorActionMatcher *Processor::findActionMatcher(const ProcessorConfig::Matchers &configData, const FileEvent &event) const {
-    for (const ProcessorActionMatcher &matcher : configData.matchers) {
-        // Filter by watched folder
-        if (event.watchedRootPath != matcher.watchedFolder) {
+void Processor::continueEvent(PendingEventIt pendingEvent) {
+    while (pendingEvent->nextActionIndex < pendingEvent->actions->size()) {
+        const ProcessorAction &action = (*pendingEvent->actions)[pendingEvent->nextActionIndex++];
+        if (pendingEvent->filterActionsByEventType && !shouldActionBeExecutedForGivenEventType(pendingEvent->event.type, action.type)) {
             continue;
         }
 
-        // Filter by file extension
-        if (!matcher.watchedExtensions.empty()) {
-            const auto extension = StringHelper<PathCharType>::removeLeadingDot(event.path.extension());
-            const auto it = std::find(matcher.watchedExtensions.begin(), matcher.watchedExtensions.end(), extension);
-            if (it == matcher.watchedExtensions.end()) {
-                continue;
-            }
+        executeProcessorAction(pendingEvent, action);
+
+        // Completion of the filesystem operation will resume the event
+        if (pendingEvent->operationsInFlight > 0 || pendingEvent->stalled) {
+            return;
         }
+    }
+
+    finishEvent(pendingEvent);
+}
+
+void Processor::finishEvent(PendingEventIt pendingEvent) {
+    if (filesystemExecutor == nullptr) {
+        pendingEvents.erase(pendingEvent);
+        return;
+    }
+
+    auto busyIt = busySourcePaths.find(pendingEvent->event.path.native());
+    std::deque<FileEvent> heldEvents = std::move(busyIt->second);
+    busySourcePaths.erase(busyIt);
+    pendingEvents.erase(pendingEvent);
 
-        // If we haven't filtered this matcher at this point, we can select it.
-        return &matcher;
+    // If one of the held events suspends, it marks the path as busy again and the rest is held again
+    for (FileEvent &heldEvent : heldEvents) {
+        processEvent(heldEvent);
     }
+}
 
-    // We failed to find matching object
-    return nullptr;
+void Processor::retryStalledEvents() {
+    std::deque<PendingEventIt> eventsToRetry{};
+    eventsToRetry.swap(stalledEvents);
+    for (PendingEventIt pendingEvent : eventsToRetry) {
+        pendingEvent->stalled = false;
+        continueEvent(pendingEvent);
+    }
 }
 
-void Processor::executeProcessorAction(const FileEvent &event, const ProcessorAction &action, ActionMatcherState &actionMatcherState) {
+void Processor::executeProcessorAction(PendingEventIt pendingEvent, const ProcessorAction &action) {
     switch (action.type) {
     case ProcessorAction::Type::Copy:
-        executeProcessorActionMoveOrCopy(event, action, actionMatcherState, false);
+        executeProcessorActionMoveOrCopy(pendingEvent, action, false);
         break;
     case ProcessorAction::Type::Move:
-        executeProcessorActionMoveOrCopy(event, action, actionMatcherState, true);
+        executeProcessorActionMoveOrCopy(pendingEvent, action, true);
         break;
     case ProcessorAction::Type::Remove:
-        executeProcessorActionRemove(event, actionMatcherState);
+        executeProcessorActionRemove(pendingEvent);
         break;
     case ProcessorAction::Type::Print:
-        executeProcessorActionPrint(event);
+        executeProcessorActionPrint(pendingEvent->event);
         break;
     default:
         UNREACHABLE_CODE
     }
 }
 
-void Processor::executeProcessorActionMoveOrCopy(const FileEvent &event, const ProcessorAction &action,
-                                                 ActionMatcherState &actionMatcherState, bool isMove) {
-    const auto data = std::get<ProcessorAction::MoveOrCopy>(action.data);
-    const auto dstPath = pathResolver.resolvePath(data.destinationDir, event.path, data.destinationName,
-                                                  actionMatcherState.lastResolvedPath, data.counterStart);
-    actionMatcherState.lastResolvedPath = dstPath;
-    if (dstPath.empty()) {
+void Processor::executeProcessorActionMoveOrCopy(PendingEventIt pendingEvent, const ProcessorAction &action, bool isMove) {
+    const FileEvent &event = pendingEvent->event;
+    ActionMatcherState &actionMatcherState = pendingEvent->actionMatcherState;
+    const auto &data = std::get<ProcessorAction::MoveOrCopy>(action.data);
+    const NameTemplate &nameTemplate = nameTemplates.at(&action);
+
+    // Counter is resolved by looking for free filenames, so no other worker can create files in the destination
+    // directory until we're done. Atomic actions never replace existing files and retry with another counter value
+    // instead, so they don't need it. The lock cannot be held across asynchronous operations, so the operation is
+    // executed synchronously in this case.
+    const bool needsDestinationDirectoryLock = destinationDirectoryLocks != nullptr && nameTemplate.hasCounter() && !data.atomic;
+    std::unique_lock<std::mutex> destinationDirectoryLock{};
+    if (needsDestinationDirectoryLock) {
+        destinationDirectoryLock = destinationDirectoryLocks->lock(data.destinationDir);
+    }
+
+    pendingEvent->previousResolvedPath = std::move(actionMatcherState.lastResolvedPath);
+    pendingEvent->dstPath = pathResolver.resolvePath(data.destinationDir, event.path, nameTemplate,
+                                                     pendingEvent->previousResolvedPath, data.counterStart);
+    actionMatcherState.lastResolvedPath = pendingEvent->dstPath;
+    if (pendingEvent->dstPath.empty()) {
         log(LogLevel::Error) << "Processor could not resolve destination filename.";
         return;
     }
 
+    if (destinationsInFlight.find(pendingEvent->dstPath.native()) != destinationsInFlight.end()) {
+        // Other event is writing to the same file. Retry the action when it's done to keep the order of writes.
+        actionMatcherState.lastResolvedPath = std::move(pendingEvent->previousResolvedPath);
+        pendingEvent->nextActionIndex--;
+        pendingEvent->stalled = true;
+        stalledEvents.push_back(pendingEvent);
+        return;
+    }
+
     const char *verbForLog = isMove ? "moving" : "copying";
-    log(LogLevel::Info) << "Processor " << verbForLog << " file " << event.path << " to " << dstPath;
-
-    OptionalError error{};
-    if (isMove) {
-        error = filesystem.move(event.path, dstPath);
-        executeCrossDeviceMoveFallback(event.path, dstPath, error);
-        if (!error.has_value()) {
-            eventsToIgnore.push_back(FileEvent{event.watchedRootPath, FileEvent::Type::Remove, event.path});
-        }
+    log(LogLevel::Info) << "Processor " << verbForLog << " file " << event.path << " to " << pendingEvent->dstPath;
+    submitMoveOrCopy(pendingEvent, action, isMove, 0u, !needsDestinationDirectoryLock);
+}
+
+void Processor::submitMoveOrCopy(PendingEventIt pendingEvent, const ProcessorAction &action, bool isMove, size_t retry, bool allowAsync) {
+    const auto &data = std::get<ProcessorAction::MoveOrCopy>(action.data);
+
+    FilesystemOperation::Type operationType{};
+    if (data.atomic) {
+        operationType = isMove ? FilesystemOperation::Type::MoveAtomically : FilesystemOperation::Type::CopyAtomically;
     } else {
-        error = filesystem.copy(event.path, dstPath);
+        operationType = isMove ? FilesystemOperation::Type::Move : FilesystemOperation::Type::Copy;
     }
 
-    if (error.has_value()) {
-        std::error_code code = error.value();
-        log(LogLevel::Error) << "Filesystem operation returned code " << code.value() << ": " << code.message();
-    } else {
-        log(LogLevel::VerboseInfo) << "Operation succeeded";
+    if (filesystemExecutor != nullptr && allowAsync) {
+        destinationsInFlight[pendingEvent->dstPath.native()]++;
+
+        // Reserve the counter value, so following events don't resolve the same name before the file is created
+        if (nameTemplates.at(&action).hasCounter()) {
+            pathResolver.notifyFileCreated(pendingEvent->dstPath);
+        }
     }
+
+    auto completion = [this, pendingEvent, &action, isMove, retry, allowAsync](const OptionalError &error) {
+        onMoveOrCopyCompleted(pendingEvent, action, isMove, retry, allowAsync, error);
+    };
+    submitFilesystemOperation(pendingEvent, FilesystemOperation{operationType, pendingEvent->event.path, pendingEvent->dstPath}, std::move(completion), allowAsync);
 }
 
-void Processor::executeCrossDeviceMoveFallback(const fs::path &src, const fs::path &dst, OptionalError &error) {
-    if (error.has_value() && error.value() == std::errc::cross_device_link) {
-        error = filesystem.copy(src, dst);
-        if (error.has_value()) {
-            return;
+void Processor::onMoveOrCopyCompleted(PendingEventIt pendingEvent, const ProcessorAction &action, bool isMove, size_t retry, bool allowAsync, const OptionalError &error) {
+    const FileEvent &event = pendingEvent->event;
+    const auto &data = std::get<ProcessorAction::MoveOrCopy>(action.data);
+    const NameTemplate &nameTemplate = nameTemplates.at(&action);
+
+    if (filesystemExecutor != nullptr && allowAsync) {
+        auto destinationIt = destinationsInFlight.find(pendingEvent->dstPath.native());
+        if (--destinationIt->second == 0) {
+            destinationsInFlight.erase(destinationIt);
         }
+    }
 
-        error = filesystem.remove(src);
-        if (error.has_value()) {
-            log(LogLevel::Error) << "Move operation had to be emulated with copy+remove. Remove operation failed";
+    const char *verbForLog = isMove ? "moving" : "copying";
+    if (data.atomic && error.has_value() && error.value() == std::errc::file_exists && nameTemplate.hasCounter() && retry < maxAtomicRetries) {
+        // Someone else created a file with the resolved name in the meantime
+        pathResolver.notifyFileCreated(pendingEvent->dstPath);
+        pendingEvent->dstPath = pathResolver.resolvePath(data.destinationDir, event.path, nameTemplate,
+                                                         pendingEvent->previousResolvedPath, data.counterStart);
+        pendingEvent->actionMatcherState.lastResolvedPath = pendingEvent->dstPath;
+        if (pendingEvent->dstPath.empty()) {
+            log(LogLevel::Error) << "Processor could not resolve destination filename.";
             return;
         }
+        log(LogLevel::Info) << "Destination file already exists. Processor " << verbForLog << " file " << event.path << " to " << pendingEvent->dstPath;
+        submitMoveOrCopy(pendingEvent, action, isMove, retry + 1, allowAsync);
+        return;
+    }
+
+    if (isMove && !data.atomic && error.has_value() && error.value() == std::errc::cross_device_link) {
+        auto completion = [this, pendingEvent](const OptionalError &error) {
+            if (error.has_value()) {
+                log(LogLevel::Error) << "Move operation across devices failed";
+            } else {
+                log(LogLevel::Info) << "Move operation had to be performed across devices.";
+            }
+            onMoveOrCopyFinished(pendingEvent, true, error);
+        };
+        FilesystemOperation operation{FilesystemOperation::Type::MoveAcrossDevices, event.path, pendingEvent->dstPath};
+        submitFilesystemOperation(pendingEvent, std::move(operation), std::move(completion), allowAsync);
+        return;
+    }
 
-        log(LogLevel::Info) << "Move operation had to be emulated with copy+remove.";
+    onMoveOrCopyFinished(pendingEvent, isMove, error);
+}
+
+void Processor::onMoveOrCopyFinished(PendingEventIt pendingEvent, bool isMove, const OptionalError &error) {
+    if (!error.has_value()) {
+        if (isMove) {
+            eventsToIgnore.add(FileEvent{pendingEvent->event.watchedRootPath, FileEvent::Type::Remove, pendingEvent->event.path});
+        }
+        pathResolver.notifyFileCreated(pendingEvent->dstPath);
     }
+    logOperationResult(error);
 }
 
-void Processor::executeProcessorActionRemove(const FileEvent &event, ActionMatcherState &actionMatcherState) {
-    actionMatcherState.lastResolvedPath = std::filesystem::path{};
+void Processor::executeProcessorActionRemove(PendingEventIt pendingEvent) {
+    const FileEvent &event = pendingEvent->event;
+    pendingEvent->actionMatcherState.lastResolvedPath = std::filesystem::path{};
     log(LogLevel::Info) << "Processor removing file " << event.path;
 
-    const OptionalError error = filesystem.remove(event.path);
-    eventsToIgnore.push_back(FileEvent{event.watchedRootPath, FileEvent::Type::Remove, event.path});
+    eventsToIgnore.add(FileEvent{event.watchedRootPath, FileEvent::Type::Remove, event.path});
+    submitFilesystemOperation(pendingEvent, FilesystemOperation{FilesystemOperation::Type::Remove, event.path, {}}, &Processor::logOperationResult, true);
+}
+
+void Processor::submitFilesystemOperation(PendingEventIt pendingEvent, FilesystemOperation &&operation, FilesystemCompletion &&completion, bool allowAsync) {
+    if (filesystemExecutor == nullptr || !allowAsync) {
+        completion(operation.execute(filesystem));
+        return;
+    }
+
+    pendingEvent->operationsInFlight++;
+    auto resumingCompletion = [this, pendingEvent, completion = std::move(completion)](const OptionalError &error) {
+        pendingEvent->operationsInFlight--;
+        completion(error);
 
+        // Completion could have submitted a follow-up operation
+        if (pendingEvent->operationsInFlight == 0) {
+            continueEvent(pendingEvent);
+        }
+    };
+    filesystemExecutor->submit(std::move(operation), std::move(resumingCompletion));
+}
+
+void Processor::logOperationResult(const OptionalError &error) {
     if (error.has_value()) {
         std::error_code code = error.value();
         log(LogLevel::Error) << "Filesystem operation returned code " << code.value() << ": " << code.message();
@@ -201,6 +379,15 @@ void Processor::executeProcessorActionPrint(const FileEvent &event) const {
     }
 }
 
+bool Processor::isEventInSubdirectory(const FileEvent &event) {
+    const fs::path relativePath = event.path.lexically_relative(event.watchedRootPath);
+    if (relativePath.empty() || *relativePath.begin() == "..") {
+        // Path is not inside the watched folder at all, so we cannot tell
+        return false;
+    }
+    return std::distance(relativePath.begin(), relativePath.end()) > 1;
+}
+
 bool Processor::shouldActionBeExecutedForGivenEventType(FileEvent::Type eventType, ProcessorAction::Type actionType) {
     const bool isNewFile = eventType == FileEvent::Type::Add || eventType == FileEvent::Type::RenameNew;
     const bool isPrintAction = actionType == ProcessorAction::Type::Print;
@@ -1,17 +1,31 @@
 #pragma once
 
+#include "charon/processor/ignored_events.h"
 #include "charon/processor/path_resolver.h"
 #include "charon/processor/processor_config.h"
+#include "charon/processor/processor_matcher_index.h"
 #include "charon/util/class_traits.h"
-#include "charon/watcher/file_event.h"
+#include "charon/util/filesystem_executor.h"
+#include "charon/watcher/file_event_queue.h"
 
+#include <deque>
+#include <list>
+
+class DestinationDirectoryLocks;
 struct Filesystem;
 struct ProcessorConfig;
 struct ProcessorActionMatcher;
 
 class Processor : NonCopyableAndMovable {
 public:
-    Processor(const ProcessorConfig &config, FileEventQueue &eventQueue, Filesystem &filesystem);
+    // Destination directory locks have to be passed if multiple Processors are run concurrently
+    Processor(const ProcessorConfig &config, FileEventQueue &eventQueue, Filesystem &filesystem,
+              DestinationDirectoryLocks *destinationDirectoryLocks = nullptr);
+
+    // Filesystem operations are executed synchronously by default. With an executor, events for different files are
+    // pipelined - new events are processed while filesystem operations of the previous ones are still in flight. Events
+    // for the same file and writes to the same destination file are still executed in order. Has to be called before run().
+    void setFilesystemExecutor(FilesystemExecutor *filesystemExecutor, size_t maxEventsInFlight);
 
     void run();
 
@@ -21,23 +35,61 @@ private:
         std::filesystem::path lastResolvedPath;
     };
 
+    // Event which didn't execute all of its actions yet. Execution is suspended while a filesystem operation is in flight.
+    struct PendingEvent {
+        FileEvent event;
+        const std::vector<ProcessorAction> *actions;
+        bool filterActionsByEventType;
+        size_t nextActionIndex;
+        ActionMatcherState actionMatcherState;
+
+        // State of the currently executed move or copy action
+        std::filesystem::path previousResolvedPath;
+        std::filesystem::path dstPath;
+        size_t operationsInFlight;
+        bool stalled;
+    };
+    using PendingEventIt = std::list<PendingEvent>::iterator;
+
+    void compileNameTemplates();
+    void runWithExecutor();
+
     void processEvent(FileEvent &event);
-    void processEventMatchers(const ProcessorConfig::Matchers &configData, FileEvent &event);
-    void processEventActions(const ProcessorConfig::Actions &configData, FileEvent &event);
-
-    const ProcessorActionMatcher *findActionMatcher(const ProcessorConfig::Matchers &configData, const FileEvent &event) const;
-    void executeProcessorAction(const FileEvent &event, const ProcessorAction &action, ActionMatcherState &actionMatcherState);
-    void executeProcessorActionMoveOrCopy(const FileEvent &event, const ProcessorAction &action,
-                                          ActionMatcherState &actionMatcherState, bool isMove);
-    void executeCrossDeviceMoveFallback(const fs::path &src, const fs::path &dst, OptionalError &error);
-    void executeProcessorActionRemove(const FileEvent &event, ActionMatcherState &actionMatcherState);
+    void startEvent(FileEvent &event, const std::vector<ProcessorAction> &actions, bool filterActionsByEventType);
+    void continueEvent(PendingEventIt pendingEvent);
+    void finishEvent(PendingEventIt pendingEvent);
+    void retryStalledEvents();
+
+    void executeProcessorAction(PendingEventIt pendingEvent, const ProcessorAction &action);
+    void executeProcessorActionMoveOrCopy(PendingEventIt pendingEvent, const ProcessorAction &action, bool isMove);
+    void submitMoveOrCopy(PendingEventIt pendingEvent, const ProcessorAction &action, bool isMove, size_t retry, bool allowAsync);
+    void onMoveOrCopyCompleted(PendingEventIt pendingEvent, const ProcessorAction &action, bool isMove, size_t retry, bool allowAsync, const OptionalError &error);
+    void onMoveOrCopyFinished(PendingEventIt pendingEvent, bool isMove, const OptionalError &error);
+    void executeProcessorActionRemove(PendingEventIt pendingEvent);
     void executeProcessorActionPrint(const FileEvent &event) const;
 
+    void submitFilesystemOperation(PendingEventIt pendingEvent, FilesystemOperation &&operation, FilesystemCompletion &&completion, bool allowAsync);
+    static void logOperationResult(const OptionalError &error);
+
+    static bool isEventInSubdirectory(const FileEvent &event);
     static bool shouldActionBeExecutedForGivenEventType(FileEvent::Type eventType, ProcessorAction::Type actionType);
 
+    constexpr static inline size_t maxAtomicRetries = 16;
+
     PathResolver pathResolver;
-    std::vector<FileEvent> eventsToIgnore{};
+    const ProcessorMatcherIndex matcherIndex;
+    std::unordered_map<const ProcessorAction *, NameTemplate> nameTemplates{};
+    IgnoredEvents eventsToIgnore{};
     const ProcessorConfig &config;
     FileEventQueue &eventQueue;
     Filesystem &filesystem;
+    DestinationDirectoryLocks *destinationDirectoryLocks;
+
+    // Pipelining
+    FilesystemExecutor *filesystemExecutor = nullptr;
+    size_t maxEventsInFlight = 0u;
+    std::list<PendingEvent> pendingEvents = {};
+    std::deque<PendingEventIt> stalledEvents = {};
+    std::unordered_map<PathStringType, std::deque<FileEvent>> busySourcePaths = {};
+    std::unordered_map<PathStringType, size_t> destinationsInFlight = {};
 };
@@ -19,6 +19,7 @@ struct ProcessorAction {
         fs::path destinationDir;
         fs::path destinationName;
         size_t counterStart;
+        bool atomic;
     };
     struct Remove {};
     struct Print {};
@@ -32,6 +33,8 @@ struct ProcessorAction {
 
 struct ProcessorActionMatcher {
     std::filesystem::path watchedFolder;
+    bool recursive = false;
+    bool scanOnStartup = false;
     std::vector<std::filesystem::path> watchedExtensions;
     std::vector<ProcessorAction> actions;
 };
@@ -81,6 +81,22 @@ bool ProcessConfigReader::parseProcessorActionMatcher(ProcessorActionMatcher &ou
         return false;
     }
 
+    if (auto it = node.find("recursive"); it != node.end()) {
+        if (!it->is_boolean()) {
+            log(LogLevel::Error) << "Action matcher \"recursive\" member must be a boolean.";
+            return false;
+        }
+        outActionMatcher.recursive = it->get<bool>();
+    }
+
+    if (auto it = node.find("scanOnStartup"); it != node.end()) {
+        if (!it->is_boolean()) {
+            log(LogLevel::Error) << "Action matcher \"scanOnStartup\" member must be a boolean.";
+            return false;
+        }
+        outActionMatcher.scanOnStartup = it->get<bool>();
+    }
+
     if (auto it = node.find("extensions"); it != node.end()) {
         if (!it->is_array()) {
             log(LogLevel::Error) << "Action matcher \"extensions\" member must be an array.";
@@ -169,6 +185,14 @@ bool ProcessConfigReader::parseProcessorAction(ProcessorAction &outAction, const
             data.counterStart = it->get<size_t>();
         }
 
+        if (auto it = node.find("atomic"); it != node.end()) {
+            if (!it->is_boolean()) {
+                log(LogLevel::Error) << "Field \"atomic\" must be a boolean.";
+                return false;
+            }
+            data.atomic = it->get<bool>();
+        }
+
         outAction.data = data;
         break;
     }
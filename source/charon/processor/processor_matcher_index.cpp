@@ -0,0 +1,75 @@
+#include "charon/processor/processor_matcher_index.h"
+#include "charon/util/string_helper.h"
+
+ProcessorMatcherIndex::ProcessorMatcherIndex(const ProcessorConfig &config) {
+    const ProcessorConfig::Matchers *matchers = config.matchers();
+    if (matchers == nullptr) {
+        return;
+    }
+
+    // First pass - matchers for specific extensions. Candidates are set only once, so earlier matchers win.
+    for (const ProcessorActionMatcher &matcher : matchers->matchers) {
+        WatchedFolder &watchedFolder = watchedFolders[normalizeWatchedFolder(matcher.watchedFolder)];
+        for (const fs::path &extension : matcher.watchedExtensions) {
+            watchedFolder.candidatesForExtension[extension.native()].add(matcher);
+        }
+        if (matcher.watchedExtensions.empty()) {
+            watchedFolder.candidatesForAnyExtension.add(matcher);
+        }
+    }
+
+    // Second pass - matchers accepting any extension have to be considered for specific extensions as well, but only
+    // if they come before the matchers selected so far. Matchers are stored in a vector, so their addresses reflect
+    // the order in the config.
+    for (auto &[watchedFolderPath, watchedFolder] : watchedFolders) {
+        const Candidates &anyExtension = watchedFolder.candidatesForAnyExtension;
+        for (auto &[extension, candidates] : watchedFolder.candidatesForExtension) {
+            if (anyExtension.directMatcher != nullptr && (candidates.directMatcher == nullptr || anyExtension.directMatcher < candidates.directMatcher)) {
+                candidates.directMatcher = anyExtension.directMatcher;
+            }
+            if (anyExtension.subdirectoryMatcher != nullptr && (candidates.subdirectoryMatcher == nullptr || anyExtension.subdirectoryMatcher < candidates.subdirectoryMatcher)) {
+                candidates.subdirectoryMatcher = anyExtension.subdirectoryMatcher;
+            }
+        }
+    }
+}
+
+const ProcessorActionMatcher *ProcessorMatcherIndex::find(const FileEvent &event, bool isEventInSubdirectory) const {
+    // Watchers are created for normalized folders, so normalizing is needed only for events coming from elsewhere
+    auto watchedFolder = watchedFolders.find(event.watchedRootPath.native());
+    if (watchedFolder == watchedFolders.end()) {
+        watchedFolder = watchedFolders.find(normalizeWatchedFolder(event.watchedRootPath));
+        if (watchedFolder == watchedFolders.end()) {
+            return nullptr;
+        }
+    }
+
+    const auto extension = StringHelper<PathCharType>::removeLeadingDot(event.path.extension());
+    const auto candidates = watchedFolder->second.candidatesForExtension.find(extension);
+    if (candidates == watchedFolder->second.candidatesForExtension.end()) {
+        return watchedFolder->second.candidatesForAnyExtension.get(isEventInSubdirectory);
+    }
+    return candidates->second.get(isEventInSubdirectory);
+}
+
+PathStringType ProcessorMatcherIndex::normalizeWatchedFolder(const fs::path &watchedFolder) {
+    fs::path result = watchedFolder.lexically_normal();
+    if (!result.has_filename() && result.has_relative_path()) {
+        result = result.parent_path(); // trailing separator
+    }
+    return result.native();
+}
+
+void ProcessorMatcherIndex::Candidates::add(const ProcessorActionMatcher &matcher) {
+    if (directMatcher == nullptr) {
+        directMatcher = &matcher;
+    }
+    // Only recursive matchers can handle files which are not directly in the watched folder
+    if (subdirectoryMatcher == nullptr && matcher.recursive) {
+        subdirectoryMatcher = &matcher;
+    }
+}
+
+const ProcessorActionMatcher *ProcessorMatcherIndex::Candidates::get(bool isEventInSubdirectory) const {
+    return isEventInSubdirectory ? subdirectoryMatcher : directMatcher;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "charon/processor/processor_config.h"
+#include "charon/util/class_traits.h"
+#include "charon/watcher/file_event.h"
+
+#include <unordered_map>
+
+// Compiled form of the action matchers from the config, allowing to find a matcher for an event without iterating
+// over all of them. Matchers are grouped by watched folder and then by extension. For each such pair the index stores
+// the first matcher which would be selected for a file directly in the watched folder and the first one which would be
+// selected for a file in its subdirectory, so first-match semantics of the config are preserved.
+//
+// The index points to the matchers in the config, so the config cannot be modified while the index is used.
+class ProcessorMatcherIndex : NonCopyableAndMovable {
+public:
+    // Index is empty if the config doesn't contain matchers
+    explicit ProcessorMatcherIndex(const ProcessorConfig &config);
+
+    const ProcessorActionMatcher *find(const FileEvent &event, bool isEventInSubdirectory) const;
+
+    // Spelling of a watched folder used as its identity, so "dir", "dir/" and "dir/./" refer to the same folder.
+    // Callers deduplicating watched folders should use it as well.
+    static PathStringType normalizeWatchedFolder(const fs::path &watchedFolder);
+
+private:
+    struct Candidates {
+        const ProcessorActionMatcher *directMatcher = nullptr;
+        const ProcessorActionMatcher *subdirectoryMatcher = nullptr;
+
+        void add(const ProcessorActionMatcher &matcher);
+        const ProcessorActionMatcher *get(bool isEventInSubdirectory) const;
+    };
+    struct WatchedFolder {
+        std::unordered_map<PathStringType, Candidates> candidatesForExtension = {};
+        Candidates candidatesForAnyExtension = {};
+    };
+
+    std::unordered_map<PathStringType, WatchedFolder> watchedFolders = {};
+};
@@ -0,0 +1,90 @@
+#include "charon/processor/destination_directory_locks.h"
+#include "charon/processor/processor.h"
+#include "charon/processor/processor_pool.h"
+#include "charon/util/filesystem_executor.h"
+#include "charon/util/logger.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+ProcessorPool::ProcessorPool(const ProcessorConfig &config, FileEventQueue &inputQueue, Filesystem &filesystem)
+    : config(config),
+      inputQueue(inputQueue),
+      filesystem(filesystem) {}
+
+void ProcessorPool::run() {
+    if (workersCount <= 1) {
+        // Don't bother with distributing events, just process them on the current thread
+        Processor processor{config, inputQueue, filesystem};
+        auto filesystemExecutor = createFilesystemExecutor(processor);
+        processor.run();
+    } else {
+        runWorkers();
+    }
+}
+
+void ProcessorPool::runWorkers() {
+    DestinationDirectoryLocks destinationDirectoryLocks{};
+    std::vector<std::unique_ptr<FileEventQueue>> workerQueues{};
+    std::vector<std::unique_ptr<Processor>> processors{};
+    std::vector<std::unique_ptr<FilesystemExecutor>> filesystemExecutors{};
+    std::vector<std::thread> workers{};
+    const size_t capacityPerWorker = workerQueueCapacity == 0 ? 0u : std::max<size_t>((workerQueueCapacity + workersCount - 1) / workersCount, 1u);
+    for (size_t workerIndex = 0u; workerIndex < workersCount; workerIndex++) {
+        workerQueues.push_back(std::make_unique<FileEventQueue>());
+        if (capacityPerWorker > 0) {
+            const std::string journalName = "charon_processor_worker" + std::to_string(workerIndex) + "_events.journal";
+            workerQueues.back()->setCapacity(capacityPerWorker, workerQueueOverflowPolicy, journalDirectory / journalName);
+        }
+        processors.push_back(std::make_unique<Processor>(config, *workerQueues.back(), filesystem, &destinationDirectoryLocks));
+        filesystemExecutors.push_back(createFilesystemExecutor(*processors.back()));
+        workers.emplace_back([&processor = *processors.back()]() {
+            processor.run();
+        });
+    }
+
+    // Distribute events in batches, so each worker is woken up once per batch
+    std::vector<std::vector<FileEvent>> batches(workersCount);
+    bool running = true;
+    while (running) {
+        FileEvent event{};
+        if (!inputQueue.blockingPop(event)) {
+            break;
+        }
+        do {
+            if (event.isInterrupt()) {
+                running = false;
+                break;
+            }
+            const size_t workerIndex = selectWorker(event);
+            batches[workerIndex].push_back(std::move(event));
+        } while (inputQueue.nonBlockingPop(event));
+
+        for (size_t workerIndex = 0u; workerIndex < workersCount; workerIndex++) {
+            workerQueues[workerIndex]->pushBatch(batches[workerIndex]);
+        }
+    }
+
+    // Workers finish processing their events before the interrupt
+    for (size_t workerIndex = 0u; workerIndex < workersCount; workerIndex++) {
+        workerQueues[workerIndex]->push(FileEvent::interruptEvent);
+        workers[workerIndex].join();
+    }
+}
+
+size_t ProcessorPool::selectWorker(const FileEvent &event) const {
+    const size_t hash = std::hash<PathStringType>{}(event.path.native());
+    return hash % workersCount;
+}
+
+std::unique_ptr<FilesystemExecutor> ProcessorPool::createFilesystemExecutor(Processor &processor) const {
+    if (filesystemQueueDepth == 0) {
+        return nullptr;
+    }
+
+    auto filesystemExecutor = FilesystemExecutor::create(filesystem, filesystemQueueDepth);
+    log(LogLevel::VerboseInfo) << "Processor executes filesystem operations with " << filesystemExecutor->getName();
+    processor.setFilesystemExecutor(filesystemExecutor.get(), filesystemQueueDepth);
+    return filesystemExecutor;
+}
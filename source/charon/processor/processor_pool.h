@@ -0,0 +1,51 @@
+#pragma once
+
+#include "charon/util/class_traits.h"
+#include "charon/watcher/file_event_queue.h"
+
+#include <memory>
+
+class FilesystemExecutor;
+class Processor;
+struct Filesystem;
+struct ProcessorConfig;
+
+// Runs multiple Processors in parallel, so independent files (e.g. copied to different disks) don't wait for each other.
+// Events are distributed to the workers based on a hash of their source path. This way all events for a given file
+// are processed by the same worker in the order they arrived, and ignored events registered by the worker (e.g. removal
+// of a moved file) are always checked by the worker which registered them.
+class ProcessorPool : NonCopyableAndMovable {
+public:
+    ProcessorPool(const ProcessorConfig &config, FileEventQueue &inputQueue, Filesystem &filesystem);
+
+    // Has to be called before run()
+    void setWorkersCount(size_t workersCount) { this->workersCount = workersCount; }
+
+    // Maximum number of filesystem operations each worker keeps in flight. 0 means operations are executed
+    // synchronously. Has to be called before run().
+    void setFilesystemQueueDepth(size_t filesystemQueueDepth) { this->filesystemQueueDepth = filesystemQueueDepth; }
+
+    // Capacity is split between queues of the workers, so together they hold as many events as the input queue and
+    // events are distributed only as fast as the workers process them. Has to be called before run().
+    void setWorkerQueueCapacity(size_t capacity, FileEventQueue::OverflowPolicy overflowPolicy, const fs::path &journalDirectory) {
+        this->workerQueueCapacity = capacity;
+        this->workerQueueOverflowPolicy = overflowPolicy;
+        this->journalDirectory = journalDirectory;
+    }
+
+    void run();
+
+private:
+    void runWorkers();
+    size_t selectWorker(const FileEvent &event) const;
+    std::unique_ptr<FilesystemExecutor> createFilesystemExecutor(Processor &processor) const;
+
+    const ProcessorConfig &config;
+    FileEventQueue &inputQueue;
+    Filesystem &filesystem;
+    size_t workersCount = 1u;
+    size_t filesystemQueueDepth = 0u;
+    size_t workerQueueCapacity = 0u;
+    FileEventQueue::OverflowPolicy workerQueueOverflowPolicy = FileEventQueue::OverflowPolicy::Block;
+    fs::path journalDirectory = {};
+};
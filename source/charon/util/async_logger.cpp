@@ -0,0 +1,138 @@
+#include "charon/util/async_logger.h"
+
+AsyncLogger::AsyncLogger(Logger &target, size_t capacity, OverflowPolicy overflowPolicy)
+    : target(target),
+      ring(capacity, overflowPolicy) {
+    setEnabledLogLevels(target.getEnabledLogLevels());
+    for (size_t i = 0; i < ring.getCapacity(); i++) {
+        ring.at(i).message.reserve(preallocatedMessageSize);
+    }
+    backgroundThread = std::thread{[this]() { run(); }};
+}
+
+AsyncLogger::~AsyncLogger() {
+    stopping.store(true, std::memory_order_seq_cst);
+    {
+        std::lock_guard lock{sleepMutex};
+        sleepConditionVariable.notify_one();
+    }
+    backgroundThread.join();
+}
+
+void AsyncLogger::log(LogLevel level, const std::string &message) {
+    push(level, [&message](Entry &entry) {
+        entry.isRecord = false;
+        entry.message.assign(message);
+    });
+}
+
+void AsyncLogger::logRecord(LogLevel level, const LogRecord &record) {
+    push(level, [&record](Entry &entry) {
+        entry.isRecord = true;
+        entry.record.assign(record);
+    });
+}
+
+template <typename FillEntry>
+void AsyncLogger::push(LogLevel level, FillEntry &&fillEntry) {
+    size_t position{};
+    if (!ring.reserve(position)) {
+        droppedMessagesCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Entry's strings are preallocated, so short messages are copied without allocating memory
+    Entry &entry = ring.at(position);
+    entry.level = level;
+    fillEntry(entry);
+    ring.publish(position);
+
+    wakeUpBackgroundThread();
+}
+
+void AsyncLogger::flush() {
+    const size_t position = ring.getEnqueuePosition();
+    {
+        std::lock_guard lock{sleepMutex};
+        sleepConditionVariable.notify_one();
+    }
+
+    std::unique_lock lock{flushMutex};
+    flushConditionVariable.wait(lock, [&]() { return flushedPosition >= position; });
+}
+
+size_t AsyncLogger::writeBatch() {
+    size_t writtenCount = 0u;
+    for (; writtenCount < maxBatchSize; writtenCount++) {
+        const Entry *entry = ring.front();
+        if (entry == nullptr) {
+            break;
+        }
+        if (entry->isRecord) {
+            target.logRecord(entry->level, entry->record);
+        } else {
+            target.log(entry->level, entry->message);
+        }
+        ring.pop();
+    }
+    return writtenCount;
+}
+
+void AsyncLogger::reportDroppedMessages() {
+    const size_t droppedCount = droppedMessagesCount.load(std::memory_order_relaxed);
+    if (droppedCount > reportedDroppedMessagesCount) {
+        target.log(LogLevel::Warning, "Dropped " + std::to_string(droppedCount - reportedDroppedMessagesCount) + " log messages, because the log queue was full.");
+        reportedDroppedMessagesCount = droppedCount;
+    }
+}
+
+void AsyncLogger::wakeUpBackgroundThread() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (backgroundThreadSleeping.load(std::memory_order_seq_cst)) {
+        std::lock_guard lock{sleepMutex};
+        sleepConditionVariable.notify_one();
+    }
+}
+
+void AsyncLogger::run() {
+    auto lastFlushTime = std::chrono::steady_clock::now();
+    bool hasUnflushedMessages = false;
+
+    while (true) {
+        const bool isStopping = stopping.load(std::memory_order_seq_cst);
+        const size_t writtenCount = writeBatch();
+        if (writtenCount > 0) {
+            hasUnflushedMessages = true;
+        }
+        reportDroppedMessages();
+
+        const bool isDrained = writtenCount < maxBatchSize;
+        const auto now = std::chrono::steady_clock::now();
+        if (hasUnflushedMessages && (isDrained || now - lastFlushTime >= flushInterval)) {
+            target.flush();
+            lastFlushTime = now;
+            hasUnflushedMessages = false;
+
+            std::lock_guard lock{flushMutex};
+            flushedPosition = ring.getDequeuePosition();
+            flushConditionVariable.notify_all();
+        }
+
+        if (!isDrained) {
+            continue;
+        }
+        if (isStopping) {
+            // Stop flag was read before the last batch, so every message logged before the destructor is written
+            return;
+        }
+
+        // Ring is empty. Announce that we're going to sleep and check again, so a producer which didn't see the flag
+        // is guaranteed to have published its message before our second check.
+        std::unique_lock lock{sleepMutex};
+        backgroundThreadSleeping.store(true, std::memory_order_seq_cst);
+        if (ring.isEmpty() && !stopping.load(std::memory_order_seq_cst)) {
+            sleepConditionVariable.wait_for(lock, flushInterval);
+        }
+        backgroundThreadSleeping.store(false, std::memory_order_relaxed);
+    }
+}
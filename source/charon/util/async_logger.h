@@ -0,0 +1,73 @@
+#pragma once
+
+#include "charon/util/logger.h"
+#include "charon/util/mpsc_ring_buffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Logger which keeps the logging threads away from I/O. Messages are copied into preallocated slots of MpscRingBuffer
+// and a background thread passes them to the target logger.
+// Target logger is called only from the background thread, so it doesn't need any synchronization. It is flushed
+// whenever the ring drains and at least every flushInterval, so a busy thread writes many lines with one syscall.
+class AsyncLogger : public Logger {
+public:
+    // With Drop, discarded messages are counted and reported by the background thread
+    using OverflowPolicy = RingOverflowPolicy;
+
+    constexpr static inline size_t defaultCapacity = 4096u;
+    constexpr static inline size_t maxBatchSize = 256u;
+    constexpr static inline auto flushInterval = std::chrono::milliseconds(100);
+
+    AsyncLogger(Logger &target, size_t capacity, OverflowPolicy overflowPolicy);
+    ~AsyncLogger() override;
+
+    void log(LogLevel level, const std::string &message) override;
+    void logRecord(LogLevel level, const LogRecord &record) override;
+    bool isThreadSafe() const override { return true; }
+    bool acceptsRecords() const override { return target.acceptsRecords(); }
+
+    // Blocks until all messages logged so far are written out by the target logger
+    void flush() override;
+
+    size_t getDroppedMessagesCount() const { return droppedMessagesCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        LogLevel level = {};
+        bool isRecord = false;
+        std::string message = {};
+        LogRecord record = {};
+    };
+
+    constexpr static inline size_t preallocatedMessageSize = 256u;
+
+    template <typename FillEntry>
+    void push(LogLevel level, FillEntry &&fillEntry);
+    size_t writeBatch();
+    void reportDroppedMessages();
+    void wakeUpBackgroundThread();
+    void run();
+
+    Logger &target;
+    MpscRingBuffer<Entry> ring;
+    alignas(64) std::atomic_size_t droppedMessagesCount = 0u;
+
+    // Accessed only by the background thread
+    alignas(64) size_t reportedDroppedMessagesCount = 0u;
+
+    std::atomic_bool backgroundThreadSleeping = false;
+    std::atomic_bool stopping = false;
+    std::mutex sleepMutex = {};
+    std::condition_variable sleepConditionVariable = {};
+
+    std::mutex flushMutex = {};
+    std::condition_variable flushConditionVariable = {};
+    size_t flushedPosition = 0u;
+
+    std::thread backgroundThread = {};
+};
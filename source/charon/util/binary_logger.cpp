@@ -0,0 +1,170 @@
+#include "charon/util/binary_logger.h"
+#include "charon/util/time.h"
+
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+int64_t getMonotonicTimestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t getWallClockTimestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+BinaryLogger::BinaryLogger(const fs::path &logFile, LogLevel allowedLogLevels)
+    : file(logFile) {
+    setEnabledLogLevels(allowedLogLevels);
+    if (!file.isOpen()) {
+        return;
+    }
+
+    if (file.getSize() == 0) {
+        recordBuffer.append(BinaryLogFormat::magic, BinaryLogFormat::magicSize);
+    }
+    appendRecordType(BinaryLogFormat::RecordType::Session);
+    appendValue(getWallClockTimestamp());
+    appendValue(getMonotonicTimestamp());
+    writeRecords();
+}
+
+void BinaryLogger::log(LogLevel level, const std::string &message) {
+    // Messages which didn't come from RaiiLog are stored as a single string argument
+    textRecord.reset();
+    textRecord.appendString(message.data(), message.size());
+    textRecord.setTimestamp(getMonotonicTimestamp());
+    logRecord(level, textRecord);
+}
+
+void BinaryLogger::logRecord(LogLevel level, const LogRecord &record) {
+    if (!isLevelEnabled(level)) {
+        return;
+    }
+
+    const uint64_t formatId = record.getFormatId();
+    const bool isNewFormat = writtenFormatIds.insert(formatId).second;
+    if (isNewFormat) {
+        const std::string &format = record.getFormat();
+        appendRecordType(BinaryLogFormat::RecordType::Format);
+        appendValue(formatId);
+        appendValue(static_cast<uint32_t>(format.size()));
+        recordBuffer.append(format);
+    }
+
+    const std::string &arguments = record.getArguments();
+    appendRecordType(BinaryLogFormat::RecordType::Message);
+    appendValue(static_cast<uint8_t>(level));
+    appendValue(record.getTimestamp());
+    appendValue(formatId);
+    appendValue(static_cast<uint32_t>(arguments.size()));
+    recordBuffer.append(arguments);
+
+    if (!writeRecords() && isNewFormat) {
+        // Format has to be written again with the next message using it
+        writtenFormatIds.erase(formatId);
+    }
+}
+
+void BinaryLogger::appendRecordType(BinaryLogFormat::RecordType type) {
+    appendValue(static_cast<uint8_t>(type));
+}
+
+bool BinaryLogger::writeRecords() {
+    const bool written = file.write(recordBuffer.data(), recordBuffer.size());
+    recordBuffer.clear();
+    return written;
+}
+
+namespace {
+struct BinaryLogCursor {
+    const std::string &contents;
+    size_t position = 0u;
+
+    template <typename T>
+    bool read(T &value) {
+        if (contents.size() - position < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, contents.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    bool read(const char *&data, size_t size) {
+        if (contents.size() - position < size) {
+            return false;
+        }
+        data = contents.data() + position;
+        position += size;
+        return true;
+    }
+};
+} // namespace
+
+bool decodeBinaryLog(const std::string &contents, std::ostream &out) {
+    using RecordType = BinaryLogFormat::RecordType;
+
+    if (contents.compare(0, BinaryLogFormat::magicSize, BinaryLogFormat::magic) != 0) {
+        return false;
+    }
+    BinaryLogCursor cursor{contents, BinaryLogFormat::magicSize};
+
+    int64_t sessionWallClockTimestamp = 0;
+    int64_t sessionMonotonicTimestamp = 0;
+    std::unordered_map<uint64_t, std::string> formats{};
+    std::string text{};
+
+    uint8_t recordType{};
+    while (cursor.read(recordType)) {
+        switch (static_cast<RecordType>(recordType)) {
+        case RecordType::Padding:
+            break;
+        case RecordType::Session:
+            if (!cursor.read(sessionWallClockTimestamp) || !cursor.read(sessionMonotonicTimestamp)) {
+                return false;
+            }
+            formats.clear();
+            break;
+        case RecordType::Format: {
+            uint64_t formatId{};
+            uint32_t length{};
+            const char *format{};
+            if (!cursor.read(formatId) || !cursor.read(length) || !cursor.read(format, length)) {
+                return false;
+            }
+            formats[formatId].assign(format, length);
+            break;
+        }
+        case RecordType::Message: {
+            uint8_t level{};
+            int64_t timestamp{};
+            uint64_t formatId{};
+            uint32_t argumentsSize{};
+            const char *arguments{};
+            if (!cursor.read(level) || !cursor.read(timestamp) || !cursor.read(formatId) || !cursor.read(argumentsSize) || !cursor.read(arguments, argumentsSize)) {
+                return false;
+            }
+            auto formatIt = formats.find(formatId);
+            if (formatIt == formats.end()) {
+                return false;
+            }
+
+            text.clear();
+            if (!LogRecord::render(formatIt->second, arguments, argumentsSize, text)) {
+                return false;
+            }
+            const int64_t wallClockTimestamp = sessionWallClockTimestamp + (timestamp - sessionMonotonicTimestamp);
+            out << '[';
+            TimeImpl::writeTime(out, static_cast<std::time_t>(wallClockTimestamp / 1000000000));
+            out << ']' << getLogLevelPreamble(static_cast<LogLevel>(level)) << ' ' << text << '\n';
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
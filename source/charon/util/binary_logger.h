@@ -0,0 +1,56 @@
+#pragma once
+
+#include "charon/util/logger.h"
+#include "charon/util/mapped_file_writer.h"
+
+#include <string>
+#include <unordered_set>
+
+// Layout of files written by BinaryLogger. All values are stored in native byte order. The file begins with magic
+// followed by records, each starting with a RecordType byte:
+//  - Padding - single zero byte. Unused space left after a crash consists of these.
+//  - Session - int64_t wall-clock time and int64_t monotonic time (both in nanoseconds) taken when the log was opened.
+//  - Format - uint64_t format id, uint32_t length and the format string. Written before the first message using it.
+//  - Message - uint8_t level, int64_t monotonic timestamp, uint64_t format id, uint32_t size and LogRecord arguments.
+struct BinaryLogFormat : NonInstantiatable {
+    constexpr static inline char magic[] = "CHARONBL";
+    constexpr static inline size_t magicSize = sizeof(magic) - 1;
+
+    enum class RecordType : uint8_t {
+        Padding = 0,
+        Session = 1,
+        Format = 2,
+        Message = 3,
+    };
+};
+
+// Stores messages in a compact binary form, which can be converted to text with charon-logcat. Messages logged with
+// RaiiLog are written as raw arguments and an id of their format string, so the hot path doesn't format any numbers,
+// paths or timestamps. Each format string is written only once per session. Each Charon invocation appends to the
+// existing file.
+struct BinaryLogger : Logger {
+    BinaryLogger(const fs::path &logFile, LogLevel allowedLogLevels);
+
+    bool isOpen() const { return file.isOpen(); }
+
+    void log(LogLevel level, const std::string &message) override;
+    void logRecord(LogLevel level, const LogRecord &record) override;
+    bool acceptsRecords() const override { return true; }
+
+private:
+    // Records are assembled in a buffer and written at once, so a failed write doesn't leave a partial record
+    template <typename T>
+    void appendValue(const T &value) {
+        recordBuffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+    void appendRecordType(BinaryLogFormat::RecordType type);
+    bool writeRecords();
+
+    MappedFileWriter file;
+    std::string recordBuffer = {};
+    std::unordered_set<uint64_t> writtenFormatIds = {};
+    LogRecord textRecord = {};
+};
+
+// Renders a binary log the same way FileLogger would write it. Returns false if the log is malformed.
+bool decodeBinaryLog(const std::string &contents, std::ostream &out);
@@ -6,6 +6,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 template <typename T>
 class BlockingQueue : NonCopyableAndMovable {
@@ -26,6 +27,25 @@ public:
         queue.push(std::move(value));
     }
 
+    // Pushes all values under a single lock and wakes consumers once. Values are moved out of the vector, which is
+    // cleared afterwards, so it can be reused by the producer.
+    void pushBatch(std::vector<T> &values) {
+        if (values.empty()) {
+            return;
+        }
+
+        auto lock = this->lock();
+        for (T &value : values) {
+            queue.push(std::move(value));
+        }
+        if (values.size() == 1) {
+            conditionVariable.notify_one();
+        } else {
+            conditionVariable.notify_all();
+        }
+        values.clear();
+    }
+
     bool blockingPop(T &result) {
         const auto infiniteTimeout = std::chrono::hours(1000000);
         return blockingPop(result, infiniteTimeout);
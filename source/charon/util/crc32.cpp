@@ -0,0 +1,50 @@
+#include "charon/util/crc32.h"
+
+#include <array>
+
+namespace {
+using Crc32Table = std::array<std::array<uint32_t, 256>, 4>;
+
+constexpr Crc32Table createCrc32Table() {
+    Crc32Table table{};
+    for (uint32_t byte = 0; byte < 256; byte++) {
+        uint32_t crc = byte;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        table[0][byte] = crc;
+    }
+
+    // Additional tables allow processing 4 bytes per iteration (slicing-by-4)
+    for (uint32_t byte = 0; byte < 256; byte++) {
+        for (size_t slice = 1; slice < table.size(); slice++) {
+            const uint32_t previous = table[slice - 1][byte];
+            table[slice][byte] = (previous >> 8) ^ table[0][previous & 0xFF];
+        }
+    }
+    return table;
+}
+
+constexpr Crc32Table crc32Table = createCrc32Table();
+} // namespace
+
+uint32_t updateCrc32(uint32_t crc, const void *data, size_t size) {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    crc = ~crc;
+
+    for (; size >= 4; size -= 4, bytes += 4) {
+        crc ^= static_cast<uint32_t>(bytes[0]) |
+               static_cast<uint32_t>(bytes[1]) << 8 |
+               static_cast<uint32_t>(bytes[2]) << 16 |
+               static_cast<uint32_t>(bytes[3]) << 24;
+        crc = crc32Table[3][crc & 0xFF] ^
+              crc32Table[2][(crc >> 8) & 0xFF] ^
+              crc32Table[1][(crc >> 16) & 0xFF] ^
+              crc32Table[0][crc >> 24];
+    }
+    for (; size > 0; size--, bytes++) {
+        crc = (crc >> 8) ^ crc32Table[0][(crc ^ *bytes) & 0xFF];
+    }
+
+    return ~crc;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Standard CRC-32 (polynomial 0xEDB88320), as used by zlib and PNG. Data can be passed in chunks by feeding the
+// result of the previous call as the crc argument. Initial value is 0.
+uint32_t updateCrc32(uint32_t crc, const void *data, size_t size);
@@ -0,0 +1,24 @@
+#include "charon/util/directory_enumerator.h"
+
+#include <vector>
+
+bool enumerateFiles(const fs::path &directory, bool recursive, const std::function<void(const fs::path &path)> &callback) {
+    std::vector<fs::path> directoriesToList{};
+    const auto entryCallback = [&](const fs::path &path, fs::file_type type) {
+        if (type == fs::file_type::regular) {
+            callback(path);
+        } else if (type == fs::file_type::directory && recursive) {
+            directoriesToList.push_back(path);
+        }
+    };
+
+    if (!enumerateDirectory(directory, entryCallback)) {
+        return false;
+    }
+    while (!directoriesToList.empty()) {
+        const fs::path currentDirectory = std::move(directoriesToList.back());
+        directoriesToList.pop_back();
+        enumerateDirectory(currentDirectory, entryCallback);
+    }
+    return true;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "charon/util/filesystem.h"
+
+#include <functional>
+
+// Symbolic links are reported as such, they are not followed
+using DirectoryEntryCallback = std::function<void(const fs::path &path, fs::file_type type)>;
+
+// Calls the callback for each entry of the directory, without descending into subdirectories. It's a lightweight
+// alternative to fs::directory_iterator for large directories - entries are read in big batches and their types are
+// taken from the directory listing whenever the filesystem provides them. Returns false if the directory cannot be read.
+bool enumerateDirectory(const fs::path &directory, const DirectoryEntryCallback &callback);
+
+// Calls the callback for each regular file in the directory and, if requested, in all of its subdirectories. Symbolic
+// links are not followed and subdirectories which cannot be read are skipped. Returns false if the directory itself
+// cannot be read.
+bool enumerateFiles(const fs::path &directory, bool recursive, const std::function<void(const fs::path &path)> &callback);
@@ -17,9 +17,18 @@ struct Filesystem : NonCopyableAndMovable {
     virtual ~Filesystem() {}
     virtual OptionalError copy(const fs::path &src, const fs::path &dst) const = 0;
     virtual OptionalError move(const fs::path &src, const fs::path &dst) const = 0;
+    // Used when move fails, because src and dst are on different devices. Destination appears only when it's complete
+    // and the source is removed after that.
+    virtual OptionalError moveAcrossDevices(const fs::path &src, const fs::path &dst) const = 0;
+    // Atomic variants never expose a partially written destination and never replace an existing file. If the
+    // destination exists, std::errc::file_exists is returned. Moves between devices are handled internally.
+    virtual OptionalError copyAtomically(const fs::path &src, const fs::path &dst) const = 0;
+    virtual OptionalError moveAtomically(const fs::path &src, const fs::path &dst) const = 0;
     virtual OptionalError remove(const fs::path &file) const = 0;
     virtual bool isDirectory(const fs::path &path) const = 0;
     virtual std::vector<fs::path> listFiles(const fs::path &directory) const = 0;
+    // Returns std::nullopt if the file doesn't exist or cannot be accessed
+    virtual std::optional<fs::file_time_type> getLastWriteTime(const fs::path &path) const = 0;
 
     enum class LockResult {
         Unknown,
@@ -0,0 +1,91 @@
+#include "charon/util/error.h"
+#include "charon/util/filesystem_executor.h"
+
+OptionalError FilesystemOperation::execute(const Filesystem &filesystem) const {
+    switch (type) {
+    case Type::Copy:
+        return filesystem.copy(src, dst);
+    case Type::Move:
+        return filesystem.move(src, dst);
+    case Type::MoveAcrossDevices:
+        return filesystem.moveAcrossDevices(src, dst);
+    case Type::CopyAtomically:
+        return filesystem.copyAtomically(src, dst);
+    case Type::MoveAtomically:
+        return filesystem.moveAtomically(src, dst);
+    case Type::Remove:
+        return filesystem.remove(src);
+    default:
+        UNREACHABLE_CODE
+    }
+}
+
+void FilesystemExecutor::submit(FilesystemOperation &&operation, FilesystemCompletion &&completion) {
+    const OperationId operationId = nextOperationId++;
+    completions.emplace(operationId, std::move(completion));
+    submitImpl(operationId, std::move(operation));
+}
+
+void FilesystemExecutor::reap(std::chrono::milliseconds timeout) {
+    {
+        std::unique_lock lock{finishedOperationsMutex};
+        finishedOperationsConditionVariable.wait_for(lock, timeout, [this]() { return !finishedOperations.empty(); });
+        finishedOperationsToReap.swap(finishedOperations);
+    }
+
+    for (auto &[operationId, result] : finishedOperationsToReap) {
+        auto completionIt = completions.find(operationId);
+        FATAL_ERROR_IF(completionIt == completions.end(), "Unknown filesystem operation completed");
+        FilesystemCompletion completion = std::move(completionIt->second);
+        completions.erase(completionIt);
+        completion(result);
+    }
+    finishedOperationsToReap.clear();
+}
+
+void FilesystemExecutor::complete(OperationId operationId, const OptionalError &result) {
+    std::lock_guard lock{finishedOperationsMutex};
+    finishedOperations.emplace_back(operationId, result);
+    finishedOperationsConditionVariable.notify_one();
+}
+
+ThreadPoolFilesystemExecutor::ThreadPoolFilesystemExecutor(Filesystem &filesystem, size_t threadsCount)
+    : filesystem(filesystem) {
+    for (size_t threadIndex = 0u; threadIndex < threadsCount; threadIndex++) {
+        workers.emplace_back([this]() { runWorker(); });
+    }
+}
+
+ThreadPoolFilesystemExecutor::~ThreadPoolFilesystemExecutor() {
+    {
+        std::lock_guard lock{queueMutex};
+        stopping = true;
+    }
+    queueConditionVariable.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPoolFilesystemExecutor::submitImpl(OperationId operationId, FilesystemOperation &&operation) {
+    {
+        std::lock_guard lock{queueMutex};
+        queue.emplace_back(operationId, std::move(operation));
+    }
+    queueConditionVariable.notify_one();
+}
+
+void ThreadPoolFilesystemExecutor::runWorker() {
+    while (true) {
+        std::unique_lock lock{queueMutex};
+        queueConditionVariable.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (stopping) {
+            return;
+        }
+        auto [operationId, operation] = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+
+        complete(operationId, operation.execute(filesystem));
+    }
+}
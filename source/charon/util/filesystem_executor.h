@@ -0,0 +1,92 @@
+#pragma once
+
+#include "charon/util/class_traits.h"
+#include "charon/util/filesystem.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct FilesystemOperation {
+    enum class Type {
+        Copy,
+        Move,
+        MoveAcrossDevices,
+        CopyAtomically,
+        MoveAtomically,
+        Remove,
+    };
+
+    Type type;
+    fs::path src;
+    fs::path dst;
+
+    // Performs the operation on the calling thread
+    OptionalError execute(const Filesystem &filesystem) const;
+};
+
+using FilesystemCompletion = std::function<void(const OptionalError &)>;
+
+// Executes filesystem operations asynchronously, so the caller can keep working while many operations are in flight.
+// Completions are never called concurrently - they are run by reap() on the thread which calls it, so they can touch
+// the caller's state without synchronization. Completions may submit new operations.
+class FilesystemExecutor : NonCopyableAndMovable {
+public:
+    // Selects the most efficient implementation available on the current system
+    static std::unique_ptr<FilesystemExecutor> create(Filesystem &filesystem, size_t maxOperationsInFlight);
+
+    virtual ~FilesystemExecutor() = default;
+    virtual const char *getName() const = 0;
+
+    void submit(FilesystemOperation &&operation, FilesystemCompletion &&completion);
+    size_t getOperationsInFlightCount() const { return completions.size(); }
+
+    // Runs completions of finished operations. If none have finished yet, waits up to timeout for the first one.
+    void reap(std::chrono::milliseconds timeout);
+
+protected:
+    using OperationId = uint64_t;
+
+    virtual void submitImpl(OperationId operationId, FilesystemOperation &&operation) = 0;
+
+    // Can be called from any thread
+    void complete(OperationId operationId, const OptionalError &result);
+
+private:
+    OperationId nextOperationId = 0u;
+    std::unordered_map<OperationId, FilesystemCompletion> completions = {};
+
+    std::mutex finishedOperationsMutex = {};
+    std::condition_variable finishedOperationsConditionVariable = {};
+    std::vector<std::pair<OperationId, OptionalError>> finishedOperations = {};
+    std::vector<std::pair<OperationId, OptionalError>> finishedOperationsToReap = {};
+};
+
+// Portable implementation performing blocking calls to Filesystem on a set of worker threads
+class ThreadPoolFilesystemExecutor : public FilesystemExecutor {
+public:
+    ThreadPoolFilesystemExecutor(Filesystem &filesystem, size_t threadsCount);
+    ~ThreadPoolFilesystemExecutor() override;
+
+    const char *getName() const override { return "thread pool"; }
+
+protected:
+    void submitImpl(OperationId operationId, FilesystemOperation &&operation) override;
+
+    Filesystem &filesystem;
+
+private:
+    void runWorker();
+
+    std::vector<std::thread> workers = {};
+    std::mutex queueMutex = {};
+    std::condition_variable queueConditionVariable = {};
+    std::deque<std::pair<OperationId, FilesystemOperation>> queue = {};
+    bool stopping = false;
+};
@@ -1,18 +1,5 @@
 #include "filesystem_impl.h"
 
-OptionalError FilesystemImpl::copy(const fs::path &src, const fs::path &dst) const {
-    fs::create_directories(dst.parent_path());
-
-    std::error_code error{};
-    auto options = std::filesystem::copy_options::overwrite_existing;
-    fs::copy(src, dst, options, error);
-    if (error.value() != 0) {
-        return error;
-    } else {
-        return {};
-    }
-}
-
 OptionalError FilesystemImpl::move(const fs::path &src, const fs::path &dst) const {
     fs::create_directories(dst.parent_path());
 
@@ -50,3 +37,12 @@ std::vector<fs::path> FilesystemImpl::listFiles(const fs::path &directory) const
     }
     return result;
 }
+
+std::optional<fs::file_time_type> FilesystemImpl::getLastWriteTime(const fs::path &path) const {
+    std::error_code error{};
+    const fs::file_time_type result = fs::last_write_time(path, error);
+    if (error.value() != 0) {
+        return std::nullopt;
+    }
+    return result;
+}
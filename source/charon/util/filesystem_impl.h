@@ -5,9 +5,13 @@
 struct FilesystemImpl : Filesystem {
     OptionalError copy(const fs::path &src, const fs::path &dst) const override;
     OptionalError move(const fs::path &src, const fs::path &dst) const override;
+    OptionalError moveAcrossDevices(const fs::path &src, const fs::path &dst) const override;
+    OptionalError copyAtomically(const fs::path &src, const fs::path &dst) const override;
+    OptionalError moveAtomically(const fs::path &src, const fs::path &dst) const override;
     OptionalError remove(const fs::path &file) const override;
     bool isDirectory(const fs::path &path) const override;
     std::vector<fs::path> listFiles(const fs::path &directory) const override;
+    std::optional<fs::file_time_type> getLastWriteTime(const fs::path &path) const override;
 
     virtual bool isFileLockingSupported() const override;
     virtual std::pair<OsHandle, LockResult> lockFile(const fs::path &path) const override;
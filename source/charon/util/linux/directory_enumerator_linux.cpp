@@ -0,0 +1,84 @@
+#include "charon/util/directory_enumerator.h"
+
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+// Layout of records returned by getdents64. Glibc doesn't expose it.
+struct LinuxDirent64 {
+    ino64_t d_ino;
+    off64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1]; // Null-terminated name of variable length
+};
+
+fs::file_type getFileType(mode_t mode) {
+    if (S_ISREG(mode)) {
+        return fs::file_type::regular;
+    } else if (S_ISDIR(mode)) {
+        return fs::file_type::directory;
+    } else if (S_ISLNK(mode)) {
+        return fs::file_type::symlink;
+    } else {
+        return fs::file_type::unknown;
+    }
+}
+
+fs::file_type getEntryType(int directoryFd, const LinuxDirent64 &entry) {
+    switch (entry.d_type) {
+    case DT_REG:
+        return fs::file_type::regular;
+    case DT_DIR:
+        return fs::file_type::directory;
+    case DT_LNK:
+        return fs::file_type::symlink;
+    case DT_UNKNOWN:
+        break;
+    default:
+        return fs::file_type::unknown;
+    }
+
+    // Some filesystems don't store types in directory entries
+    struct stat stats {};
+    if (::fstatat(directoryFd, entry.d_name, &stats, AT_SYMLINK_NOFOLLOW) != 0) {
+        return fs::file_type::not_found;
+    }
+    return getFileType(stats.st_mode);
+}
+} // namespace
+
+bool enumerateDirectory(const fs::path &directory, const DirectoryEntryCallback &callback) {
+    const int directoryFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd < 0) {
+        return false;
+    }
+
+    constexpr size_t bufferSize = 64 * 1024;
+    alignas(LinuxDirent64) char buffer[bufferSize];
+    bool success = true;
+    while (true) {
+        const long bytesRead = ::syscall(SYS_getdents64, directoryFd, buffer, bufferSize);
+        if (bytesRead <= 0) {
+            success = bytesRead == 0;
+            break;
+        }
+
+        for (long offset = 0; offset < bytesRead;) {
+            const auto &entry = *reinterpret_cast<const LinuxDirent64 *>(buffer + offset);
+            offset += entry.d_reclen;
+
+            if (std::strcmp(entry.d_name, ".") == 0 || std::strcmp(entry.d_name, "..") == 0) {
+                continue;
+            }
+            callback(directory / entry.d_name, getEntryType(directoryFd, entry));
+        }
+    }
+
+    ::close(directoryFd);
+    return success;
+}
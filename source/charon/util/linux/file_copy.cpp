@@ -0,0 +1,392 @@
+#include "charon/util/crc32.h"
+#include "charon/util/linux/file_copy.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+
+namespace {
+struct FileDescriptor : NonCopyableAndMovable {
+    explicit FileDescriptor(int fd) : fd(fd) {}
+    ~FileDescriptor() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    const int fd;
+};
+
+std::error_code getErrnoError() {
+    return std::error_code{errno, std::system_category()};
+}
+
+// Errors meaning that given method cannot be used for these files, so we have to try the next one
+bool isMethodUnsupported(int error) {
+    switch (error) {
+    case ENOSYS:
+    case EOPNOTSUPP:
+    case ENOTTY:
+    case EXDEV:
+    case EINVAL:
+    case EBADF:
+    case EPERM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+enum class CopyResult {
+    Success,
+    Unsupported,
+    Failed,
+};
+
+// Copies whole file with a syscall transferring a chunk at a time. Fallback to another method is possible only if
+// nothing was transferred yet, because file offsets could be left in an unknown state.
+template <typename TransferFunction>
+CopyResult copyWithLoop(TransferFunction &&transfer, std::error_code &error) {
+    constexpr size_t chunkSize = 1u << 30;
+    bool anythingTransferred = false;
+    while (true) {
+        const ssize_t transferred = transfer(chunkSize);
+        if (transferred > 0) {
+            anythingTransferred = true;
+            continue;
+        }
+        if (transferred == 0) {
+            return CopyResult::Success;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (!anythingTransferred && isMethodUnsupported(errno)) {
+            return CopyResult::Unsupported;
+        }
+        error = getErrnoError();
+        return CopyResult::Failed;
+    }
+}
+
+CopyResult copyWithClone(int srcFd, int dstFd, std::error_code &error) {
+    if (::ioctl(dstFd, FICLONE, srcFd) == 0) {
+        return CopyResult::Success;
+    }
+    if (isMethodUnsupported(errno)) {
+        return CopyResult::Unsupported;
+    }
+    error = getErrnoError();
+    return CopyResult::Failed;
+}
+
+CopyResult copyWithBufferedLoop(int srcFd, int dstFd, std::error_code &error) {
+    char buffer[64 * 1024];
+    while (true) {
+        const ssize_t readBytes = ::read(srcFd, buffer, sizeof(buffer));
+        if (readBytes == 0) {
+            return CopyResult::Success;
+        }
+        if (readBytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = getErrnoError();
+            return CopyResult::Failed;
+        }
+
+        for (ssize_t writtenBytes = 0; writtenBytes < readBytes;) {
+            const ssize_t result = ::write(dstFd, buffer + writtenBytes, readBytes - writtenBytes);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = getErrnoError();
+                return CopyResult::Failed;
+            }
+            writtenBytes += result;
+        }
+    }
+}
+
+CopyResult copyWithFastestMethod(int srcFd, int dstFd, FileCopyMethod &usedMethod, std::error_code &error) {
+    usedMethod = FileCopyMethod::Clone;
+    CopyResult result = copyWithClone(srcFd, dstFd, error);
+
+    if (result == CopyResult::Unsupported) {
+        usedMethod = FileCopyMethod::CopyFileRange;
+        auto transfer = [&](size_t size) { return ::copy_file_range(srcFd, nullptr, dstFd, nullptr, size, 0); };
+        result = copyWithLoop(transfer, error);
+    }
+
+    if (result == CopyResult::Unsupported) {
+        usedMethod = FileCopyMethod::Sendfile;
+        auto transfer = [&](size_t size) { return ::sendfile(dstFd, srcFd, nullptr, size); };
+        result = copyWithLoop(transfer, error);
+    }
+
+    if (result == CopyResult::Unsupported) {
+        usedMethod = FileCopyMethod::Buffered;
+        result = copyWithBufferedLoop(srcFd, dstFd, error);
+    }
+
+    return result;
+}
+
+// Creates a file with unique hidden name in the same directory as the final path, so it can be atomically renamed
+int createTemporaryFile(const fs::path &finalPath, mode_t mode, fs::path &temporaryPath) {
+    std::string pathTemplate = (finalPath.parent_path() / ("." + finalPath.filename().string() + ".charon-XXXXXX")).string();
+    const int fd = ::mkostemp(pathTemplate.data(), O_CLOEXEC);
+    if (fd >= 0) {
+        temporaryPath = pathTemplate;
+        ::fchmod(fd, mode);
+    }
+    return fd;
+}
+
+// Gives the temporary file its final name. Without replacing, the operation fails if the destination exists, even
+// if it was created by someone else in the meantime.
+void publishTemporaryFile(const fs::path &temporaryPath, const fs::path &dst, bool replaceExisting, std::error_code &error) {
+    if (replaceExisting) {
+        if (::rename(temporaryPath.c_str(), dst.c_str()) != 0) {
+            error = getErrnoError();
+        }
+        return;
+    }
+
+    if (::renameat2(AT_FDCWD, temporaryPath.c_str(), AT_FDCWD, dst.c_str(), RENAME_NOREPLACE) == 0) {
+        return;
+    }
+    if (errno != EINVAL && errno != ENOSYS) {
+        error = getErrnoError();
+        return;
+    }
+
+    // Filesystem doesn't support renameat2 flags, hard link fails atomically if the destination exists
+    if (::link(temporaryPath.c_str(), dst.c_str()) != 0) {
+        error = getErrnoError();
+        return;
+    }
+    ::unlink(temporaryPath.c_str());
+}
+
+bool syncDirectory(const fs::path &directory) {
+    FileDescriptor directoryFile{::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+    return directoryFile.fd >= 0 && ::fsync(directoryFile.fd) == 0;
+}
+
+bool isTheSameFileVersion(const struct stat &left, const struct stat &right) {
+    return left.st_size == right.st_size &&
+           left.st_mtim.tv_sec == right.st_mtim.tv_sec &&
+           left.st_mtim.tv_nsec == right.st_mtim.tv_nsec;
+}
+
+// Written before the file is synced, so it reaches the disk together with the data. Filesystems without user extended
+// attributes simply don't get it, the move doesn't depend on it.
+void storeChecksum(int fd, uint32_t checksum) {
+    char value[9];
+    std::snprintf(value, sizeof(value), "%08x", checksum);
+    ::fsetxattr(fd, checksumAttributeName, value, 8, 0);
+}
+
+CopyResult copyWithChecksum(int srcFd, int dstFd, uint32_t &checksum, off_t &copiedBytes, std::error_code &error) {
+    // Large aligned buffer keeps the number of syscalls low and plays well with disks reading whole pages
+    constexpr size_t bufferSize = 1024 * 1024;
+    constexpr size_t bufferAlignment = 4096;
+    std::unique_ptr<char, decltype(&std::free)> buffer{static_cast<char *>(std::aligned_alloc(bufferAlignment, bufferSize)), &std::free};
+    if (buffer == nullptr) {
+        error = std::make_error_code(std::errc::not_enough_memory);
+        return CopyResult::Failed;
+    }
+
+    ::posix_fadvise(srcFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    checksum = 0;
+    copiedBytes = 0;
+    while (true) {
+        const ssize_t readBytes = ::read(srcFd, buffer.get(), bufferSize);
+        if (readBytes == 0) {
+            return CopyResult::Success;
+        }
+        if (readBytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = getErrnoError();
+            return CopyResult::Failed;
+        }
+        checksum = updateCrc32(checksum, buffer.get(), readBytes);
+        copiedBytes += readBytes;
+
+        for (ssize_t writtenBytes = 0; writtenBytes < readBytes;) {
+            const ssize_t result = ::write(dstFd, buffer.get() + writtenBytes, readBytes - writtenBytes);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = getErrnoError();
+                return CopyResult::Failed;
+            }
+            writtenBytes += result;
+        }
+    }
+}
+} // namespace
+
+const char *getFileCopyMethodName(FileCopyMethod method) {
+    switch (method) {
+    case FileCopyMethod::Clone:
+        return "reflink";
+    case FileCopyMethod::CopyFileRange:
+        return "copy_file_range";
+    case FileCopyMethod::Sendfile:
+        return "sendfile";
+    case FileCopyMethod::Buffered:
+        return "buffered read/write";
+    default:
+        return "unknown";
+    }
+}
+
+OptionalError copyFileContents(const fs::path &src, const fs::path &dst, FileCopyMethod &usedMethod) {
+    FileDescriptor srcFile{::open(src.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (srcFile.fd < 0) {
+        return getErrnoError();
+    }
+    struct stat srcStat {};
+    if (::fstat(srcFile.fd, &srcStat) != 0) {
+        return getErrnoError();
+    }
+    if (!S_ISREG(srcStat.st_mode)) {
+        return std::make_error_code(std::errc::not_supported);
+    }
+
+    // Destination is not truncated on open, because it could be the source file itself
+    FileDescriptor dstFile{::open(dst.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, srcStat.st_mode & 07777)};
+    if (dstFile.fd < 0) {
+        return getErrnoError();
+    }
+    struct stat dstStat {};
+    if (::fstat(dstFile.fd, &dstStat) != 0) {
+        return getErrnoError();
+    }
+    if (srcStat.st_dev == dstStat.st_dev && srcStat.st_ino == dstStat.st_ino) {
+        return std::make_error_code(std::errc::file_exists);
+    }
+    if (::ftruncate(dstFile.fd, 0) != 0) {
+        return getErrnoError();
+    }
+
+    std::error_code error{};
+    if (copyWithFastestMethod(srcFile.fd, dstFile.fd, usedMethod, error) != CopyResult::Success) {
+        return error;
+    }
+    return {};
+}
+
+OptionalError copyFileAtomically(const fs::path &src, const fs::path &dst, FileCopyMethod &usedMethod) {
+    FileDescriptor srcFile{::open(src.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (srcFile.fd < 0) {
+        return getErrnoError();
+    }
+    struct stat srcStat {};
+    if (::fstat(srcFile.fd, &srcStat) != 0) {
+        return getErrnoError();
+    }
+    if (!S_ISREG(srcStat.st_mode)) {
+        return std::make_error_code(std::errc::not_supported);
+    }
+
+    fs::path temporaryPath{};
+    FileDescriptor temporaryFile{createTemporaryFile(dst, srcStat.st_mode & 07777, temporaryPath)};
+    if (temporaryFile.fd < 0) {
+        return getErrnoError();
+    }
+
+    std::error_code error{};
+    if (copyWithFastestMethod(srcFile.fd, temporaryFile.fd, usedMethod, error) == CopyResult::Success) {
+        publishTemporaryFile(temporaryPath, dst, false, error);
+    }
+    if (error) {
+        ::unlink(temporaryPath.c_str());
+        return error;
+    }
+    return {};
+}
+
+OptionalError moveFileAtomically(const fs::path &src, const fs::path &dst, uint32_t &checksum, bool &acrossDevices) {
+    acrossDevices = false;
+    if (::renameat2(AT_FDCWD, src.c_str(), AT_FDCWD, dst.c_str(), RENAME_NOREPLACE) == 0) {
+        return {};
+    }
+    if (errno == EXDEV) {
+        acrossDevices = true;
+        return moveFileAcrossDevices(src, dst, checksum, false);
+    }
+    if (errno != EINVAL && errno != ENOSYS) {
+        return getErrnoError();
+    }
+
+    // Filesystem doesn't support renameat2 flags, hard link fails atomically if the destination exists
+    if (::link(src.c_str(), dst.c_str()) != 0) {
+        return getErrnoError();
+    }
+    if (::unlink(src.c_str()) != 0) {
+        return getErrnoError();
+    }
+    return {};
+}
+
+OptionalError moveFileAcrossDevices(const fs::path &src, const fs::path &dst, uint32_t &checksum, bool replaceExisting) {
+    FileDescriptor srcFile{::open(src.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (srcFile.fd < 0) {
+        return getErrnoError();
+    }
+    struct stat srcStat {};
+    if (::fstat(srcFile.fd, &srcStat) != 0) {
+        return getErrnoError();
+    }
+    if (!S_ISREG(srcStat.st_mode)) {
+        return std::make_error_code(std::errc::not_supported);
+    }
+
+    fs::path temporaryPath{};
+    FileDescriptor temporaryFile{createTemporaryFile(dst, srcStat.st_mode & 07777, temporaryPath)};
+    if (temporaryFile.fd < 0) {
+        return getErrnoError();
+    }
+
+    // Destination must never contain a partial or unsynced copy, so the temporary file is renamed only after all
+    // data reached the disk
+    std::error_code error{};
+    off_t copiedBytes{};
+    struct stat srcStatAfterCopy {};
+    const CopyResult copyResult = copyWithChecksum(srcFile.fd, temporaryFile.fd, checksum, copiedBytes, error);
+    if (copyResult != CopyResult::Success) {
+        // Error is already set by the copy
+    } else if (storeChecksum(temporaryFile.fd, checksum); ::fsync(temporaryFile.fd) != 0) {
+        error = getErrnoError();
+    } else if (::fstat(srcFile.fd, &srcStatAfterCopy) != 0) {
+        error = getErrnoError();
+    } else if (!isTheSameFileVersion(srcStat, srcStatAfterCopy) || copiedBytes != srcStat.st_size) {
+        error = std::make_error_code(std::errc::device_or_resource_busy);
+    } else {
+        publishTemporaryFile(temporaryPath, dst, replaceExisting, error);
+    }
+    if (error) {
+        ::unlink(temporaryPath.c_str());
+        return error;
+    }
+    syncDirectory(dst.parent_path());
+
+    if (::unlink(src.c_str()) != 0) {
+        return getErrnoError();
+    }
+    return {};
+}
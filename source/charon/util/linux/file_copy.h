@@ -0,0 +1,42 @@
+#pragma once
+
+#include "charon/util/filesystem.h"
+
+#include <cstdint>
+
+// Copies contents of a regular file, keeping the data in the kernel whenever possible. Methods are tried from the
+// cheapest one and the next one is used only if the previous is not supported for given pair of files:
+//  - Clone - reflink sharing the extents (btrfs, XFS), no data is copied at all.
+//  - CopyFileRange - in-kernel copy, can also be offloaded by filesystems, such as NFS or SMB.
+//  - Sendfile - in-kernel copy through the page cache.
+//  - Buffered - read/write loop in userspace.
+enum class FileCopyMethod {
+    Clone,
+    CopyFileRange,
+    Sendfile,
+    Buffered,
+};
+
+const char *getFileCopyMethodName(FileCopyMethod method);
+
+// Destination is created with permissions of the source or truncated if it already exists.
+// Method which succeeded is returned in usedMethod.
+OptionalError copyFileContents(const fs::path &src, const fs::path &dst, FileCopyMethod &usedMethod);
+
+// Same as copyFileContents, but data is written to a hidden temporary file in the destination directory, which is
+// renamed to the destination once complete. Existing destination is never replaced, std::errc::file_exists is returned.
+OptionalError copyFileAtomically(const fs::path &src, const fs::path &dst, FileCopyMethod &usedMethod);
+
+constexpr inline const char *checksumAttributeName = "user.charon.crc32";
+
+// Moves a regular file to another filesystem without ever exposing a partially written destination. Data is streamed
+// once into a hidden temporary file next to the destination and its checksum is computed on the fly. The temporary
+// file is synced to disk and renamed to the destination and only then the source is unlinked. If the source is
+// modified during the copy, the operation is aborted and the source is left intact. The checksum is returned and
+// stored in checksumAttributeName extended attribute of the destination as 8 hex digits, so the file can be verified
+// later without reading it again during the move.
+OptionalError moveFileAcrossDevices(const fs::path &src, const fs::path &dst, uint32_t &checksum, bool replaceExisting);
+
+// Renames the file without replacing an existing destination, std::errc::file_exists is returned instead. Falls back
+// to moveFileAcrossDevices if the destination is on another filesystem, which is reported in acrossDevices.
+OptionalError moveFileAtomically(const fs::path &src, const fs::path &dst, uint32_t &checksum, bool &acrossDevices);
@@ -0,0 +1,17 @@
+#include "charon/util/linux/io_uring_filesystem_executor.h"
+#include "charon/util/logger.h"
+
+#include <algorithm>
+
+std::unique_ptr<FilesystemExecutor> FilesystemExecutor::create(Filesystem &filesystem, size_t maxOperationsInFlight) {
+    // Threads are only used for copies when io_uring is available, which are limited by the disk bandwidth anyway
+    constexpr size_t maxThreadsCount = 8u;
+    const size_t threadsCount = std::clamp<size_t>(maxOperationsInFlight, 1u, maxThreadsCount);
+
+    if (auto executor = IoUringFilesystemExecutor::create(filesystem, maxOperationsInFlight, threadsCount); executor != nullptr) {
+        return executor;
+    }
+
+    log(LogLevel::Warning) << "io_uring is not available. Filesystem operations will be executed by a thread pool.";
+    return std::make_unique<ThreadPoolFilesystemExecutor>(filesystem, threadsCount);
+}
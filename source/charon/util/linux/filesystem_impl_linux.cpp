@@ -1,11 +1,192 @@
+#include "charon/util/error.h"
 #include "charon/util/filesystem_impl.h"
+#include "charon/util/linux/file_copy.h"
+#include "charon/util/logger.h"
+
+#include <chrono>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/magic.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+namespace {
+// Writes performed by other hosts are invisible to leases, so files on network filesystems and files we cannot take
+// a lease on have to stay unmodified for some time before they are considered complete
+constexpr auto fileStabilityWindow = std::chrono::seconds(2);
+
+enum class LeaseResult {
+    Granted,
+    Conflict,
+    NotSupported,
+};
+
+// A write lease can be taken only if no one else has the file open. We release it right away, since we only want to
+// know whether the file is in use. The lease break signal is changed to one ignored by default, so a process opening
+// the file in the meantime doesn't kill us with SIGIO.
+LeaseResult probeWriteLease(int fd) {
+    if (::fcntl(fd, F_SETSIG, SIGURG) != 0) {
+        return LeaseResult::NotSupported;
+    }
+    if (::fcntl(fd, F_SETLEASE, F_WRLCK) != 0) {
+        return errno == EAGAIN ? LeaseResult::Conflict : LeaseResult::NotSupported;
+    }
+    ::fcntl(fd, F_SETLEASE, F_UNLCK);
+    return LeaseResult::Granted;
+}
+
+bool isNetworkFilesystem(int fd) {
+    struct statfs stats {};
+    if (::fstatfs(fd, &stats) != 0) {
+        return false;
+    }
+
+    switch (static_cast<uint32_t>(stats.f_type)) {
+    case NFS_SUPER_MAGIC:
+    case SMB_SUPER_MAGIC:
+    case CIFS_SUPER_MAGIC:
+    case SMB2_SUPER_MAGIC:
+    case CEPH_SUPER_MAGIC:
+    case FUSE_SUPER_MAGIC:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool wasModifiedRecently(const struct stat &stats) {
+    const auto toDuration = [](const timespec &time) {
+        return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+    };
+
+    timespec now{};
+    ::clock_gettime(CLOCK_REALTIME, &now);
+    const auto lastChange = std::max(toDuration(stats.st_mtim), toDuration(stats.st_ctim));
+    const auto age = toDuration(now) - lastChange;
+
+    // Clock of a file server can be slightly ahead of ours, so changes from the near future are also recent
+    return age < fileStabilityWindow && age > -fileStabilityWindow;
+}
+} // namespace
+
+OptionalError FilesystemImpl::copy(const fs::path &src, const fs::path &dst) const {
+    fs::create_directories(dst.parent_path());
+
+    std::error_code error{};
+    if (!fs::is_regular_file(src, error)) {
+        fs::copy(src, dst, fs::copy_options::overwrite_existing, error);
+        if (error.value() != 0) {
+            return error;
+        } else {
+            return {};
+        }
+    }
+
+    FileCopyMethod usedMethod{};
+    const OptionalError result = copyFileContents(src, dst, usedMethod);
+    if (!result) {
+        log(LogLevel::VerboseInfo) << "Copied " << src << " using " << getFileCopyMethodName(usedMethod);
+    }
+    return result;
+}
+
+OptionalError FilesystemImpl::moveAcrossDevices(const fs::path &src, const fs::path &dst) const {
+    fs::create_directories(dst.parent_path());
+
+    uint32_t checksum{};
+    const OptionalError result = moveFileAcrossDevices(src, dst, checksum, true);
+    if (!result) {
+        log(LogLevel::VerboseInfo) << "Moved " << src << " across devices, crc32=" << std::hex << checksum;
+    }
+    return result;
+}
+
+OptionalError FilesystemImpl::copyAtomically(const fs::path &src, const fs::path &dst) const {
+    fs::create_directories(dst.parent_path());
+
+    FileCopyMethod usedMethod{};
+    const OptionalError result = copyFileAtomically(src, dst, usedMethod);
+    if (!result) {
+        log(LogLevel::VerboseInfo) << "Copied " << src << " using " << getFileCopyMethodName(usedMethod);
+    }
+    return result;
+}
+
+OptionalError FilesystemImpl::moveAtomically(const fs::path &src, const fs::path &dst) const {
+    fs::create_directories(dst.parent_path());
+
+    uint32_t checksum{};
+    bool acrossDevices{};
+    const OptionalError result = moveFileAtomically(src, dst, checksum, acrossDevices);
+    if (!result && acrossDevices) {
+        log(LogLevel::VerboseInfo) << "Moved " << src << " across devices, crc32=" << std::hex << checksum;
+    }
+    return result;
+}
 
 bool FilesystemImpl::isFileLockingSupported() const {
-    return false;
+    return true;
 }
 
-std::pair<OsHandle, FilesystemImpl::LockResult> FilesystemImpl::lockFile([[maybe_unused]] const fs::path &path) const {
-    return {defaultOsHandle, LockResult::NotSupported};
+std::pair<OsHandle, FilesystemImpl::LockResult> FilesystemImpl::lockFile(const fs::path &path) const {
+    // Linux has no mandatory locks, so the file is only checked for being in use. Keeping it open wouldn't protect it
+    // from other processes, but would cost one descriptor per queued event, so no handle is returned. Opening a file
+    // with someone else's lease would block until the lease is broken, hence O_NONBLOCK.
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        switch (errno) {
+        case ENOENT:
+        case ENOTDIR:
+            return {defaultOsHandle, LockResult::DoesNotExist};
+        case EWOULDBLOCK:
+            return {defaultOsHandle, LockResult::UsedByOtherProcess};
+        case EACCES:
+        case EPERM:
+            return {defaultOsHandle, LockResult::NoAccess};
+        case EMFILE:
+        case ENFILE:
+            // Out of descriptors, the file should be checked again once some of them are closed
+            return {defaultOsHandle, LockResult::UsedByOtherProcess};
+        default:
+            return {defaultOsHandle, LockResult::Unknown};
+        }
+    }
+
+    struct stat stats {};
+    if (::fstat(fd, &stats) != 0) {
+        ::close(fd);
+        return {defaultOsHandle, LockResult::Unknown};
+    }
+    if (!S_ISREG(stats.st_mode)) {
+        ::close(fd);
+        return {defaultOsHandle, LockResult::Success};
+    }
+
+    bool isUsed = false;
+    switch (probeWriteLease(fd)) {
+    case LeaseResult::Conflict:
+        isUsed = true;
+        break;
+    case LeaseResult::Granted:
+        isUsed = isNetworkFilesystem(fd) && wasModifiedRecently(stats);
+        break;
+    case LeaseResult::NotSupported:
+        // E.g. we don't own the file or the filesystem doesn't support leases. Fall back to checking for recent writes.
+        isUsed = wasModifiedRecently(stats);
+        break;
+    default:
+        UNREACHABLE_CODE
+    }
+
+    ::close(fd);
+    return {defaultOsHandle, isUsed ? LockResult::UsedByOtherProcess : LockResult::Success};
 }
 
-void FilesystemImpl::unlockFile([[maybe_unused]] OsHandle &handle) const {}
+void FilesystemImpl::unlockFile(OsHandle &handle) const {
+    if (handle != defaultOsHandle) {
+        ::close(handle);
+    }
+    handle = defaultOsHandle;
+}
@@ -0,0 +1,231 @@
+#include "charon/util/linux/io_uring_filesystem_executor.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+int ioUringSetup(unsigned entries, io_uring_params *params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int ringFd, unsigned opcode, void *arg, unsigned argsCount) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ringFd, opcode, arg, argsCount));
+}
+
+template <typename T>
+T *getRingField(void *ring, uint32_t offset) {
+    return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+} // namespace
+
+std::unique_ptr<IoUringFilesystemExecutor> IoUringFilesystemExecutor::create(Filesystem &filesystem, size_t maxOperationsInFlight, size_t threadsCount) {
+    std::unique_ptr<IoUringFilesystemExecutor> executor{new IoUringFilesystemExecutor(filesystem, threadsCount)};
+    if (!executor->setupRing(static_cast<unsigned>(maxOperationsInFlight)) || !executor->areOperationsSupported()) {
+        return nullptr;
+    }
+    executor->completionThread = std::thread{[executor = executor.get()]() { executor->runCompletionThread(); }};
+    return executor;
+}
+
+IoUringFilesystemExecutor::IoUringFilesystemExecutor(Filesystem &filesystem, size_t threadsCount)
+    : ThreadPoolFilesystemExecutor(filesystem, threadsCount) {}
+
+IoUringFilesystemExecutor::~IoUringFilesystemExecutor() {
+    if (completionThread.joinable()) {
+        while (!pushSubmission(IORING_OP_NOP, shutdownUserData, nullptr, nullptr)) {
+            std::this_thread::yield();
+        }
+        completionThread.join();
+    }
+
+    if (submissionEntries != nullptr) {
+        ::munmap(submissionEntries, submissionEntriesSize);
+    }
+    if (completionRing != nullptr && completionRing != submissionRing) {
+        ::munmap(completionRing, completionRingSize);
+    }
+    if (submissionRing != nullptr) {
+        ::munmap(submissionRing, submissionRingSize);
+    }
+    if (ringFd >= 0) {
+        ::close(ringFd);
+    }
+}
+
+bool IoUringFilesystemExecutor::setupRing(unsigned entries) {
+    io_uring_params params{};
+    ringFd = ioUringSetup(entries, &params);
+    if (ringFd < 0) {
+        return false;
+    }
+
+    submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMapping) {
+        submissionRingSize = std::max(submissionRingSize, completionRingSize);
+        completionRingSize = submissionRingSize;
+    }
+
+    submissionRing = ::mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (submissionRing == MAP_FAILED) {
+        submissionRing = nullptr;
+        return false;
+    }
+    if (singleMapping) {
+        completionRing = submissionRing;
+    } else {
+        completionRing = ::mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (completionRing == MAP_FAILED) {
+            completionRing = nullptr;
+            return false;
+        }
+    }
+    submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *entriesMemory = ::mmap(nullptr, submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (entriesMemory == MAP_FAILED) {
+        return false;
+    }
+    submissionEntries = static_cast<io_uring_sqe *>(entriesMemory);
+    submissionEntriesCount = params.sq_entries;
+
+    submissionHead = getRingField<unsigned>(submissionRing, params.sq_off.head);
+    submissionTail = getRingField<unsigned>(submissionRing, params.sq_off.tail);
+    submissionMask = getRingField<unsigned>(submissionRing, params.sq_off.ring_mask);
+    submissionArray = getRingField<unsigned>(submissionRing, params.sq_off.array);
+    completionHead = getRingField<unsigned>(completionRing, params.cq_off.head);
+    completionTail = getRingField<unsigned>(completionRing, params.cq_off.tail);
+    completionMask = getRingField<unsigned>(completionRing, params.cq_off.ring_mask);
+    completionEntries = getRingField<io_uring_cqe>(completionRing, params.cq_off.cqes);
+    return true;
+}
+
+bool IoUringFilesystemExecutor::areOperationsSupported() {
+    const size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+    std::vector<uint64_t> probeMemory((probeSize + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    auto *probe = reinterpret_cast<io_uring_probe *>(probeMemory.data());
+    if (ioUringRegister(ringFd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+        return false;
+    }
+
+    for (uint8_t opcode : {IORING_OP_NOP, IORING_OP_RENAMEAT, IORING_OP_UNLINKAT}) {
+        if (opcode > probe->last_op || (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void IoUringFilesystemExecutor::submitImpl(OperationId operationId, FilesystemOperation &&operation) {
+    uint8_t opcode{};
+    switch (operation.type) {
+    case FilesystemOperation::Type::Move: {
+        // Same as FilesystemImpl::move. Cross-device moves fail with EXDEV and are handled by the caller.
+        std::error_code error{};
+        fs::create_directories(operation.dst.parent_path(), error);
+        opcode = IORING_OP_RENAMEAT;
+        break;
+    }
+    case FilesystemOperation::Type::Remove:
+        opcode = IORING_OP_UNLINKAT;
+        break;
+    default:
+        ThreadPoolFilesystemExecutor::submitImpl(operationId, std::move(operation));
+        return;
+    }
+
+    const char *path{};
+    const char *secondPath{};
+    {
+        std::lock_guard lock{ringOperationsMutex};
+        if (ringOperations.size() >= submissionEntriesCount) {
+            // Completion queue could overflow, let the thread pool handle it
+            ThreadPoolFilesystemExecutor::submitImpl(operationId, std::move(operation));
+            return;
+        }
+        const FilesystemOperation &storedOperation = ringOperations.emplace(operationId, std::move(operation)).first->second;
+        path = storedOperation.src.c_str();
+        secondPath = storedOperation.dst.c_str();
+    }
+
+    while (!pushSubmission(opcode, operationId, path, secondPath)) {
+        std::this_thread::yield();
+    }
+}
+
+bool IoUringFilesystemExecutor::pushSubmission(uint8_t opcode, uint64_t userData, const char *path, const char *secondPath) {
+    std::lock_guard lock{submissionMutex};
+
+    const unsigned tail = *submissionTail;
+    const unsigned head = __atomic_load_n(submissionHead, __ATOMIC_ACQUIRE);
+    if (tail - head >= submissionEntriesCount) {
+        return false;
+    }
+
+    const unsigned index = tail & *submissionMask;
+    io_uring_sqe &entry = submissionEntries[index];
+    std::memset(&entry, 0, sizeof(entry));
+    entry.opcode = opcode;
+    entry.user_data = userData;
+    switch (opcode) {
+    case IORING_OP_RENAMEAT:
+        entry.fd = AT_FDCWD;
+        entry.addr = reinterpret_cast<uint64_t>(path);
+        entry.len = static_cast<uint32_t>(AT_FDCWD);
+        entry.addr2 = reinterpret_cast<uint64_t>(secondPath);
+        break;
+    case IORING_OP_UNLINKAT:
+        entry.fd = AT_FDCWD;
+        entry.addr = reinterpret_cast<uint64_t>(path);
+        break;
+    default:
+        break;
+    }
+    submissionArray[index] = index;
+    __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+
+    while (ioUringEnter(ringFd, 1, 0, 0) < 0) {
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            break;
+        }
+    }
+    return true;
+}
+
+void IoUringFilesystemExecutor::runCompletionThread() {
+    while (true) {
+        const unsigned head = *completionHead;
+        const unsigned tail = __atomic_load_n(completionTail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            ioUringEnter(ringFd, 0, 1, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+
+        const io_uring_cqe &entry = completionEntries[head & *completionMask];
+        const uint64_t userData = entry.user_data;
+        const int result = entry.res;
+        __atomic_store_n(completionHead, head + 1, __ATOMIC_RELEASE);
+
+        if (userData == shutdownUserData) {
+            return;
+        }
+
+        {
+            std::lock_guard lock{ringOperationsMutex};
+            ringOperations.erase(userData);
+        }
+        if (result < 0) {
+            complete(userData, std::error_code{-result, std::system_category()});
+        } else {
+            complete(userData, std::nullopt);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "charon/util/filesystem_executor.h"
+
+#include <linux/io_uring.h>
+
+// Submits renames and unlinks to an io_uring instance, so the kernel can execute many of them at once without
+// dedicating a thread to each. Operations which cannot be expressed as a single io_uring request (copies, moves with
+// fallbacks) are passed to the thread pool this class extends.
+//
+// The ring is accessed directly with raw syscalls. Submissions are protected by a mutex and completions are read by a
+// dedicated thread, which hands them over to FilesystemExecutor::complete().
+class IoUringFilesystemExecutor : public ThreadPoolFilesystemExecutor {
+public:
+    // Returns nullptr if io_uring or any of the required operations is not supported by the kernel
+    static std::unique_ptr<IoUringFilesystemExecutor> create(Filesystem &filesystem, size_t maxOperationsInFlight, size_t threadsCount);
+    ~IoUringFilesystemExecutor() override;
+
+    const char *getName() const override { return "io_uring"; }
+
+protected:
+    void submitImpl(OperationId operationId, FilesystemOperation &&operation) override;
+
+private:
+    IoUringFilesystemExecutor(Filesystem &filesystem, size_t threadsCount);
+
+    bool setupRing(unsigned entries);
+    bool areOperationsSupported();
+    bool pushSubmission(uint8_t opcode, uint64_t userData, const char *path, const char *secondPath);
+    void runCompletionThread();
+
+    constexpr static inline uint64_t shutdownUserData = ~0ull;
+
+    // Ring memory shared with the kernel
+    int ringFd = -1;
+    void *submissionRing = nullptr;
+    size_t submissionRingSize = 0u;
+    void *completionRing = nullptr;
+    size_t completionRingSize = 0u;
+    io_uring_sqe *submissionEntries = nullptr;
+    size_t submissionEntriesSize = 0u;
+    unsigned submissionEntriesCount = 0u;
+    unsigned *submissionHead = nullptr;
+    unsigned *submissionTail = nullptr;
+    unsigned *submissionMask = nullptr;
+    unsigned *submissionArray = nullptr;
+    unsigned *completionHead = nullptr;
+    unsigned *completionTail = nullptr;
+    unsigned *completionMask = nullptr;
+    io_uring_cqe *completionEntries = nullptr;
+
+    std::mutex submissionMutex = {};
+    std::thread completionThread = {};
+
+    // Operations submitted to the ring. Their paths have to stay valid until the kernel reads them.
+    std::mutex ringOperationsMutex = {};
+    std::unordered_map<OperationId, FilesystemOperation> ringOperations = {};
+};
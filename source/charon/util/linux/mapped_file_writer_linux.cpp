@@ -0,0 +1,55 @@
+#include "charon/util/mapped_file_writer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFileWriter::MappedFileWriter(const fs::path &path, size_t segmentSize)
+    : segmentSize(segmentSize) {
+    file = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (file == -1) {
+        return;
+    }
+
+    struct stat status {};
+    if (::fstat(file, &status) != 0) {
+        ::close(file);
+        file = defaultOsHandle;
+        return;
+    }
+    position = static_cast<uint64_t>(status.st_size);
+}
+
+MappedFileWriter::~MappedFileWriter() {
+    if (!isOpen()) {
+        return;
+    }
+    unmapWindow();
+    [[maybe_unused]] const int result = ::ftruncate(file, static_cast<off_t>(position));
+    ::close(file);
+}
+
+bool MappedFileWriter::mapWindowImpl() {
+    // Blocks have to be allocated up front. Writing to a sparse region of a mapping raises SIGBUS if the disk is full.
+    if (::posix_fallocate(file, static_cast<off_t>(windowOffset), static_cast<off_t>(windowSize)) != 0) {
+        return false;
+    }
+    void *memory = ::mmap(nullptr, windowSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, static_cast<off_t>(windowOffset));
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    window = static_cast<char *>(memory);
+    return true;
+}
+
+void MappedFileWriter::unmapWindow() {
+    if (window != nullptr) {
+        ::munmap(window, windowSize);
+        window = nullptr;
+    }
+}
+
+size_t MappedFileWriter::getWindowAlignment() const {
+    return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
@@ -0,0 +1,11 @@
+#include "charon/util/thread_priority.h"
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+void setCurrentThreadLowPriority() {
+    // On Linux nice value is a per-thread attribute, so a thread id can be passed instead of a process id
+    const auto threadId = static_cast<id_t>(::syscall(SYS_gettid));
+    ::setpriority(PRIO_PROCESS, threadId, 19);
+}
@@ -0,0 +1,15 @@
+#include "charon/util/time.h"
+
+std::time_t TimeImpl::getCurrentTime() {
+    // Coarse clock is read without a syscall or reading the hardware counter. Its resolution of a few milliseconds
+    // is more than enough for timestamps with one second precision.
+    timespec now{};
+    if (::clock_gettime(CLOCK_REALTIME_COARSE, &now) != 0) {
+        return std::time(nullptr);
+    }
+    return now.tv_sec;
+}
+
+void TimeImpl::convertToLocalTime(std::time_t time, std::tm &localTime) {
+    ::localtime_r(&time, &localTime);
+}
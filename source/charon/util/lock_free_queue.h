@@ -0,0 +1,139 @@
+#pragma once
+
+#include "charon/util/class_traits.h"
+#include "charon/util/mpsc_ring_buffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// Bounded multi-producer single-consumer queue with the same interface as BlockingQueue. Values are passed through
+// MpscRingBuffer, so pushing and popping don't take any locks. The mutex and condition variable are used only to put
+// the consumer to sleep when the queue is empty. Producers block (yielding) when the queue is full.
+//
+// Only one thread may call the pop methods and clear() at a time.
+template <typename T>
+class LockFreeQueue : NonCopyableAndMovable {
+public:
+    constexpr static inline size_t defaultCapacity = 16384;
+
+    explicit LockFreeQueue(size_t capacity = defaultCapacity)
+        : ring(capacity, RingOverflowPolicy::Block) {}
+    LockFreeQueue(const LockFreeQueue &) = delete;
+    LockFreeQueue(LockFreeQueue &&) = delete;
+
+    void push(const T &value) {
+        T copy = value;
+        push(std::move(copy));
+    }
+
+    void push(T &&value) {
+        publish(reservePosition(), std::move(value));
+        wakeUpConsumer();
+    }
+
+    void pushBatch(std::vector<T> &values) {
+        if (values.empty()) {
+            return;
+        }
+
+        for (T &value : values) {
+            publish(reservePosition(), std::move(value));
+        }
+        wakeUpConsumer();
+        values.clear();
+    }
+
+    bool blockingPop(T &result) {
+        const auto infiniteTimeout = std::chrono::hours(1000000);
+        return blockingPop(result, infiniteTimeout);
+    }
+
+    template <class Rep, class Period>
+    bool blockingPop(T &result, const std::chrono::duration<Rep, Period> &timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        while (true) {
+            if (blockingPopInterrupted.exchange(false, std::memory_order_acq_rel)) {
+                return false;
+            }
+            if (tryPop(result)) {
+                return true;
+            }
+
+            // Queue is empty. Announce that we're going to sleep and check again, so a producer which didn't see
+            // the flag is guaranteed to have published its value before our second check.
+            std::unique_lock lock{sleepMutex};
+            consumerSleeping.store(true, std::memory_order_seq_cst);
+            if (ring.isEmpty() && !blockingPopInterrupted.load(std::memory_order_seq_cst)) {
+                if (sleepConditionVariable.wait_until(lock, deadline) == std::cv_status::timeout && ring.isEmpty()) {
+                    consumerSleeping.store(false, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+            consumerSleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool nonBlockingPop(T &result) {
+        return tryPop(result);
+    }
+
+    bool empty() {
+        return ring.isEmpty();
+    }
+
+    size_t size() const {
+        return ring.size();
+    }
+
+    void interruptBlockingPop() {
+        blockingPopInterrupted.store(true, std::memory_order_seq_cst);
+        std::lock_guard lock{sleepMutex};
+        sleepConditionVariable.notify_all();
+    }
+
+    void clear() {
+        T value{};
+        while (tryPop(value)) {
+        }
+    }
+
+private:
+    size_t reservePosition() {
+        size_t position{};
+        ring.reserve(position); // never fails with the blocking policy
+        return position;
+    }
+
+    void publish(size_t position, T &&value) {
+        ring.at(position) = std::move(value);
+        ring.publish(position);
+    }
+
+    bool tryPop(T &result) {
+        T *value = ring.front();
+        if (value == nullptr) {
+            return false;
+        }
+        result = std::move(*value);
+        ring.pop();
+        return true;
+    }
+
+    void wakeUpConsumer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumerSleeping.load(std::memory_order_seq_cst)) {
+            std::lock_guard lock{sleepMutex};
+            sleepConditionVariable.notify_one();
+        }
+    }
+
+    MpscRingBuffer<T> ring;
+    alignas(64) std::atomic_bool consumerSleeping = false;
+    std::atomic_bool blockingPopInterrupted = false;
+    std::mutex sleepMutex = {};
+    std::condition_variable sleepConditionVariable = {};
+};
@@ -0,0 +1,120 @@
+#include "charon/util/log_compressor.h"
+#include "charon/util/thread_priority.h"
+
+#include <fstream>
+#include <vector>
+
+#if CHARON_LOG_COMPRESSION
+#include <zlib.h>
+#endif
+
+LogCompressor::LogCompressor() {
+    if (isSupported()) {
+        thread = std::thread{[this]() { run(); }};
+    }
+}
+
+LogCompressor::~LogCompressor() {
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+    }
+    conditionVariable.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool LogCompressor::isSupported() {
+#if CHARON_LOG_COMPRESSION
+    return true;
+#else
+    return false;
+#endif
+}
+
+void LogCompressor::compress(const fs::path &path) {
+    if (!isSupported()) {
+        return;
+    }
+    {
+        std::lock_guard lock{mutex};
+        pendingFiles.push_back(path);
+    }
+    conditionVariable.notify_all();
+}
+
+void LogCompressor::waitForCompletion() {
+    std::unique_lock lock{mutex};
+    conditionVariable.wait(lock, [this]() { return stopping || (pendingFiles.empty() && !isCompressing); });
+}
+
+void LogCompressor::run() {
+    setCurrentThreadLowPriority();
+
+    while (true) {
+        std::unique_lock lock{mutex};
+        conditionVariable.wait(lock, [this]() { return stopping || !pendingFiles.empty(); });
+        if (stopping) {
+            return;
+        }
+        const fs::path path = std::move(pendingFiles.front());
+        pendingFiles.pop_front();
+        isCompressing = true;
+        lock.unlock();
+
+        const bool compressed = compressFile(path);
+        std::error_code error{};
+        if (compressed) {
+            fs::remove(path, error);
+        }
+
+        lock.lock();
+        isCompressing = false;
+        conditionVariable.notify_all();
+    }
+}
+
+bool LogCompressor::compressFile([[maybe_unused]] const fs::path &path) {
+#if CHARON_LOG_COMPRESSION
+    fs::path compressedPath = path;
+    compressedPath += extension;
+    fs::path temporaryPath = compressedPath;
+    temporaryPath += ".tmp";
+
+    std::ifstream input{path, std::ios::in | std::ios::binary};
+    gzFile output = gzopen(temporaryPath.string().c_str(), "wb");
+    if (!input || output == nullptr) {
+        if (output != nullptr) {
+            gzclose(output);
+        }
+        return false;
+    }
+
+    std::vector<char> buffer(256 * 1024);
+    bool success = true;
+    while (success && input) {
+        input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const auto readCount = static_cast<unsigned>(input.gcount());
+        if (readCount > 0 && gzwrite(output, buffer.data(), readCount) != static_cast<int>(readCount)) {
+            success = false;
+        }
+
+        std::lock_guard lock{mutex};
+        success = success && !stopping;
+    }
+    success = gzclose(output) == Z_OK && success && input.eof();
+
+    std::error_code error{};
+    if (success) {
+        fs::rename(temporaryPath, compressedPath, error);
+        success = !error;
+    }
+    if (!success) {
+        fs::remove(temporaryPath, error);
+    }
+    return success;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "charon/util/class_traits.h"
+#include "charon/util/filesystem.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Compresses rotated log files with gzip on a low priority background thread and removes the originals. Compressed
+// data is written to a temporary file, which is renamed only when complete. Files not compressed before the
+// compressor is destroyed are left as they are. If Charon is built without zlib, files are not compressed at all.
+class LogCompressor : NonCopyableAndMovable {
+public:
+    constexpr static inline const char *extension = ".gz";
+
+    LogCompressor();
+    ~LogCompressor();
+
+    static bool isSupported();
+
+    void compress(const fs::path &path);
+    void waitForCompletion();
+
+private:
+    void run();
+    bool compressFile(const fs::path &path);
+
+    std::mutex mutex = {};
+    std::condition_variable conditionVariable = {};
+    std::deque<fs::path> pendingFiles = {};
+    bool isCompressing = false;
+    bool stopping = false;
+    std::thread thread = {};
+};
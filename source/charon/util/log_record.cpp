@@ -0,0 +1,142 @@
+#include "charon/util/log_record.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+LogRecord::LogRecord() {
+    format.reserve(preallocatedSize);
+    arguments.reserve(preallocatedSize);
+}
+
+void LogRecord::reset() {
+    format.clear();
+    arguments.clear();
+    formatId = formatIdSeed;
+    timestamp = 0;
+    isTextValid = false;
+}
+
+void LogRecord::assign(const LogRecord &other) {
+    format.assign(other.format);
+    arguments.assign(other.arguments);
+    formatId = other.formatId;
+    timestamp = other.timestamp;
+    isTextValid = false;
+}
+
+void LogRecord::appendFormat(const char *text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        formatId = (formatId ^ static_cast<uint8_t>(text[i])) * 1099511628211ull; // FNV-1a prime
+    }
+    format.append(text, length);
+}
+
+void LogRecord::appendSigned(int64_t value) {
+    appendArgument(ArgumentType::Signed, &value, sizeof(value));
+}
+
+void LogRecord::appendUnsigned(uint64_t value) {
+    appendArgument(ArgumentType::Unsigned, &value, sizeof(value));
+}
+
+void LogRecord::appendFloating(double value) {
+    appendArgument(ArgumentType::Floating, &value, sizeof(value));
+}
+
+void LogRecord::appendString(const char *text, size_t length) {
+    const auto length32 = static_cast<uint32_t>(length);
+    appendArgument(ArgumentType::String, &length32, sizeof(length32));
+    arguments.append(text, length32);
+}
+
+void LogRecord::appendArgument(ArgumentType type, const void *data, size_t size) {
+    const char placeholder = argumentPlaceholder;
+    appendFormat(&placeholder, 1);
+    arguments.push_back(static_cast<char>(type));
+    arguments.append(static_cast<const char *>(data), size);
+}
+
+const std::string &LogRecord::getText() const {
+    if (!isTextValid) {
+        text.clear();
+        render(format, arguments.data(), arguments.size(), text);
+        isTextValid = true;
+    }
+    return text;
+}
+
+namespace {
+template <typename T>
+bool readArgumentValue(const char *&arguments, const char *argumentsEnd, T &value) {
+    if (static_cast<size_t>(argumentsEnd - arguments) < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, arguments, sizeof(T));
+    arguments += sizeof(T);
+    return true;
+}
+
+template <typename T>
+void appendInteger(std::string &out, T value) {
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+} // namespace
+
+bool LogRecord::render(const std::string &format, const char *arguments, size_t argumentsSize, std::string &out) {
+    const char *argumentsEnd = arguments + argumentsSize;
+    for (const char character : format) {
+        if (character != argumentPlaceholder) {
+            out.push_back(character);
+            continue;
+        }
+
+        uint8_t type{};
+        if (!readArgumentValue(arguments, argumentsEnd, type)) {
+            return false;
+        }
+        switch (static_cast<ArgumentType>(type)) {
+        case ArgumentType::Signed: {
+            int64_t value{};
+            if (!readArgumentValue(arguments, argumentsEnd, value)) {
+                return false;
+            }
+            appendInteger(out, value);
+            break;
+        }
+        case ArgumentType::Unsigned: {
+            uint64_t value{};
+            if (!readArgumentValue(arguments, argumentsEnd, value)) {
+                return false;
+            }
+            appendInteger(out, value);
+            break;
+        }
+        case ArgumentType::Floating: {
+            double value{};
+            if (!readArgumentValue(arguments, argumentsEnd, value)) {
+                return false;
+            }
+            // Same as default formatting of std::ostream
+            char buffer[32];
+            const int length = std::snprintf(buffer, sizeof(buffer), "%g", value);
+            out.append(buffer, static_cast<size_t>(length));
+            break;
+        }
+        case ArgumentType::String: {
+            uint32_t length{};
+            if (!readArgumentValue(arguments, argumentsEnd, length) || static_cast<size_t>(argumentsEnd - arguments) < length) {
+                return false;
+            }
+            out.append(arguments, length);
+            arguments += length;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return arguments == argumentsEnd;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Log message stored as a format string and raw arguments, so it can be written without converting the arguments
+// to text. Each argument is represented in the format by argumentPlaceholder. Arguments are serialized one after
+// another, each preceded by its type.
+class LogRecord {
+public:
+    enum class ArgumentType : uint8_t {
+        Signed = 1,   // int64_t
+        Unsigned = 2, // uint64_t
+        Floating = 3, // double
+        String = 4,   // uint32_t length followed by characters
+    };
+
+    constexpr static inline char argumentPlaceholder = '\x1f';
+
+    LogRecord();
+
+    void reset();
+    void assign(const LogRecord &other);
+
+    void appendFormat(const char *text, size_t length);
+    void appendSigned(int64_t value);
+    void appendUnsigned(uint64_t value);
+    void appendFloating(double value);
+    void appendString(const char *text, size_t length);
+
+    void setTimestamp(int64_t value) { timestamp = value; }
+    int64_t getTimestamp() const { return timestamp; }
+    uint64_t getFormatId() const { return formatId; }
+    const std::string &getFormat() const { return format; }
+    const std::string &getArguments() const { return arguments; }
+
+    // Formats the message the same way RaiiLog would. Result is cached, so many text loggers can share it.
+    const std::string &getText() const;
+
+    // Returns false if arguments are malformed or don't match the format
+    static bool render(const std::string &format, const char *arguments, size_t argumentsSize, std::string &out);
+
+private:
+    constexpr static inline size_t preallocatedSize = 256u;
+    constexpr static inline uint64_t formatIdSeed = 14695981039346656037ull; // FNV-1a offset basis
+
+    void appendArgument(ArgumentType type, const void *data, size_t size);
+
+    std::string format = {};
+    std::string arguments = {};
+    uint64_t formatId = formatIdSeed;
+    int64_t timestamp = 0;
+
+    mutable std::string text = {};
+    mutable bool isTextValid = false;
+};
@@ -1,6 +1,8 @@
 #include "charon/util/logger.h"
 #include "charon/util/time.h"
 
+#include <chrono>
+
 Logger::RaiiSetup::RaiiSetup(Logger *logger) {
     previous = instance;
     instance = logger;
@@ -10,31 +12,86 @@ Logger::RaiiSetup::~RaiiSetup() {
     instance = previous;
 }
 
-RaiiLog::RaiiLog(LogLevel logLevel, Logger &logger)
-    : logger(logger),
-      logLevel(logLevel),
-      lock(logger.mutex) {}
+LogMessageBuffer::LogMessageBuffer() : stream(this) {
+    message.reserve(preallocatedSize);
+}
 
-RaiiLog::~RaiiLog() {
-    logger.log(logLevel, buffer.str());
+void LogMessageBuffer::reset(bool structured) {
+    this->structured = structured;
+    if (structured) {
+        record.reset();
+    }
+    message.clear();
+    stream.clear();
+    stream.flags(defaultFlags);
+    stream.precision(defaultPrecision);
+    stream.width(0);
+    stream.fill(' ');
+}
+
+LogMessageBuffer::int_type LogMessageBuffer::overflow(int_type character) {
+    if (!traits_type::eq_int_type(character, traits_type::eof())) {
+        message.push_back(traits_type::to_char_type(character));
+    }
+    return traits_type::not_eof(character);
+}
+
+std::streamsize LogMessageBuffer::xsputn(const char *data, std::streamsize count) {
+    message.append(data, static_cast<size_t>(count));
+    return count;
+}
+
+namespace {
+thread_local LogMessageBuffer threadLogMessageBuffer{};
+}
+
+void RaiiLog::acquireBuffer() {
+    if (threadLogMessageBuffer.isUsed) {
+        ownBuffer = std::make_unique<LogMessageBuffer>();
+        buffer = ownBuffer.get();
+    } else {
+        buffer = &threadLogMessageBuffer;
+    }
+    buffer->reset(logger.acceptsRecords());
+    buffer->isUsed = true;
 }
 
-RaiiLog log(LogLevel logLevel, Logger *logger) {
-    if (logger == nullptr) {
-        logger = Logger::getInstance();
-        FATAL_ERROR_IF(logger == nullptr, "No logger instance set");
+void RaiiLog::writeMessage() {
+    const auto writeToLogger = [this]() {
+        if (buffer->isStructured()) {
+            LogRecord &record = buffer->getRecord();
+            record.setTimestamp(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+            logger.logRecord(logLevel, record);
+        } else {
+            logger.log(logLevel, buffer->getMessage());
+        }
+    };
+
+    // Message is formatted without any locks, only passing it to the logger has to be serialized
+    if (logger.isThreadSafe()) {
+        writeToLogger();
+    } else {
+        std::lock_guard lock{logger.mutex};
+        writeToLogger();
     }
-    return RaiiLog{logLevel, *logger};
+    buffer->isUsed = false;
 }
 
 void OstreamLogger::log(LogLevel level, const std::string &message) {
-    if ((level & allowedLogLevels) == LogLevel(0)) {
+    if (!isLevelEnabled(level)) {
         return;
     }
 
     writeDate();
     writeLogLevel(level);
-    out << ' ' << message << std::endl;
+    out << ' ' << message << '\n';
+    if (autoFlush) {
+        out.flush();
+    }
+}
+
+void OstreamLogger::flush() {
+    out.flush();
 }
 
 void OstreamLogger::writeDate() {
@@ -44,32 +101,133 @@ void OstreamLogger::writeDate() {
 }
 
 void OstreamLogger::writeLogLevel(LogLevel level) {
-    const char *preamble = nullptr;
+    out << getLogLevelPreamble(level);
+}
+
+const char *getLogLevelPreamble(LogLevel level) {
     switch (level) {
     case LogLevel::Error:
-        preamble = "[Error]";
-        break;
+        return "[Error]";
     case LogLevel::Info:
-        preamble = "[Info]";
-        break;
+        return "[Info]";
     case LogLevel::Warning:
-        preamble = "[Warning]";
-        break;
+        return "[Warning]";
     case LogLevel::Debug:
-        preamble = "[Debug]";
-        break;
+        return "[Debug]";
     case LogLevel::VerboseInfo:
-        preamble = "[VerboseInfo]";
-        break;
+        return "[VerboseInfo]";
     default:
-        preamble = "[Unknown]";
-        break;
+        return "[Unknown]";
     }
-    out << preamble;
 }
 
-FileLogger::FileLogger(const Time &time, const fs::path &logFile, LogLevel allowedLogLevels)
-    : OstreamLogger(time, file, allowedLogLevels),
-      file(logFile, std::ios::app) {}
+CountingStreamBuffer::int_type CountingStreamBuffer::overflow(int_type character) {
+    if (traits_type::eq_int_type(character, traits_type::eof())) {
+        return traits_type::not_eof(character);
+    }
+    count++;
+    return target.sputc(traits_type::to_char_type(character));
+}
+
+std::streamsize CountingStreamBuffer::xsputn(const char *data, std::streamsize count) {
+    const std::streamsize writtenCount = target.sputn(data, count);
+    this->count += static_cast<uint64_t>(writtenCount);
+    return writtenCount;
+}
+
+int CountingStreamBuffer::sync() {
+    return target.pubsync();
+}
+
+FileLogger::FileLogger(const Time &time, const fs::path &logFile, LogLevel allowedLogLevels, const LogRotationPolicy &rotationPolicy)
+    : OstreamLogger(time, stream, allowedLogLevels),
+      logFile(logFile),
+      rotationPolicy(rotationPolicy) {
+    open();
+    if (rotationPolicy.isEnabled()) {
+        compressor = std::make_unique<LogCompressor>();
+    }
+}
+
+void FileLogger::log(LogLevel level, const std::string &message) {
+    OstreamLogger::log(level, message);
+
+    if (rotationPolicy.isEnabled() && file.is_open()) {
+        const bool isTooLarge = rotationPolicy.maxSize > 0u && countingBuffer.getCount() >= rotationPolicy.maxSize;
+        const bool isTooOld = rotationPolicy.maxAge.count() > 0 && std::chrono::steady_clock::now() - openTime >= rotationPolicy.maxAge;
+        if (isTooLarge || isTooOld) {
+            rotate();
+        }
+    }
+}
+
+void FileLogger::waitForCompression() {
+    stream.flush();
+    if (compressor != nullptr) {
+        compressor->waitForCompletion();
+    }
+}
+
+void FileLogger::open() {
+    if (file.open(logFile, std::ios::app) == nullptr) {
+        return;
+    }
+    stream.clear();
+
+    std::error_code error{};
+    const uintmax_t size = fs::file_size(logFile, error);
+    countingBuffer.resetCount(error ? 0u : static_cast<uint64_t>(size));
+    openTime = std::chrono::steady_clock::now();
+}
+
+void FileLogger::rotate() {
+    // The logger is called under a lock, so no line can be written between closing the file and opening the new one.
+    stream.flush();
+    file.close();
+
+    // Current file is linked under the rotated name and then replaced by an empty file with a rename, so readers always
+    // find a log file under the log path. Filesystems without hard links fall back to renaming the current file.
+    const fs::path rotatedFilePath = getRotatedFilePath();
+    std::error_code error{};
+    fs::create_hard_link(logFile, rotatedFilePath, error);
+    if (error) {
+        error.clear();
+        fs::rename(logFile, rotatedFilePath, error);
+    } else {
+        const fs::path newFilePath = fs::path{logFile} += ".new";
+        std::ofstream{newFilePath, std::ios::out | std::ios::trunc}.close();
+        fs::rename(newFilePath, logFile, error);
+        if (error) {
+            std::error_code removeError{};
+            fs::remove(rotatedFilePath, removeError);
+            fs::remove(newFilePath, removeError);
+        }
+    }
+    open();
+
+    if (error) {
+        // Don't retry on every line. Next attempt is made after the file grows by another maxSize or after maxAge.
+        countingBuffer.resetCount(0u);
+        OstreamLogger::log(LogLevel::Error, "Failed to rotate log file: " + error.message());
+        return;
+    }
+    compressor->compress(rotatedFilePath);
+}
+
+fs::path FileLogger::getRotatedFilePath() const {
+    const std::time_t time = std::time(nullptr);
+    std::tm localTime = *std::localtime(&time);
+    char suffix[32] = {};
+    std::strftime(suffix, sizeof(suffix), ".%Y%m%d-%H%M%S", &localTime);
+
+    fs::path result = logFile;
+    result += suffix;
+    for (int index = 1; fs::exists(result) || fs::exists(fs::path{result} += LogCompressor::extension); index++) {
+        result = logFile;
+        result += suffix;
+        result += "." + std::to_string(index);
+    }
+    return result;
+}
 
 void NullLogger::log([[maybe_unused]] LogLevel level, [[maybe_unused]] const std::string &message) {}
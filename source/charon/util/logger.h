@@ -3,12 +3,19 @@
 #include "charon/util/class_traits.h"
 #include "charon/util/error.h"
 #include "charon/util/filesystem.h"
+#include "charon/util/log_compressor.h"
+#include "charon/util/log_record.h"
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
-#include <sstream>
+#include <ostream>
+#include <streambuf>
+#include <type_traits>
 
 struct Time;
 
@@ -26,12 +33,34 @@ constexpr inline LogLevel operator&(LogLevel left, LogLevel right) {
     return LogLevel(std::underlying_type_t<LogLevel>(left) & std::underlying_type_t<LogLevel>(right));
 }
 constexpr static inline LogLevel defaultLogLevel = LogLevel::Error | LogLevel::Info | LogLevel::Warning;
+constexpr static inline LogLevel allLogLevels = defaultLogLevel | LogLevel::Debug | LogLevel::VerboseInfo;
+
+// Levels which can be logged at all. Messages of other levels are removed by the compiler.
+#if CHARON_STRIP_DEBUG_LOGS
+constexpr static inline LogLevel compiledLogLevels = defaultLogLevel | LogLevel::VerboseInfo;
+#else
+constexpr static inline LogLevel compiledLogLevels = allLogLevels;
+#endif
 
 struct Logger : NonCopyableAndMovable {
     virtual ~Logger() {}
     virtual void log(LogLevel level, const std::string &message) = 0;
+    // Writes out messages which were buffered by the logger
+    virtual void flush() {}
+    // Loggers which can be called concurrently don't need RaiiLog to serialize the calls with the mutex
+    virtual bool isThreadSafe() const { return false; }
     std::mutex mutex;
 
+    // Loggers storing messages in binary form get them from RaiiLog as records, without formatting them to text.
+    // Loggers which don't accept records get their text through the default implementation of logRecord().
+    virtual bool acceptsRecords() const { return false; }
+    virtual void logRecord(LogLevel level, const LogRecord &record) { log(level, record.getText()); }
+
+    // Messages of disabled levels are dropped by RaiiLog before they are formatted
+    bool isLevelEnabled(LogLevel level) const { return (level & getEnabledLogLevels()) != LogLevel(0); }
+    LogLevel getEnabledLogLevels() const { return enabledLogLevels.load(std::memory_order_relaxed); }
+    void setEnabledLogLevels(LogLevel levels) { enabledLogLevels.store(levels, std::memory_order_relaxed); }
+
     auto raiiSetup() { return RaiiSetup{*this}; }
     static Logger *getInstance() { return instance; }
 
@@ -46,28 +75,124 @@ struct Logger : NonCopyableAndMovable {
 
 protected:
     static inline Logger *instance = {};
+
+private:
+    std::atomic<LogLevel> enabledLogLevels = allLogLevels;
+};
+
+// Stream buffer appending to a string, which keeps its capacity between messages. Each thread reuses its own instance,
+// so formatting a message doesn't allocate memory once the string has grown large enough.
+//
+// In structured mode arguments are stored in a LogRecord instead. String literals become a part of the format and
+// numbers and strings are stored raw. Other types are formatted with the stream and stored as strings.
+class LogMessageBuffer : public std::streambuf, NonCopyableAndMovable {
+public:
+    LogMessageBuffer();
+
+    void reset(bool structured);
+    std::ostream &getStream() { return stream; }
+    const std::string &getMessage() const { return message; }
+    bool isStructured() const { return structured; }
+    LogRecord &getRecord() { return record; }
+
+    template <typename T>
+    void append(const T &arg) {
+        if (!structured) {
+            stream << arg;
+        } else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>) {
+            record.appendFormat(arg, std::char_traits<char>::length(arg));
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            record.appendString(arg.data(), arg.size());
+        } else if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>) {
+            record.appendString(arg, std::char_traits<char>::length(arg));
+        } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>) {
+            if (stream.flags() != defaultFlags) {
+                appendFormatted(arg);
+            } else if constexpr (std::is_signed_v<T>) {
+                record.appendSigned(static_cast<int64_t>(arg));
+            } else {
+                record.appendUnsigned(static_cast<uint64_t>(arg));
+            }
+        } else if constexpr (std::is_floating_point_v<T>) {
+            if (stream.flags() != defaultFlags || stream.precision() != defaultPrecision) {
+                appendFormatted(arg);
+            } else {
+                record.appendFloating(static_cast<double>(arg));
+            }
+        } else {
+            appendFormatted(arg);
+        }
+    }
+
+    bool isUsed = false;
+
+protected:
+    int_type overflow(int_type character) override;
+    std::streamsize xsputn(const char *data, std::streamsize count) override;
+
+private:
+    constexpr static inline size_t preallocatedSize = 512u;
+    constexpr static inline std::ios::fmtflags defaultFlags = std::ios::dec | std::ios::skipws;
+    constexpr static inline std::streamsize defaultPrecision = 6;
+
+    // Stream manipulators produce no text, but they still change formatting of the following arguments
+    template <typename T>
+    void appendFormatted(const T &arg) {
+        message.clear();
+        stream << arg;
+        if (!message.empty()) {
+            record.appendString(message.data(), message.size());
+        }
+    }
+
+    std::string message = {};
+    std::ostream stream;
+    bool structured = false;
+    LogRecord record = {};
 };
 
-class RaiiLog {
+// Formats a single message and passes it to the logger when destroyed. If the message's level is disabled, nothing is
+// formatted. Everything up to that check is inlined, so messages of levels stripped at compile time are removed entirely.
+class RaiiLog : NonCopyableAndMovable {
 public:
-    RaiiLog(LogLevel logLevel, Logger &logger);
-    ~RaiiLog();
+    RaiiLog(LogLevel logLevel, Logger &logger) : logger(logger), logLevel(logLevel) {
+        if ((logLevel & compiledLogLevels) != LogLevel(0) && logger.isLevelEnabled(logLevel)) {
+            acquireBuffer();
+        }
+    }
+
+    ~RaiiLog() {
+        if (buffer != nullptr) {
+            writeMessage();
+        }
+    }
 
     template <typename T>
     RaiiLog &operator<<(const T &arg) {
-        buffer << arg;
+        if (buffer != nullptr) {
+            buffer->append(arg);
+        }
         return *this;
     }
 
 private:
+    void acquireBuffer();
+    void writeMessage();
+
     Logger &logger;
     const LogLevel logLevel;
-    std::unique_lock<std::mutex> lock;
-    std::ostringstream buffer{};
+    LogMessageBuffer *buffer = nullptr;
+
+    // Used when the thread's buffer is already taken, e.g. by a message logged while formatting another one
+    std::unique_ptr<LogMessageBuffer> ownBuffer = {};
 };
 
 template <>
 inline RaiiLog &RaiiLog::operator<< <std::filesystem::path>(const std::filesystem::path &arg) {
+    if (buffer == nullptr) {
+        return *this;
+    }
+
 #if defined(WIN32)
     // Convert wstring to string while ignoring diacritics
     const std::wstring &src = arg.native();
@@ -79,45 +204,106 @@ inline RaiiLog &RaiiLog::operator<< <std::filesystem::path>(const std::filesyste
     FATAL_ERROR_IF(bytes == 0, "WideCharToMultiByte for conversion checking failed");
 
     std::replace(narrowString.begin(), narrowString.end(), '\\', '/');
-    buffer << narrowString;
+    buffer->append(narrowString);
 #else
-    buffer << arg.native();
+    buffer->append(arg.native());
 #endif
     return *this;
 }
 
-RaiiLog log(LogLevel logLevel, Logger *logger = nullptr);
+inline RaiiLog log(LogLevel logLevel, Logger *logger = nullptr) {
+    if (logger == nullptr) {
+        logger = Logger::getInstance();
+        FATAL_ERROR_IF(logger == nullptr, "No logger instance set");
+    }
+    return RaiiLog{logLevel, *logger};
+}
+
+// Returns a string like "[Info]", which precedes the message in text logs
+const char *getLogLevelPreamble(LogLevel level);
 
 struct OstreamLogger : Logger {
-    OstreamLogger(const Time &time, std::ostream &out, LogLevel allowedLogLevels) : time(time), out(out), allowedLogLevels(allowedLogLevels) {}
+    OstreamLogger(const Time &time, std::ostream &out, LogLevel allowedLogLevels) : time(time), out(out) {
+        setEnabledLogLevels(allowedLogLevels);
+    }
     void log(LogLevel level, const std::string &message) override;
+    void flush() override;
+
+    // When disabled, lines are written out only on flush() or when the stream's buffer fills up
+    void setAutoFlush(bool value) { autoFlush = value; }
 
 private:
     void writeDate();
     void writeLogLevel(LogLevel level);
     const Time &time;
     std::ostream &out;
-    LogLevel allowedLogLevels;
+    bool autoFlush = true;
 };
 
 struct ConsoleLogger : OstreamLogger {
     ConsoleLogger(const Time &time, LogLevel allowedLogLevels) : OstreamLogger(time, std::cout, allowedLogLevels) {}
 };
 
+// Stream buffer passing characters to another buffer and counting them
+class CountingStreamBuffer : public std::streambuf {
+public:
+    CountingStreamBuffer(std::streambuf &target) : target(target) {}
+
+    uint64_t getCount() const { return count; }
+    void resetCount(uint64_t value) { count = value; }
+
+protected:
+    int_type overflow(int_type character) override;
+    std::streamsize xsputn(const char *data, std::streamsize count) override;
+    int sync() override;
+
+private:
+    std::streambuf &target;
+    uint64_t count = 0u;
+};
+
+struct LogRotationPolicy {
+    uint64_t maxSize = 0u;            // 0 means no limit
+    std::chrono::seconds maxAge = {}; // 0 means no limit
+
+    bool isEnabled() const { return maxSize > 0u || maxAge.count() > 0; }
+};
+
+// Appends to the log file. If rotation is enabled, the file is renamed once it exceeds the maximum size or age and a
+// new file is opened in its place. Rotation itself takes only a few metadata operations, so it's done by the thread
+// writing the log. Renamed files are compressed by a low priority background thread.
 struct FileLogger : OstreamLogger {
-    FileLogger(const Time &time, const fs::path &logFile, LogLevel allowedLogLevels);
+    FileLogger(const Time &time, const fs::path &logFile, LogLevel allowedLogLevels, const LogRotationPolicy &rotationPolicy = {});
+
+    void log(LogLevel level, const std::string &message) override;
+
+    // Flushes the file and waits until all rotated files are compressed
+    void waitForCompression();
 
 private:
-    std::ofstream file{};
+    void open();
+    void rotate();
+    fs::path getRotatedFilePath() const;
+
+    const fs::path logFile;
+    const LogRotationPolicy rotationPolicy;
+    std::filebuf file{};
+    CountingStreamBuffer countingBuffer{file};
+    std::ostream stream{&countingBuffer};
+    std::chrono::steady_clock::time_point openTime = {};
+    std::unique_ptr<LogCompressor> compressor = {};
 };
 
 struct NullLogger : Logger {
     void log(LogLevel level, const std::string &message) override;
 };
 
+// Enabled log levels are a sum of levels enabled in the added loggers at the time of adding them. Records are accepted
+// if any of the loggers accepts them.
 struct MultiplexedLogger : Logger {
     template <typename... LoggerTypes>
     MultiplexedLogger(LoggerTypes... args) {
+        setEnabledLogLevels(LogLevel(0));
         add(std::forward<LoggerTypes>(args)...);
     }
 
@@ -126,6 +312,8 @@ struct MultiplexedLogger : Logger {
         std::array<Logger *, sizeof...(args)> pointers = {args...};
         for (Logger *logger : pointers) {
             this->loggers.push_back(logger);
+            setEnabledLogLevels(getEnabledLogLevels() | logger->getEnabledLogLevels());
+            anyLoggerAcceptsRecords = anyLoggerAcceptsRecords || logger->acceptsRecords();
         }
     }
 
@@ -135,6 +323,20 @@ struct MultiplexedLogger : Logger {
         }
     }
 
+    void flush() override {
+        for (Logger *logger : this->loggers) {
+            logger->flush();
+        }
+    }
+
+    bool acceptsRecords() const override { return anyLoggerAcceptsRecords; }
+    void logRecord(LogLevel level, const LogRecord &record) override {
+        for (Logger *logger : this->loggers) {
+            logger->logRecord(level, record);
+        }
+    }
+
 private:
     std::vector<Logger *> loggers = {};
+    bool anyLoggerAcceptsRecords = false;
 };
@@ -0,0 +1,30 @@
+#include "charon/util/mapped_file_writer.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool MappedFileWriter::write(const void *data, size_t size) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    if (window == nullptr || position + size > windowOffset + windowSize) {
+        if (!mapWindow(size)) {
+            return false;
+        }
+    }
+    std::memcpy(window + (position - windowOffset), data, size);
+    position += size;
+    return true;
+}
+
+bool MappedFileWriter::mapWindow(size_t minimumSize) {
+    unmapWindow();
+
+    // Window has to start at an aligned offset, so it may begin before the current position
+    const size_t alignment = getWindowAlignment();
+    windowOffset = position - position % alignment;
+    const size_t requiredSize = static_cast<size_t>(position - windowOffset) + minimumSize;
+    windowSize = std::max(segmentSize, (requiredSize + alignment - 1) / alignment * alignment);
+    return mapWindowImpl();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "charon/charon/os_handle.h"
+#include "charon/util/class_traits.h"
+#include "charon/util/filesystem.h"
+
+#include <cstdint>
+
+// Appends data to a file through a memory-mapped window, which is moved forward as the file grows. The file is
+// extended by whole segments, so most writes are plain memory copies without any syscalls. Disk space for a segment is
+// allocated before it's mapped, so running out of space fails the write instead of crashing the process. Unused part
+// of the last segment is truncated when the writer is destroyed. If the process dies before that, it remains filled
+// with zeros.
+class MappedFileWriter : NonCopyableAndMovable {
+public:
+    constexpr static inline size_t defaultSegmentSize = 4 * 1024 * 1024;
+
+    MappedFileWriter(const fs::path &path, size_t segmentSize = defaultSegmentSize);
+    ~MappedFileWriter();
+
+    bool isOpen() const { return file != defaultOsHandle; }
+    uint64_t getSize() const { return position; }
+
+    // Returns false if the file could not be extended. Nothing is written in such case.
+    bool write(const void *data, size_t size);
+
+private:
+    bool mapWindow(size_t minimumSize);
+    bool mapWindowImpl();
+    void unmapWindow();
+    size_t getWindowAlignment() const;
+
+    const size_t segmentSize;
+    OsHandle file = defaultOsHandle;
+#if defined(WIN32)
+    HANDLE mapping = nullptr;
+#endif
+    uint64_t position = 0u;
+    uint64_t windowOffset = 0u;
+    size_t windowSize = 0u;
+    char *window = nullptr;
+};
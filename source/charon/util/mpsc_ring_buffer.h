@@ -0,0 +1,116 @@
+#pragma once
+
+#include "charon/util/class_traits.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+// What a producer does when the ring is full
+enum class RingOverflowPolicy {
+    Block, // wait (yielding) until the consumer frees a slot
+    Drop,  // give up, reserve() returns false
+};
+
+// Bounded multi-producer single-consumer ring of preallocated slots, used by the lock-free queues. Producers reserve
+// a position with a CAS on the enqueue position, fill the slot in place and publish it by bumping the slot's sequence
+// number. The consumer reads the oldest slot and releases it by advancing the sequence by the capacity. Values stay
+// in their slots after being consumed, so their buffers can be reused. Capacity is rounded up to a power of two.
+//
+// Only one thread may consume at a time. Waking up a sleeping consumer is left to the owner.
+template <typename T>
+class MpscRingBuffer : NonCopyableAndMovable {
+public:
+    MpscRingBuffer(size_t capacity, RingOverflowPolicy overflowPolicy)
+        : capacity(roundUpToPowerOfTwo(capacity)),
+          overflowPolicy(overflowPolicy),
+          slots(std::make_unique<Slot[]>(this->capacity)) {
+        for (size_t i = 0; i < this->capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    size_t getCapacity() const { return capacity; }
+
+    // Value stored in the slot for given position. Producers may access it only between reserve() and publish().
+    T &at(size_t position) { return slots[position & (capacity - 1)].value; }
+
+    bool reserve(size_t &position) {
+        position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            const size_t sequence = slots[position & (capacity - 1)].sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return true;
+                }
+            } else if (difference < 0) {
+                // Ring is full, wait for the consumer
+                if (overflowPolicy == RingOverflowPolicy::Drop) {
+                    return false;
+                }
+                std::this_thread::yield();
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(size_t position) {
+        slots[position & (capacity - 1)].sequence.store(position + 1, std::memory_order_release);
+    }
+
+    // Oldest published value or nullptr if there is none. It has to be released with pop() once consumed.
+    T *front() {
+        const size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        Slot &slot = slots[position & (capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            return nullptr;
+        }
+        return &slot.value;
+    }
+
+    void pop() {
+        const size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        slots[position & (capacity - 1)].sequence.store(position + capacity, std::memory_order_release);
+        dequeuePosition.store(position + 1, std::memory_order_release);
+    }
+
+    // Sequentially consistent, so a consumer announcing that it goes to sleep cannot miss a value published by
+    // a producer which didn't see the announcement
+    bool isEmpty() const {
+        const size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        return slots[position & (capacity - 1)].sequence.load(std::memory_order_seq_cst) != position + 1;
+    }
+
+    size_t size() const {
+        const size_t enqueued = enqueuePosition.load(std::memory_order_acquire);
+        const size_t dequeued = dequeuePosition.load(std::memory_order_acquire);
+        return enqueued - dequeued;
+    }
+
+    size_t getEnqueuePosition() const { return enqueuePosition.load(std::memory_order_acquire); }
+    size_t getDequeuePosition() const { return dequeuePosition.load(std::memory_order_acquire); }
+
+private:
+    struct Slot {
+        std::atomic_size_t sequence = 0u;
+        T value = {};
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 2u;
+        while (result < value) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    const size_t capacity;
+    const RingOverflowPolicy overflowPolicy;
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic_size_t enqueuePosition = 0u;
+    alignas(64) std::atomic_size_t dequeuePosition = 0u;
+};
@@ -0,0 +1,4 @@
+#pragma once
+
+// Lowers CPU scheduling priority of the calling thread, so it runs only when other threads don't need the CPU
+void setCurrentThreadLowPriority();
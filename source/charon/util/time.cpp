@@ -1,9 +1,21 @@
 #include "charon/util/time.h"
 
-#include <iomanip>
+#include <array>
 
 void TimeImpl::writeCurrentTime(std::ostream &out) const {
-    auto time = std::time(nullptr);
-    auto localTime = *std::localtime(&time);
-    out << std::put_time(&localTime, "%d-%m-%Y %H:%M:%S");
+    writeTime(out, getCurrentTime());
+}
+
+void TimeImpl::writeTime(std::ostream &out, std::time_t time) {
+    thread_local std::time_t cachedTime = {};
+    thread_local std::array<char, 64> cachedText = {};
+    thread_local size_t cachedTextLength = 0u;
+
+    if (cachedTextLength == 0u || time != cachedTime) {
+        std::tm localTime{};
+        convertToLocalTime(time, localTime);
+        cachedTextLength = std::strftime(cachedText.data(), cachedText.size(), "%d-%m-%Y %H:%M:%S", &localTime);
+        cachedTime = time;
+    }
+    out.write(cachedText.data(), static_cast<std::streamsize>(cachedTextLength));
 }
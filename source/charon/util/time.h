@@ -1,11 +1,19 @@
 #pragma once
 
+#include <ctime>
 #include <ostream>
 
 struct Time {
     virtual void writeCurrentTime(std::ostream &out) const = 0;
 };
 
+// Formatting local time is expensive and its text changes only once per second, so each thread keeps the last
+// formatted second and reuses it until the clock moves on
 struct TimeImpl : Time {
     void writeCurrentTime(std::ostream &out) const override;
+    static void writeTime(std::ostream &out, std::time_t time);
+
+private:
+    static std::time_t getCurrentTime();
+    static void convertToLocalTime(std::time_t time, std::tm &localTime);
 };
@@ -0,0 +1,14 @@
+#include "charon/util/directory_enumerator.h"
+
+bool enumerateDirectory(const fs::path &directory, const DirectoryEntryCallback &callback) {
+    std::error_code error{};
+    fs::directory_iterator iterator{directory, error};
+    if (error) {
+        return false;
+    }
+
+    for (const fs::directory_entry &entry : iterator) {
+        callback(entry.path(), entry.symlink_status(error).type());
+    }
+    return true;
+}
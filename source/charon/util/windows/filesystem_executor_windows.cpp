@@ -0,0 +1,9 @@
+#include "charon/util/filesystem_executor.h"
+
+#include <algorithm>
+
+std::unique_ptr<FilesystemExecutor> FilesystemExecutor::create(Filesystem &filesystem, size_t maxOperationsInFlight) {
+    constexpr size_t maxThreadsCount = 8u;
+    const size_t threadsCount = std::clamp<size_t>(maxOperationsInFlight, 1u, maxThreadsCount);
+    return std::make_unique<ThreadPoolFilesystemExecutor>(filesystem, threadsCount);
+}
@@ -1,5 +1,57 @@
 #include "charon/util/filesystem_impl.h"
 
+OptionalError FilesystemImpl::copy(const fs::path &src, const fs::path &dst) const {
+    fs::create_directories(dst.parent_path());
+
+    std::error_code error{};
+    auto options = std::filesystem::copy_options::overwrite_existing;
+    fs::copy(src, dst, options, error);
+    if (error.value() != 0) {
+        return error;
+    } else {
+        return {};
+    }
+}
+
+OptionalError FilesystemImpl::moveAcrossDevices(const fs::path &src, const fs::path &dst) const {
+    fs::create_directories(dst.parent_path());
+
+    // MoveFileEx copies the file and removes the source only after the copy succeeded
+    const DWORD flags = MOVEFILE_COPY_ALLOWED | MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH;
+    if (!MoveFileExW(src.c_str(), dst.c_str(), flags)) {
+        return std::error_code{static_cast<int>(GetLastError()), std::system_category()};
+    }
+    return {};
+}
+
+OptionalError FilesystemImpl::copyAtomically(const fs::path &src, const fs::path &dst) const {
+    fs::create_directories(dst.parent_path());
+
+    // Copy to a temporary file first and give it the final name once complete. MoveFileEx without
+    // MOVEFILE_REPLACE_EXISTING fails if the destination exists.
+    const fs::path temporaryPath = dst.parent_path() / (L"." + dst.filename().wstring() + L".charon-" + std::to_wstring(GetCurrentThreadId()));
+    std::error_code error{};
+    fs::copy(src, temporaryPath, fs::copy_options::overwrite_existing, error);
+    if (error.value() != 0) {
+        return error;
+    }
+    if (!MoveFileExW(temporaryPath.c_str(), dst.c_str(), MOVEFILE_WRITE_THROUGH)) {
+        error = std::error_code{static_cast<int>(GetLastError()), std::system_category()};
+        DeleteFileW(temporaryPath.c_str());
+        return error;
+    }
+    return {};
+}
+
+OptionalError FilesystemImpl::moveAtomically(const fs::path &src, const fs::path &dst) const {
+    fs::create_directories(dst.parent_path());
+
+    if (!MoveFileExW(src.c_str(), dst.c_str(), MOVEFILE_COPY_ALLOWED | MOVEFILE_WRITE_THROUGH)) {
+        return std::error_code{static_cast<int>(GetLastError()), std::system_category()};
+    }
+    return {};
+}
+
 bool FilesystemImpl::isFileLockingSupported() const {
     return true;
 }
@@ -0,0 +1,65 @@
+#include "charon/util/mapped_file_writer.h"
+
+MappedFileWriter::MappedFileWriter(const fs::path &path, size_t segmentSize)
+    : segmentSize(segmentSize) {
+    file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        file = defaultOsHandle;
+        return;
+    }
+    position = static_cast<uint64_t>(size.QuadPart);
+}
+
+MappedFileWriter::~MappedFileWriter() {
+    if (!isOpen()) {
+        return;
+    }
+    unmapWindow();
+
+    LARGE_INTEGER size{};
+    size.QuadPart = static_cast<LONGLONG>(position);
+    if (SetFilePointerEx(file, size, nullptr, FILE_BEGIN)) {
+        SetEndOfFile(file);
+    }
+    CloseHandle(file);
+}
+
+bool MappedFileWriter::mapWindowImpl() {
+    // Mapping beyond the end of the file extends it. Space is allocated at this point, so a full disk fails here.
+    const uint64_t fileSize = windowOffset + windowSize;
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(fileSize >> 32), static_cast<DWORD>(fileSize), nullptr);
+    if (mapping == nullptr) {
+        return false;
+    }
+    void *memory = MapViewOfFile(mapping, FILE_MAP_WRITE, static_cast<DWORD>(windowOffset >> 32), static_cast<DWORD>(windowOffset), windowSize);
+    if (memory == nullptr) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return false;
+    }
+    window = static_cast<char *>(memory);
+    return true;
+}
+
+void MappedFileWriter::unmapWindow() {
+    if (window != nullptr) {
+        UnmapViewOfFile(window);
+        window = nullptr;
+    }
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+    }
+}
+
+size_t MappedFileWriter::getWindowAlignment() const {
+    SYSTEM_INFO systemInfo{};
+    GetSystemInfo(&systemInfo);
+    return systemInfo.dwAllocationGranularity;
+}
@@ -0,0 +1,7 @@
+#include "charon/util/thread_priority.h"
+
+#include <Windows.h>
+
+void setCurrentThreadLowPriority() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+}
@@ -0,0 +1,9 @@
+#include "charon/util/time.h"
+
+std::time_t TimeImpl::getCurrentTime() {
+    return std::time(nullptr);
+}
+
+void TimeImpl::convertToLocalTime(std::time_t time, std::tm &localTime) {
+    localtime_s(&localTime, &time);
+}
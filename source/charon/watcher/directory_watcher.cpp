@@ -1,7 +1,10 @@
+#include "charon/util/directory_enumerator.h"
+#include "charon/util/logger.h"
 #include "charon/watcher/directory_watcher.h"
 
-DirectoryWatcher::DirectoryWatcher(const std::filesystem::path &directoryPath, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue)
+DirectoryWatcher::DirectoryWatcher(const std::filesystem::path &directoryPath, bool recursive, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue)
     : directoryPath(directoryPath),
+      recursive(recursive),
       outputQueue(outputQueue),
       deferredOutputQueue(deferredOutputQueue) {}
 
@@ -11,6 +14,7 @@ bool DirectoryWatcher::start() {
     }
 
     fs::create_directories(directoryPath);
+    snapshot = scanFiles(std::filesystem::file_time_type::clock::now() - writeTimeTolerance);
 
     if (!startImpl()) {
         return false;
@@ -30,9 +34,85 @@ bool DirectoryWatcher::stop() {
 }
 
 void DirectoryWatcher::pushEvent(FileEvent &&fileEvent) {
-    if (fileEvent.needsFileLocking()) {
-        deferredOutputQueue.push(std::move(fileEvent));
+    updateSnapshot(fileEvent);
+    // If both queues are the same, a single batch is used to preserve the order of events
+    if (fileEvent.needsFileLocking() && &deferredOutputQueue != &outputQueue) {
+        pendingDeferredEvents.push_back(std::move(fileEvent));
     } else {
-        outputQueue.push(std::move(fileEvent));
+        pendingEvents.push_back(std::move(fileEvent));
+    }
+}
+
+void DirectoryWatcher::flushEvents() {
+    outputQueue.pushBatch(pendingEvents);
+    deferredOutputQueue.pushBatch(pendingDeferredEvents);
+}
+
+void DirectoryWatcher::rescanAfterOverflow() {
+    const size_t currentOverflowsCount = ++overflowsCount;
+    log(LogLevel::Warning) << "Events were lost in " << directoryPath << ", rescanning (overflow count: " << currentOverflowsCount << ")";
+
+    Snapshot currentSnapshot = scanFiles(std::filesystem::file_time_type::clock::now() - writeTimeTolerance);
+    std::vector<std::filesystem::path> missedFiles{};
+    for (auto &[directory, files] : currentSnapshot) {
+        const auto knownDirectory = snapshot.find(directory);
+        for (auto &[name, knownTime] : files) {
+            std::filesystem::path path = std::filesystem::path{directory} / name;
+            if (knownDirectory == snapshot.end()) {
+                missedFiles.push_back(std::move(path));
+                continue;
+            }
+            const auto knownFile = knownDirectory->second.find(name);
+            if (knownFile == knownDirectory->second.end()) {
+                missedFiles.push_back(std::move(path));
+                continue;
+            }
+
+            // File was known before, it's missed only if it was written since
+            std::error_code error{};
+            const auto writeTime = std::filesystem::last_write_time(path, error);
+            if (!error && writeTime > knownFile->second) {
+                missedFiles.push_back(std::move(path));
+            } else {
+                knownTime = knownFile->second;
+            }
+        }
+    }
+
+    snapshot = std::move(currentSnapshot);
+    for (std::filesystem::path &path : missedFiles) {
+        pushEvent(FileEvent{directoryPath, FileEvent::Type::Add, std::move(path)});
+    }
+}
+
+DirectoryWatcher::Snapshot DirectoryWatcher::scanFiles(std::filesystem::file_time_type knownTime) const {
+    Snapshot result{};
+    enumerateFiles(directoryPath, recursive, [&](const std::filesystem::path &path) {
+        result[path.parent_path().native()].emplace(path.filename().native(), knownTime);
+    });
+    return result;
+}
+
+void DirectoryWatcher::updateSnapshot(const FileEvent &fileEvent) {
+    switch (fileEvent.type) {
+    case FileEvent::Type::Add:
+    case FileEvent::Type::RenameNew:
+    case FileEvent::Type::Modify:
+        // Events come after the writes they report, so the current time is not older than their timestamps
+        snapshot[fileEvent.path.parent_path().native()][fileEvent.path.filename().native()] = std::filesystem::file_time_type::clock::now();
+        break;
+    case FileEvent::Type::Remove:
+    case FileEvent::Type::RenameOld: {
+        auto directory = snapshot.find(fileEvent.path.parent_path().native());
+        if (directory != snapshot.end()) {
+            directory->second.erase(fileEvent.path.filename().native());
+            if (directory->second.empty()) {
+                snapshot.erase(directory);
+            }
+        }
+        break;
+    }
+    default:
+        break;
     }
 }
@@ -1,13 +1,17 @@
 #pragma once
 
 #include "charon/util/class_traits.h"
-#include "charon/watcher/file_event.h"
+#include "charon/watcher/file_event_queue.h"
 
+#include <atomic>
+#include <chrono>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 class DirectoryWatcher : NonCopyableAndMovable {
 public:
-    DirectoryWatcher(const std::filesystem::path &directoryPath, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue);
+    DirectoryWatcher(const std::filesystem::path &directoryPath, bool recursive, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue);
     virtual ~DirectoryWatcher() {}
 
     bool start();
@@ -15,15 +19,40 @@ public:
     virtual bool isWorking() const = 0;
 
     const auto &getWatchedDirectory() const { return directoryPath; }
+    bool isRecursive() const { return recursive; }
+    size_t getOverflowsCount() const { return overflowsCount.load(); }
 
 protected:
     virtual bool startImpl() = 0;
     virtual bool stopImpl() = 0;
+    // Events are collected and published to the queues in batches, so consumers are woken up once per batch.
+    // Implementations call flushEvents() after processing everything they got from the OS at once.
     void pushEvent(FileEvent &&fileEvent);
+    void flushEvents();
+
+    // Called when the OS dropped some of the events. Compares the watched tree with the snapshot of files known to
+    // the watcher and reports files which appeared, including the ones moved in with old write times, and files
+    // written after the watcher last learned about them.
+    void rescanAfterOverflow();
 
     const std::filesystem::path directoryPath;
+    const bool recursive;
 
 private:
+    // Snapshot of the tree kept up to date by events, so it costs no syscalls. Files are grouped by directory and
+    // mapped by name to the time the watcher last learned about them. Writes made later than that were missed.
+    using KnownFiles = std::unordered_map<PathStringType, std::filesystem::file_time_type>;
+    using Snapshot = std::unordered_map<PathStringType, KnownFiles>;
+    // Filesystems update timestamps with a coarse clock, so files written right before a scan could get an older
+    // timestamp than the time of the scan
+    constexpr static inline auto writeTimeTolerance = std::chrono::seconds(1);
+    Snapshot scanFiles(std::filesystem::file_time_type knownTime) const;
+    void updateSnapshot(const FileEvent &fileEvent);
+
     FileEventQueue &outputQueue;
     FileEventQueue &deferredOutputQueue;
+    std::vector<FileEvent> pendingEvents = {};
+    std::vector<FileEvent> pendingDeferredEvents = {};
+    Snapshot snapshot = {};
+    std::atomic_size_t overflowsCount = 0u;
 };
@@ -6,12 +6,33 @@
 
 struct DirectoryWatcherFactory {
     virtual std::unique_ptr<DirectoryWatcher> create(const std::filesystem::path &directoryPath,
+                                                     bool recursive,
                                                      FileEventQueue &outputQueue,
                                                      FileEventQueue &deferredOutputQueue) = 0;
 };
 
 struct DirectoryWatcherFactoryImpl : DirectoryWatcherFactory {
+    // Mechanism used for detecting changes. Mount-wide watching is available only on Linux with sufficient privileges,
+    // in other cases directories are always watched individually. Auto selects mount-wide watching only for recursive
+    // directories, since for a single directory it delivers events of the whole filesystem for nothing.
+    enum class Backend {
+        Auto,
+        PerDirectory,
+        MountWide,
+    };
+
+    constexpr static inline size_t defaultReadBufferSize = 64 * 1024;
+
+    explicit DirectoryWatcherFactoryImpl(Backend backend = Backend::PerDirectory, size_t readBufferSize = defaultReadBufferSize)
+        : backend(backend), readBufferSize(readBufferSize) {}
+    static bool isMountWideWatchingSupported();
+
     std::unique_ptr<DirectoryWatcher> create(const std::filesystem::path &directoryPath,
+                                             bool recursive,
                                              FileEventQueue &outputQueue,
                                              FileEventQueue &deferredOutputQueue) override;
+
+private:
+    const Backend backend;
+    const size_t readBufferSize;
 };
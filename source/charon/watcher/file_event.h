@@ -1,7 +1,6 @@
 #pragma once
 
 #include "charon/charon/os_handle.h"
-#include "charon/util/blocking_queue.h"
 #include "charon/util/filesystem.h"
 
 struct FileEvent {
@@ -17,6 +16,7 @@ struct FileEvent {
     Type type = Type::Add;
     std::filesystem::path path = {};
     OsHandle lockedFileHandle = defaultOsHandle;
+    bool isFromStartupScan = false;
 
     bool isInterrupt() const { return type == Type::Interrupt; }
     bool needsFileLocking() const { return type == Type::Add || type == Type::Modify || type == Type::RenameNew; }
@@ -33,4 +33,3 @@ inline bool operator==(const FileEvent &left, const FileEvent &right) {
            left.path == right.path;
 }
 
-using FileEventQueue = BlockingQueue<FileEvent>;
@@ -0,0 +1,290 @@
+#include "charon/util/logger.h"
+#include "charon/watcher/file_event_queue.h"
+
+#include <algorithm>
+
+FileEventQueue::FileEventQueue() = default;
+
+FileEventQueue::~FileEventQueue() {
+    if (journal.is_open()) {
+        // Journal is never read by another process, so events which were not loaded back are lost
+        if (spilledSize.load() > 0) {
+            log(LogLevel::Warning) << "Discarding " << spilledSize.load() << " spilled events from " << journalPath << " which were not processed";
+        }
+        journal.close();
+        std::error_code error{};
+        fs::remove(journalPath, error);
+    }
+}
+
+void FileEventQueue::setCapacity(size_t capacity, OverflowPolicy overflowPolicy, const fs::path &journalPath) {
+    this->capacity = capacity;
+    this->overflowPolicy = overflowPolicy;
+
+#if CHARON_LOCK_FREE_EVENT_QUEUE
+    // Ring buffer has to be able to hold all events we allow in memory
+    if (capacity > 0) {
+        queue = std::make_unique<Queue>(capacity);
+    }
+#endif
+
+    if (capacity > 0 && overflowPolicy == OverflowPolicy::Spill) {
+        this->journalPath = journalPath;
+        journal.open(journalPath, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        if (!journal.is_open()) {
+            log(LogLevel::Error) << "Failed to create event journal " << journalPath << ". Producers will be blocked when the queue is full.";
+            this->overflowPolicy = OverflowPolicy::Block;
+        }
+    }
+}
+
+bool FileEventQueue::push(const FileEvent &event) {
+    FileEvent copy = event;
+    return push(std::move(copy));
+}
+
+bool FileEventQueue::push(FileEvent &&event) {
+    if (capacity == 0) {
+        memorySize++;
+        queue->push(std::move(event));
+        updateHighWaterMark();
+        return true;
+    }
+
+    switch (overflowPolicy) {
+    case OverflowPolicy::Block:
+        waitForMemorySlot();
+        break;
+    case OverflowPolicy::Spill:
+        if (spilling.load() || !reserveMemorySlot()) {
+            spill(std::move(event));
+            return true;
+        }
+        break;
+    case OverflowPolicy::Coalesce:
+        if (!event.isInterrupt()) {
+            const PathStringType key = getCoalescingKey(event);
+            std::unique_lock lock{queuedEventsMutex};
+            if (!reserveMemorySlot()) {
+                if (queuedEvents.find(key) != queuedEvents.end()) {
+                    coalescedEventsCount++;
+                    return false;
+                }
+                lock.unlock();
+                waitForMemorySlot();
+                lock.lock();
+            }
+            queuedEvents[key]++;
+        } else {
+            waitForMemorySlot();
+        }
+        break;
+    }
+
+    queue->push(std::move(event));
+    updateHighWaterMark();
+    return true;
+}
+
+size_t FileEventQueue::pushBatch(std::vector<FileEvent> &events) {
+    if (capacity == 0) {
+        const size_t queuedCount = events.size();
+        memorySize += queuedCount;
+        queue->pushBatch(events);
+        updateHighWaterMark();
+        return queuedCount;
+    }
+
+    // Bounded queue has to check the capacity for each event
+    size_t queuedCount = 0u;
+    for (FileEvent &event : events) {
+        queuedCount += push(std::move(event));
+    }
+    events.clear();
+    return queuedCount;
+}
+
+bool FileEventQueue::blockingPop(FileEvent &result) {
+    const auto infiniteTimeout = std::chrono::hours(1000000);
+    return blockingPop(result, infiniteTimeout);
+}
+
+bool FileEventQueue::blockingPop(FileEvent &result, std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        if (spilledEventsAvailable.load()) {
+            loadSpilledEvents();
+        }
+
+        const auto remainingTime = std::max(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()), std::chrono::milliseconds(0));
+        if (queue->blockingPop(result, remainingTime)) {
+            onPopped(result);
+            return true;
+        }
+
+        // Underlying queue is also interrupted when events are spilled to wake us up, so we may have to try again
+        if (interrupted.exchange(false)) {
+            return false;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+    }
+}
+
+bool FileEventQueue::nonBlockingPop(FileEvent &result) {
+    if (spilledEventsAvailable.load()) {
+        loadSpilledEvents();
+    }
+
+    if (queue->nonBlockingPop(result)) {
+        onPopped(result);
+        return true;
+    }
+    return false;
+}
+
+void FileEventQueue::interruptBlockingPop() {
+    interrupted.store(true);
+    queue->interruptBlockingPop();
+}
+
+void FileEventQueue::clear() {
+    FileEvent event{};
+    while (nonBlockingPop(event)) {
+    }
+}
+
+bool FileEventQueue::reserveMemorySlot() {
+    size_t currentSize = memorySize.load();
+    while (currentSize < capacity) {
+        if (memorySize.compare_exchange_weak(currentSize, currentSize + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileEventQueue::waitForMemorySlot() {
+    if (reserveMemorySlot()) {
+        return;
+    }
+
+    blockedProducersCount++;
+    std::unique_lock lock{fullQueueMutex};
+    fullQueueConditionVariable.wait(lock, [this]() { return reserveMemorySlot(); });
+    blockedProducersCount--;
+}
+
+void FileEventQueue::onPopped(const FileEvent &event) {
+    if (capacity > 0 && overflowPolicy == OverflowPolicy::Coalesce && !event.isInterrupt()) {
+        std::lock_guard lock{queuedEventsMutex};
+        auto it = queuedEvents.find(getCoalescingKey(event));
+        if (it != queuedEvents.end() && --it->second == 0) {
+            queuedEvents.erase(it);
+        }
+    }
+
+    memorySize--;
+    if (blockedProducersCount.load() > 0) {
+        std::lock_guard lock{fullQueueMutex};
+        fullQueueConditionVariable.notify_one();
+    }
+}
+
+void FileEventQueue::updateHighWaterMark() {
+    const size_t currentSize = size();
+    size_t currentHighWaterMark = highWaterMark.load();
+    while (currentSize > currentHighWaterMark && !highWaterMark.compare_exchange_weak(currentHighWaterMark, currentSize)) {
+    }
+}
+
+template <typename T>
+static void writeToJournal(std::fstream &journal, const T &value) {
+    journal.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void writeToJournal(std::fstream &journal, const fs::path &path) {
+    const PathStringType &pathString = path.native();
+    writeToJournal(journal, static_cast<uint32_t>(pathString.size()));
+    journal.write(reinterpret_cast<const char *>(pathString.data()), pathString.size() * sizeof(PathCharType));
+}
+
+template <typename T>
+static void readFromJournal(std::fstream &journal, T &value) {
+    journal.read(reinterpret_cast<char *>(&value), sizeof(value));
+}
+
+static void readFromJournal(std::fstream &journal, fs::path &path) {
+    uint32_t length{};
+    readFromJournal(journal, length);
+    PathStringType pathString(length, PathCharType{});
+    journal.read(reinterpret_cast<char *>(pathString.data()), length * sizeof(PathCharType));
+    path = std::move(pathString);
+}
+
+void FileEventQueue::spill(FileEvent &&event) {
+    {
+        std::lock_guard lock{journalMutex};
+        spilling.store(true);
+
+        // Events are only read back by this process, so file handles are still valid
+        journal.seekp(0, std::ios::end);
+        writeToJournal(journal, static_cast<uint8_t>(event.type));
+        writeToJournal(journal, event.lockedFileHandle);
+        writeToJournal(journal, event.isFromStartupScan);
+        writeToJournal(journal, event.watchedRootPath);
+        writeToJournal(journal, event.path);
+        journal.flush();
+
+        spilledSize++;
+        spilledEventsCount++;
+    }
+    updateHighWaterMark();
+
+    // Consumer may be waiting on an empty in-memory queue, so we have to wake it up
+    if (!spilledEventsAvailable.exchange(true)) {
+        queue->interruptBlockingPop();
+    }
+}
+
+void FileEventQueue::loadSpilledEvents() {
+    // Don't reload one event at a time when the queue is almost full
+    if (memorySize.load() > capacity / 2) {
+        return;
+    }
+
+    std::lock_guard lock{journalMutex};
+    journal.seekg(journalReadOffset);
+    while (spilledSize.load() > 0 && reserveMemorySlot()) {
+        uint8_t type{};
+        FileEvent event{};
+        readFromJournal(journal, type);
+        readFromJournal(journal, event.lockedFileHandle);
+        readFromJournal(journal, event.isFromStartupScan);
+        readFromJournal(journal, event.watchedRootPath);
+        readFromJournal(journal, event.path);
+        event.type = static_cast<FileEvent::Type>(type);
+
+        spilledSize--;
+        queue->push(std::move(event));
+    }
+    journalReadOffset = journal.tellg();
+
+    if (spilledSize.load() == 0) {
+        // Journal is drained, new events can go directly to memory again
+        journal.close();
+        journal.open(journalPath, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        journalReadOffset = 0;
+        spilledEventsAvailable.store(false);
+        spilling.store(false);
+    }
+}
+
+PathStringType FileEventQueue::getCoalescingKey(const FileEvent &event) {
+    PathStringType key = event.watchedRootPath.native();
+    key.push_back(PathCharType{});
+    key += event.path.native();
+    key.push_back(static_cast<PathCharType>('0' + static_cast<int>(event.type)));
+    return key;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "charon/util/blocking_queue.h"
+#include "charon/util/lock_free_queue.h"
+#include "charon/watcher/file_event.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Queue of file events passed between watchers, DeferredFileLocker and Processor. By default it is unbounded.
+// A capacity can be set to keep memory usage predictable when events are produced faster than they are processed.
+// Overflow policy decides what happens to events pushed while the queue is full:
+//  - Block - producer waits until the consumer pops some events.
+//  - Spill - events are appended to a journal file and loaded back when the in-memory queue is drained.
+//  - Coalesce - events identical to an already queued one are dropped, other events block the producer.
+//
+// With CHARON_LOCK_FREE_EVENT_QUEUE the queue is backed by a fixed-size ring, so it is never truly unbounded. Without
+// a capacity it holds up to LockFreeQueue::defaultCapacity events and producers spin (yielding) when it's full.
+//
+// Only one thread may pop from the queue at a time.
+class FileEventQueue : NonCopyableAndMovable {
+public:
+#if CHARON_LOCK_FREE_EVENT_QUEUE
+    using Queue = LockFreeQueue<FileEvent>;
+#else
+    using Queue = BlockingQueue<FileEvent>;
+#endif
+
+    enum class OverflowPolicy {
+        Block,
+        Spill,
+        Coalesce,
+    };
+
+    FileEventQueue();
+    ~FileEventQueue();
+
+    // Has to be called before the queue is used. Capacity equal to 0 means unbounded queue.
+    void setCapacity(size_t capacity, OverflowPolicy overflowPolicy, const fs::path &journalPath = {});
+
+    // Return false or count only events which were queued, as opposed to coalesced with an already queued one
+    bool push(const FileEvent &event);
+    bool push(FileEvent &&event);
+    size_t pushBatch(std::vector<FileEvent> &events);
+
+    bool blockingPop(FileEvent &result);
+    bool blockingPop(FileEvent &result, std::chrono::milliseconds timeout);
+    bool nonBlockingPop(FileEvent &result);
+    void interruptBlockingPop();
+
+    bool empty() const { return size() == 0; }
+    size_t size() const { return memorySize.load() + spilledSize.load(); }
+    void clear();
+
+    // Statistics
+    size_t getHighWaterMark() const { return highWaterMark.load(); }
+    size_t getSpilledEventsCount() const { return spilledEventsCount.load(); }
+    size_t getCoalescedEventsCount() const { return coalescedEventsCount.load(); }
+
+private:
+    bool reserveMemorySlot();
+    void waitForMemorySlot();
+    void onPopped(const FileEvent &event);
+    void updateHighWaterMark();
+
+    void spill(FileEvent &&event);
+    void loadSpilledEvents();
+
+    static PathStringType getCoalescingKey(const FileEvent &event);
+
+    // Underlying queue and its bookkeeping
+    std::unique_ptr<Queue> queue = std::make_unique<Queue>();
+    size_t capacity = 0u;
+    OverflowPolicy overflowPolicy = OverflowPolicy::Block;
+    std::atomic_size_t memorySize = 0u;
+
+    // Producers blocked on a full queue
+    std::mutex fullQueueMutex = {};
+    std::condition_variable fullQueueConditionVariable = {};
+    std::atomic_size_t blockedProducersCount = 0u;
+
+    // Spilling. Once anything is spilled, all new events go to the journal until it's drained to preserve the order.
+    std::mutex journalMutex = {};
+    fs::path journalPath = {};
+    std::fstream journal = {};
+    std::streamoff journalReadOffset = 0;
+    std::atomic_bool spilling = false;
+    std::atomic_bool spilledEventsAvailable = false;
+    std::atomic_bool interrupted = false;
+    std::atomic_size_t spilledSize = 0u;
+
+    // Coalescing
+    std::mutex queuedEventsMutex = {};
+    std::unordered_map<PathStringType, size_t> queuedEvents = {};
+
+    // Statistics
+    std::atomic_size_t highWaterMark = 0u;
+    std::atomic_size_t spilledEventsCount = 0u;
+    std::atomic_size_t coalescedEventsCount = 0u;
+};
@@ -0,0 +1,93 @@
+#include "charon/util/directory_enumerator.h"
+#include "charon/util/logger.h"
+#include "charon/watcher/linux/directory_watcher_fanotify.h"
+#include "charon/watcher/linux/fanotify_reactor.h"
+
+#include <sys/fanotify.h>
+#include <utility>
+
+DirectoryWatcherFanotify::DirectoryWatcherFanotify(const std::filesystem::path &directoryPath,
+                                                   bool recursive,
+                                                   FileEventQueue &outputQueue,
+                                                   FileEventQueue &deferredOutputQueue,
+                                                   std::shared_ptr<FanotifyReactor> reactor)
+    : DirectoryWatcher(directoryPath, recursive, outputQueue, deferredOutputQueue),
+      reactor(std::move(reactor)) {}
+
+DirectoryWatcherFanotify::~DirectoryWatcherFanotify() {
+    stop();
+}
+
+bool DirectoryWatcherFanotify::isWorking() const {
+    return rootRegistered.load();
+}
+
+bool DirectoryWatcherFanotify::startImpl() {
+    // Reactor compares roots with paths resolved by the kernel, so symlinks and relative paths have to be resolved
+    std::error_code error{};
+    const std::filesystem::path canonicalPath = std::filesystem::canonical(directoryPath, error);
+    if (error) {
+        log(LogLevel::Error) << "Failed to resolve path of " << directoryPath;
+        return false;
+    }
+
+    auto lock = reactor->lock();
+    if (!reactor->addRoot(*this, canonicalPath)) {
+        log(LogLevel::Error) << "Failed to mark filesystem of " << directoryPath << " for watching";
+        return false;
+    }
+    rootRegistered.store(true);
+    return true;
+}
+
+bool DirectoryWatcherFanotify::stopImpl() {
+    // Publish events which happened before the stop, but weren't read by the reactor thread yet
+    reactor->readEvents();
+
+    // After this call the reactor thread will not call us anymore
+    auto lock = reactor->lock();
+    reactor->removeRoots(*this);
+    rootRegistered.store(false);
+    return true;
+}
+
+void DirectoryWatcherFanotify::handleFanotifyEvent(uint64_t eventIndex, uint64_t mask, const std::string &relativeDirectoryPath, const std::string &name) {
+    if (!recursive && !relativeDirectoryPath.empty()) {
+        return;
+    }
+    const std::filesystem::path eventDirectoryPath = relativeDirectoryPath.empty() ? directoryPath : directoryPath / relativeDirectoryPath;
+
+    // Whole filesystem is marked, so new subdirectories don't have to be registered. Only directories moved into
+    // our tree need attention, because their files were created before and will not be reported by the kernel.
+    // Fanotify doesn't pair both sides of a rename, but the kernel queues them one after another. Directory moved
+    // out of our tree by the directly preceding event was only renamed, so its files are already known.
+    if (mask & FAN_ONDIR) {
+        if (recursive && (mask & FAN_MOVED_FROM)) {
+            movedOutDirectoryEventIndex = eventIndex;
+        }
+        if (recursive && (mask & FAN_MOVED_TO) && movedOutDirectoryEventIndex + 1 != eventIndex) {
+            pushEventsForExistingFiles(eventDirectoryPath / name);
+        }
+        return;
+    }
+
+    // Kernel merges consecutive events for the same file, so one event can carry multiple types. Their original order
+    // is lost, so we report them in the order of a typical lifecycle of a file: it appears and then it disappears.
+    constexpr std::pair<uint64_t, FileEvent::Type> eventTypes[] = {
+        {FAN_CLOSE_WRITE, FileEvent::Type::Add},
+        {FAN_MOVED_TO, FileEvent::Type::RenameNew},
+        {FAN_MOVED_FROM, FileEvent::Type::RenameOld},
+        {FAN_DELETE, FileEvent::Type::Remove},
+    };
+    for (const auto &[eventMask, type] : eventTypes) {
+        if (mask & eventMask) {
+            pushEvent(FileEvent{directoryPath, type, eventDirectoryPath / name});
+        }
+    }
+}
+
+void DirectoryWatcherFanotify::pushEventsForExistingFiles(const std::filesystem::path &newDirectoryPath) {
+    enumerateFiles(newDirectoryPath, true, [this](const std::filesystem::path &path) {
+        pushEvent(FileEvent{directoryPath, FileEvent::Type::Add, path});
+    });
+}
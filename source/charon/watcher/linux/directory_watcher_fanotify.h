@@ -0,0 +1,34 @@
+#pragma once
+
+#include "charon/watcher/directory_watcher.h"
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+
+class FanotifyReactor;
+
+class DirectoryWatcherFanotify : public DirectoryWatcher {
+public:
+    DirectoryWatcherFanotify(const std::filesystem::path &directoryPath, bool recursive, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue,
+                             std::shared_ptr<FanotifyReactor> reactor);
+    ~DirectoryWatcherFanotify() override;
+
+    bool startImpl() override;
+    bool stopImpl() override;
+    bool isWorking() const override;
+
+    // Called by the reactor thread for events in the watched directory or any of its subdirectories. Event index is
+    // incremented by the reactor for every event it reads.
+    void handleFanotifyEvent(uint64_t eventIndex, uint64_t mask, const std::string &relativeDirectoryPath, const std::string &name);
+    void handleQueueOverflow() { rescanAfterOverflow(); }
+    using DirectoryWatcher::flushEvents;
+
+private:
+    void pushEventsForExistingFiles(const std::filesystem::path &newDirectoryPath);
+
+    std::shared_ptr<FanotifyReactor> reactor;
+    std::atomic_bool rootRegistered = false;
+    uint64_t movedOutDirectoryEventIndex = std::numeric_limits<uint64_t>::max();
+};
@@ -1,101 +1,171 @@
+#include "charon/util/directory_enumerator.h"
 #include "charon/util/linux/error.h"
+#include "charon/util/logger.h"
 #include "charon/watcher/directory_watcher_factory.h"
+#include "charon/watcher/linux/directory_watcher_fanotify.h"
 #include "charon/watcher/linux/directory_watcher_linux.h"
+#include "charon/watcher/linux/fanotify_reactor.h"
+#include "charon/watcher/linux/inotify_reactor.h"
 
+#include <algorithm>
 #include <sys/inotify.h>
-#include <sys/select.h>
-#include <unistd.h>
+#include <vector>
 
 std::unique_ptr<DirectoryWatcher> DirectoryWatcherFactoryImpl::create(const std::filesystem::path &directoryPath,
+                                                                      bool recursive,
                                                                       FileEventQueue &outputQueue,
                                                                       FileEventQueue &deferredOutputQueue) {
-    return std::unique_ptr<DirectoryWatcher>(new DirectoryWatcherLinux(directoryPath, outputQueue, deferredOutputQueue));
+    const bool useMountWide = backend == Backend::MountWide || (backend == Backend::Auto && recursive);
+    if (useMountWide) {
+        std::shared_ptr<FanotifyReactor> fanotifyReactor = FanotifyReactor::getShared(readBufferSize);
+        if (fanotifyReactor != nullptr && FanotifyReactor::isPathSupported(directoryPath)) {
+            return std::unique_ptr<DirectoryWatcher>(new DirectoryWatcherFanotify(directoryPath, recursive, outputQueue, deferredOutputQueue, std::move(fanotifyReactor)));
+        }
+        if (backend == Backend::MountWide) {
+            log(LogLevel::Warning) << "Mount-wide watching is not available for " << directoryPath << ". Falling back to per-directory watching.";
+        }
+    }
+
+    return std::unique_ptr<DirectoryWatcher>(new DirectoryWatcherLinux(directoryPath, recursive, outputQueue, deferredOutputQueue, InotifyReactor::getShared(readBufferSize)));
+}
+
+bool DirectoryWatcherFactoryImpl::isMountWideWatchingSupported() {
+    return FanotifyReactor::isSupported();
 }
 
 DirectoryWatcherLinux::DirectoryWatcherLinux(const std::filesystem::path &directoryPath,
+                                             bool recursive,
                                              FileEventQueue &outputQueue,
-                                             FileEventQueue &deferredOutputQueue)
-    : DirectoryWatcher(directoryPath, outputQueue, deferredOutputQueue) {}
+                                             FileEventQueue &deferredOutputQueue,
+                                             std::shared_ptr<InotifyReactor> reactor)
+    : DirectoryWatcher(directoryPath, recursive, outputQueue, deferredOutputQueue),
+      reactor(std::move(reactor)) {}
 
 DirectoryWatcherLinux::~DirectoryWatcherLinux() {
     stop();
 }
 
 bool DirectoryWatcherLinux::isWorking() const {
-    return watcherThreadWorking.load();
+    return watchRegistered.load();
 }
 
 bool DirectoryWatcherLinux::startImpl() {
-    // Initialize inotify
-    inotifyEventQueue = inotify_init();
-    FATAL_ERROR_IF_SYSCALL_FAILED(inotifyEventQueue, "Failed inotify_init");
-    inotifyWatchDescriptor = inotify_add_watch(inotifyEventQueue, directoryPath.c_str(), IN_CLOSE_WRITE | IN_DELETE | IN_MOVE);
-    FATAL_ERROR_IF_SYSCALL_FAILED(inotifyWatchDescriptor, "Failed inotify_add_watch");
-
-    // Initialize pipe used to interrupt watcher thread from the main thread
-    FATAL_ERROR_IF_SYSCALL_FAILED(pipe(this->watcherThreadInterruptPipe), "Failed pipe creation");
-
-    // Start background thread
-    this->watcherThread = std::make_unique<std::thread>(watcherThreadProcedure, std::reference_wrapper{*this});
+    auto lock = reactor->lock();
+    const int watchDescriptor = addDirectoryWatches(directoryPath, false);
+    FATAL_ERROR_IF_SYSCALL_FAILED(watchDescriptor, "Failed inotify_add_watch");
+    watchRegistered.store(true);
     return true;
 }
 
 bool DirectoryWatcherLinux::stopImpl() {
-    // Interrupt background thread and wait for completion
-    FATAL_ERROR_IF_SYSCALL_FAILED(write(watcherThreadInterruptPipe[1], "\0", 1), "Failed interrupting watcher thread");
-    watcherThread->join();
+    // Publish events which happened before the stop, but weren't read by the reactor thread yet
+    reactor->readEvents();
+
+    // After this call the reactor thread will not call us anymore
+    auto lock = reactor->lock();
+    reactor->removeWatches(*this);
+    watchedDirectories.clear();
+    watchRegistered.store(false);
+    return true;
+}
 
-    // Verify the thread marked its end
-    FATAL_ERROR_IF(isWorking(), "Watcher thread is still working after kill");
+void DirectoryWatcherLinux::handleInotifyEvent(const inotify_event &inotifyEvent) {
+    auto directoryIt = watchedDirectories.find(inotifyEvent.wd);
+    if (directoryIt == watchedDirectories.end()) {
+        return;
+    }
+    const std::filesystem::path &eventDirectoryPath = directoryIt->second;
+
+    // In recursive mode we have to follow changes of the directory tree
+    if (recursive && (inotifyEvent.mask & IN_ISDIR) && inotifyEvent.len > 0) {
+        const std::filesystem::path subdirectoryPath = eventDirectoryPath / std::string{inotifyEvent.name};
+        if (inotifyEvent.mask & IN_CREATE) {
+            // Files could have been placed in the new directory before we started watching it, so we have to report them.
+            addDirectoryWatches(subdirectoryPath, true);
+        } else if (inotifyEvent.mask & IN_MOVED_TO) {
+            // Directory renamed within our tree contains only files we already know about. Files of a directory moved
+            // in from outside were created before we could watch them, so they have to be reported.
+            const bool renamedWithinTree = inotifyEvent.cookie == movedOutDirectoryCookie;
+            movedOutDirectoryCookie = 0u;
+            addDirectoryWatches(subdirectoryPath, !renamedWithinTree);
+        } else if (inotifyEvent.mask & IN_MOVED_FROM) {
+            // Directory was moved out of our tree or renamed. In the latter case IN_MOVED_TO with the same cookie
+            // will register it again.
+            movedOutDirectoryCookie = inotifyEvent.cookie;
+            removeDirectoryWatches(subdirectoryPath);
+        }
+        return;
+    }
 
-    // Cleanup inotify queue
-    FATAL_ERROR_IF_SYSCALL_FAILED(inotify_rm_watch(inotifyEventQueue, inotifyWatchDescriptor), "Failed inotify_rm_watch");
-    FATAL_ERROR_IF_SYSCALL_FAILED(close(inotifyEventQueue), "Failed closing inotify queue");
+    FileEvent fileEvent{};
+    if (createFileEvent(inotifyEvent, eventDirectoryPath, fileEvent)) {
+        pushEvent(std::move(fileEvent));
+    }
+}
 
-    // Cleanup thread reference
-    watcherThread = nullptr;
+void DirectoryWatcherLinux::handleWatchRemoved(int watchDescriptor) {
+    watchedDirectories.erase(watchDescriptor);
+}
 
-    return true;
+void DirectoryWatcherLinux::handleQueueOverflow() {
+    // Subdirectories created in the meantime are not watched yet. Adding a watch for an already watched directory
+    // returns its existing descriptor, so we can simply walk the whole tree again.
+    if (recursive) {
+        addDirectoryWatches(directoryPath, false);
+    }
+    rescanAfterOverflow();
 }
 
-void DirectoryWatcherLinux::watcherThreadProcedure(DirectoryWatcherLinux &watcher) {
-    constexpr size_t bufferSize = sizeof(inotify_event) * 256;
-    auto buffer = std::make_unique<std::byte[]>(bufferSize);
-
-    watcher.watcherThreadWorking.store(true);
-    while (true) {
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(watcher.inotifyEventQueue, &fds);
-        FD_SET(watcher.watcherThreadInterruptPipe[0], &fds);
-        const int nfds = std::max(watcher.inotifyEventQueue, watcher.watcherThreadInterruptPipe[0]) + 1;
-        FATAL_ERROR_IF_SYSCALL_FAILED(select(nfds, &fds, nullptr, nullptr, nullptr), "select() failed");
-
-        if (FD_ISSET(watcher.inotifyEventQueue, &fds)) {
-            const ssize_t readResult = read(watcher.inotifyEventQueue, buffer.get(), bufferSize);
-            FATAL_ERROR_IF_SYSCALL_FAILED(readResult, "Read from inotify queue failed");
-
-            // We received valid data from inotify and we have to process them
-            for (ssize_t positionInBuffer = 0; positionInBuffer < readResult;) {
-                const inotify_event &inotifyEvent = reinterpret_cast<inotify_event &>(buffer[positionInBuffer]);
-
-                FileEvent fileEvent{};
-                if (watcher.createFileEvent(inotifyEvent, fileEvent)) {
-                    watcher.pushEvent(std::move(fileEvent));
-                }
+int DirectoryWatcherLinux::addDirectoryWatches(const std::filesystem::path &rootDirectoryPath, bool pushEventsForExistingFiles) {
+    const int rootWatchDescriptor = reactor->addWatch(*this, rootDirectoryPath);
+    if (rootWatchDescriptor < 0) {
+        return rootWatchDescriptor;
+    }
+    watchedDirectories[rootWatchDescriptor] = rootDirectoryPath;
+    if (!recursive) {
+        return rootWatchDescriptor;
+    }
 
-                positionInBuffer += sizeof(inotify_event) + inotifyEvent.len;
+    // Walk the tree. Each directory is watched before it is listed, so files created in the meantime are not lost.
+    std::vector<std::filesystem::path> directoriesToList = {rootDirectoryPath};
+    while (!directoriesToList.empty()) {
+        const std::filesystem::path currentDirectoryPath = std::move(directoriesToList.back());
+        directoriesToList.pop_back();
+
+        enumerateDirectory(currentDirectoryPath, [&](const std::filesystem::path &path, std::filesystem::file_type type) {
+            if (type == std::filesystem::file_type::directory) {
+                const int watchDescriptor = reactor->addWatch(*this, path);
+                if (watchDescriptor < 0) {
+                    log(LogLevel::Warning) << "Failed to watch directory " << path;
+                    return;
+                }
+                watchedDirectories[watchDescriptor] = path;
+                directoriesToList.push_back(path);
+            } else if (pushEventsForExistingFiles && type == std::filesystem::file_type::regular) {
+                pushEvent(FileEvent{directoryPath, FileEvent::Type::Add, path});
             }
-        }
+        });
+    }
 
-        if (FD_ISSET(watcher.watcherThreadInterruptPipe[0], &fds)) {
-            watcher.watcherThreadWorking.store(false);
-            break;
+    return rootWatchDescriptor;
+}
+
+void DirectoryWatcherLinux::removeDirectoryWatches(const std::filesystem::path &rootDirectoryPath) {
+    const auto isInRemovedTree = [&rootDirectoryPath](const std::filesystem::path &path) {
+        return std::mismatch(rootDirectoryPath.begin(), rootDirectoryPath.end(), path.begin(), path.end()).first == rootDirectoryPath.end();
+    };
+
+    for (auto it = watchedDirectories.begin(); it != watchedDirectories.end();) {
+        if (isInRemovedTree(it->second)) {
+            reactor->removeWatch(*this, it->first);
+            it = watchedDirectories.erase(it);
+        } else {
+            it++;
         }
     }
 }
 
-bool DirectoryWatcherLinux::createFileEvent(const inotify_event &inotifyEvent, FileEvent &outEvent) const {
+bool DirectoryWatcherLinux::createFileEvent(const inotify_event &inotifyEvent, const std::filesystem::path &eventDirectoryPath, FileEvent &outEvent) const {
     if (inotifyEvent.mask & IN_ISDIR) {
         return false;
     }
@@ -119,6 +189,6 @@ bool DirectoryWatcherLinux::createFileEvent(const inotify_event &inotifyEvent, F
     }
 
     const std::string path{inotifyEvent.name};
-    outEvent = FileEvent{this->directoryPath, type, this->directoryPath / path};
+    outEvent = FileEvent{this->directoryPath, type, eventDirectoryPath / path};
     return true;
-}
\ No newline at end of file
+}
@@ -3,25 +3,35 @@
 #include "charon/watcher/directory_watcher.h"
 
 #include <atomic>
+#include <memory>
+#include <unordered_map>
 
+class InotifyReactor;
 struct inotify_event;
 
 class DirectoryWatcherLinux : public DirectoryWatcher {
 public:
-    DirectoryWatcherLinux(const std::filesystem::path &directoryPath, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue);
+    DirectoryWatcherLinux(const std::filesystem::path &directoryPath, bool recursive, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue,
+                          std::shared_ptr<InotifyReactor> reactor);
     ~DirectoryWatcherLinux() override;
 
     bool startImpl() override;
     bool stopImpl() override;
     bool isWorking() const override;
 
+    // Called by the reactor thread for watches registered by this watcher
+    void handleInotifyEvent(const inotify_event &inotifyEvent);
+    void handleWatchRemoved(int watchDescriptor);
+    void handleQueueOverflow();
+    using DirectoryWatcher::flushEvents;
+
 private:
-    static void watcherThreadProcedure(DirectoryWatcherLinux &watcher);
-    bool createFileEvent(const inotify_event &inotifyEvent, FileEvent &outEvent) const;
-
-    OsHandle inotifyEventQueue = defaultOsHandle;
-    OsHandle inotifyWatchDescriptor = defaultOsHandle;
-    int watcherThreadInterruptPipe[2] = {defaultOsHandle, defaultOsHandle};
-    std::unique_ptr<std::thread> watcherThread = nullptr;
-    std::atomic_bool watcherThreadWorking = false;
+    int addDirectoryWatches(const std::filesystem::path &rootDirectoryPath, bool pushEventsForExistingFiles);
+    void removeDirectoryWatches(const std::filesystem::path &rootDirectoryPath);
+    bool createFileEvent(const inotify_event &inotifyEvent, const std::filesystem::path &eventDirectoryPath, FileEvent &outEvent) const;
+
+    std::shared_ptr<InotifyReactor> reactor;
+    std::unordered_map<int, std::filesystem::path> watchedDirectories = {};
+    uint32_t movedOutDirectoryCookie = 0u;
+    std::atomic_bool watchRegistered = false;
 };
@@ -0,0 +1,318 @@
+#include "charon/util/linux/error.h"
+#include "charon/watcher/linux/directory_watcher_fanotify.h"
+#include "charon/watcher/linux/fanotify_reactor.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/capability.h>
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <unordered_set>
+
+// Directory entry events are reported only for filesystem and inode marks, which is why we cannot use mount marks.
+constexpr static inline uint32_t markMask = FAN_CLOSE_WRITE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_DELETE | FAN_ONDIR;
+constexpr static inline size_t minBufferSize = 4096;
+constexpr static inline size_t maxDirectoryPathCacheSize = 4096;
+
+static uint64_t packFilesystemId(const void *filesystemId) {
+    static_assert(sizeof(fsid_t) == sizeof(uint64_t));
+    uint64_t result{};
+    std::memcpy(&result, filesystemId, sizeof(result));
+    return result;
+}
+
+static OsHandle createFanotifyEventQueue() {
+    return fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_NONBLOCK | FAN_CLOEXEC, O_RDONLY | O_CLOEXEC | O_LARGEFILE);
+}
+
+std::shared_ptr<FanotifyReactor> FanotifyReactor::getShared(size_t bufferSize) {
+    static std::mutex mutex{};
+    static std::weak_ptr<FanotifyReactor> sharedReactor{};
+
+    std::lock_guard lock{mutex};
+    std::shared_ptr<FanotifyReactor> reactor = sharedReactor.lock();
+    if (reactor == nullptr && isSupported()) {
+        const OsHandle fanotifyEventQueue = createFanotifyEventQueue();
+        if (fanotifyEventQueue < 0) {
+            return nullptr;
+        }
+        reactor = std::make_shared<FanotifyReactor>(fanotifyEventQueue, bufferSize);
+        sharedReactor = reactor;
+    }
+    return reactor;
+}
+
+bool FanotifyReactor::isSupported() {
+    // Filesystem marks require CAP_SYS_ADMIN and resolving file handles to paths requires CAP_DAC_READ_SEARCH
+    __user_cap_header_struct capabilitiesHeader{_LINUX_CAPABILITY_VERSION_3, 0};
+    __user_cap_data_struct capabilities[_LINUX_CAPABILITY_U32S_3] = {};
+    if (syscall(SYS_capget, &capabilitiesHeader, capabilities) != 0) {
+        return false;
+    }
+    for (int capability : {CAP_SYS_ADMIN, CAP_DAC_READ_SEARCH}) {
+        if ((capabilities[CAP_TO_INDEX(capability)].effective & CAP_TO_MASK(capability)) == 0) {
+            return false;
+        }
+    }
+
+    // Kernel has to support reporting directory file handles and names
+    const OsHandle fanotifyEventQueue = createFanotifyEventQueue();
+    if (fanotifyEventQueue < 0) {
+        return false;
+    }
+    close(fanotifyEventQueue);
+    return true;
+}
+
+bool FanotifyReactor::isPathSupported(const std::filesystem::path &path) {
+    // Watched directory may not exist yet, so we check the filesystem of its closest existing ancestor
+    std::error_code error{};
+    std::filesystem::path existingPath = std::filesystem::absolute(path, error);
+    while (!std::filesystem::exists(existingPath, error) && existingPath.has_relative_path()) {
+        existingPath = existingPath.parent_path();
+    }
+
+    // Events are reported with file handles, so the filesystem must be able to encode them
+    alignas(file_handle) std::byte handleStorage[sizeof(file_handle) + MAX_HANDLE_SZ] = {};
+    auto handle = reinterpret_cast<file_handle *>(handleStorage);
+    handle->handle_bytes = MAX_HANDLE_SZ;
+    int mountId{};
+    return name_to_handle_at(AT_FDCWD, existingPath.c_str(), handle, &mountId, 0) == 0;
+}
+
+FanotifyReactor::FanotifyReactor(OsHandle fanotifyEventQueue, size_t bufferSize)
+    : bufferSize(std::max(bufferSize, minBufferSize)),
+      fanotifyEventQueue(fanotifyEventQueue) {
+    buffer = std::make_unique<std::byte[]>(this->bufferSize);
+    pollingThread = std::make_unique<PollingThread>(fanotifyEventQueue, [this]() { readEvents(); });
+}
+
+FanotifyReactor::~FanotifyReactor() {
+    pollingThread.reset();
+    for (const auto &[filesystemId, markedFilesystem] : markedFilesystems) {
+        FATAL_ERROR_IF_SYSCALL_FAILED(close(markedFilesystem.mountHandle), "Failed closing mount handle");
+    }
+    FATAL_ERROR_IF_SYSCALL_FAILED(close(fanotifyEventQueue), "Failed closing fanotify queue");
+}
+
+bool FanotifyReactor::addRoot(DirectoryWatcherFanotify &watcher, const std::filesystem::path &canonicalRootPath) {
+    std::lock_guard lock{rootsMutex};
+
+    const OsHandle rootHandle = open(canonicalRootPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (rootHandle < 0) {
+        return false;
+    }
+    struct statfs filesystemInfo {};
+    if (fstatfs(rootHandle, &filesystemInfo) != 0) {
+        close(rootHandle);
+        return false;
+    }
+    const uint64_t filesystemId = packFilesystemId(&filesystemInfo.f_fsid);
+
+    // Mark each filesystem only once. Handle to the first root is kept for resolving file handles of the events.
+    auto filesystemIt = markedFilesystems.find(filesystemId);
+    if (filesystemIt == markedFilesystems.end()) {
+        if (fanotify_mark(fanotifyEventQueue, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, markMask, rootHandle, nullptr) != 0) {
+            close(rootHandle);
+            return false;
+        }
+        filesystemIt = markedFilesystems.emplace(filesystemId, MarkedFilesystem{rootHandle, 0u}).first;
+    } else {
+        close(rootHandle);
+    }
+    filesystemIt->second.rootsCount++;
+
+    roots[canonicalRootPath.string()].push_back(Root{&watcher, filesystemId});
+    return true;
+}
+
+void FanotifyReactor::removeRoots(DirectoryWatcherFanotify &watcher) {
+    std::lock_guard lock{rootsMutex};
+
+    for (auto rootsIt = roots.begin(); rootsIt != roots.end();) {
+        std::vector<Root> &rootsForPath = rootsIt->second;
+        for (auto rootIt = rootsForPath.begin(); rootIt != rootsForPath.end();) {
+            if (rootIt->watcher != &watcher) {
+                rootIt++;
+                continue;
+            }
+
+            auto filesystemIt = markedFilesystems.find(rootIt->filesystemId);
+            if (--filesystemIt->second.rootsCount == 0) {
+                fanotify_mark(fanotifyEventQueue, FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM, markMask, filesystemIt->second.mountHandle, nullptr);
+                close(filesystemIt->second.mountHandle);
+                markedFilesystems.erase(filesystemIt);
+            }
+            rootIt = rootsForPath.erase(rootIt);
+        }
+
+        if (rootsForPath.empty()) {
+            rootsIt = roots.erase(rootsIt);
+        } else {
+            rootsIt++;
+        }
+    }
+
+    clearDirectoryPathCache();
+}
+
+void FanotifyReactor::readEvents() {
+    std::lock_guard bufferLock{bufferMutex};
+
+    // Drain the queue, so events from a burst are published in as few batches as possible
+    while (true) {
+        const ssize_t readResult = read(fanotifyEventQueue, buffer.get(), bufferSize);
+        if (readResult < 0 && errno == EAGAIN) {
+            return;
+        }
+        FATAL_ERROR_IF_SYSCALL_FAILED(readResult, "Read from fanotify queue failed");
+
+        std::lock_guard lock{rootsMutex};
+        auto eventMetadata = reinterpret_cast<const fanotify_event_metadata *>(buffer.get());
+        for (ssize_t remainingLength = readResult; FAN_EVENT_OK(eventMetadata, remainingLength); eventMetadata = FAN_EVENT_NEXT(eventMetadata, remainingLength)) {
+            FATAL_ERROR_IF(eventMetadata->vers != FANOTIFY_METADATA_VERSION, "Unsupported fanotify metadata version");
+            dispatchEvent(*eventMetadata);
+        }
+
+        for (DirectoryWatcherFanotify *watcher : watchersToFlush) {
+            watcher->flushEvents();
+        }
+        watchersToFlush.clear();
+    }
+}
+
+void FanotifyReactor::scheduleFlush(DirectoryWatcherFanotify &watcher) {
+    // Events of different watchers are published in the order in which watchers first received them
+    if (std::find(watchersToFlush.rbegin(), watchersToFlush.rend(), &watcher) == watchersToFlush.rend()) {
+        watchersToFlush.push_back(&watcher);
+    }
+}
+
+void FanotifyReactor::dispatchEvent(const fanotify_event_metadata &eventMetadata) {
+    if (eventMetadata.mask & FAN_Q_OVERFLOW) {
+        // We don't know which events were lost, so every watcher has to check its directories
+        std::unordered_set<DirectoryWatcherFanotify *> watchers{};
+        for (const auto &[rootPath, rootsForPath] : roots) {
+            for (const Root &root : rootsForPath) {
+                watchers.insert(root.watcher);
+            }
+        }
+        for (DirectoryWatcherFanotify *watcher : watchers) {
+            watcher->handleQueueOverflow();
+            scheduleFlush(*watcher);
+        }
+        return;
+    }
+
+    eventsCount++;
+
+    // With FAN_REPORT_DFID_NAME the event is described by the file handle of its directory and the name of the entry
+    auto eventInfo = reinterpret_cast<const fanotify_event_info_fid *>(reinterpret_cast<const std::byte *>(&eventMetadata) + eventMetadata.metadata_len);
+    if (eventMetadata.event_len <= eventMetadata.metadata_len || eventInfo->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME) {
+        return;
+    }
+    auto fileHandle = reinterpret_cast<const file_handle *>(eventInfo->handle);
+    const std::string name{reinterpret_cast<const char *>(fileHandle->f_handle + fileHandle->handle_bytes)};
+    const size_t fileHandleSize = sizeof(file_handle) + fileHandle->handle_bytes;
+
+    const bool isDirectoryGone = (eventMetadata.mask & FAN_ONDIR) && (eventMetadata.mask & (FAN_MOVED_FROM | FAN_DELETE));
+    std::string directoryPath{};
+    if (!resolveDirectoryPath(packFilesystemId(&eventInfo->fsid), reinterpret_cast<const std::byte *>(fileHandle), fileHandleSize, directoryPath)) {
+        if (isDirectoryGone) {
+            // We don't know where the directory was, so any cached path could be stale
+            clearDirectoryPathCache();
+        }
+        return;
+    }
+
+    // Paths of the directory and its descendants are no longer valid
+    if (isDirectoryGone) {
+        invalidateDirectoryPathCache(directoryPath.size() > 1 ? directoryPath + '/' + name : '/' + name);
+    }
+
+    // Look for watched roots among the directory and its ancestors
+    std::string candidatePath = directoryPath;
+    while (true) {
+        auto rootsIt = roots.find(candidatePath);
+        if (rootsIt != roots.end()) {
+            const size_t relativePathOffset = std::min(directoryPath.size(), candidatePath.size() + (candidatePath.size() > 1));
+            const std::string relativeDirectoryPath = directoryPath.substr(relativePathOffset);
+            for (const Root &root : rootsIt->second) {
+                root.watcher->handleFanotifyEvent(eventsCount, eventMetadata.mask, relativeDirectoryPath, name);
+                scheduleFlush(*root.watcher);
+            }
+        }
+
+        if (candidatePath.size() <= 1) {
+            break;
+        }
+        const size_t separatorPosition = candidatePath.rfind('/');
+        candidatePath.resize(std::max<size_t>(separatorPosition, 1));
+    }
+}
+
+bool FanotifyReactor::resolveDirectoryPath(uint64_t filesystemId, const std::byte *fileHandle, size_t fileHandleSize, std::string &outPath) {
+    auto filesystemIt = markedFilesystems.find(filesystemId);
+    if (filesystemIt == markedFilesystems.end()) {
+        // Filesystem has already been unmarked, but there were still some events pending
+        return false;
+    }
+
+    std::string cacheKey(sizeof(filesystemId) + fileHandleSize, '\0');
+    std::memcpy(cacheKey.data(), &filesystemId, sizeof(filesystemId));
+    std::memcpy(cacheKey.data() + sizeof(filesystemId), fileHandle, fileHandleSize);
+    auto cacheIt = directoryPathCache.find(cacheKey);
+    if (cacheIt != directoryPathCache.end()) {
+        outPath = cacheIt->second;
+        return true;
+    }
+
+    // Directory could have already been removed or we may not have access to it
+    std::string handleCopy(reinterpret_cast<const char *>(fileHandle), fileHandleSize);
+    const OsHandle directoryHandle = open_by_handle_at(filesystemIt->second.mountHandle, reinterpret_cast<file_handle *>(handleCopy.data()), O_PATH | O_CLOEXEC);
+    if (directoryHandle < 0) {
+        return false;
+    }
+    char pathBuffer[PATH_MAX];
+    const std::string procPath = "/proc/self/fd/" + std::to_string(directoryHandle);
+    const ssize_t pathLength = readlink(procPath.c_str(), pathBuffer, sizeof(pathBuffer));
+    close(directoryHandle);
+    if (pathLength <= 0 || pathBuffer[0] != '/') {
+        return false;
+    }
+    outPath.assign(pathBuffer, pathLength);
+
+    if (directoryPathCache.size() >= maxDirectoryPathCacheSize) {
+        clearDirectoryPathCache();
+    }
+    if (auto keyIt = directoryPathCacheKeys.find(outPath); keyIt != directoryPathCacheKeys.end()) {
+        directoryPathCache.erase(keyIt->second); // path previously resolved from a different handle
+    }
+    directoryPathCacheKeys[outPath] = cacheKey;
+    directoryPathCache.emplace(std::move(cacheKey), outPath);
+    return true;
+}
+
+void FanotifyReactor::invalidateDirectoryPathCache(const std::string &directoryPath) {
+    if (auto it = directoryPathCacheKeys.find(directoryPath); it != directoryPathCacheKeys.end()) {
+        directoryPathCache.erase(it->second);
+        directoryPathCacheKeys.erase(it);
+    }
+
+    // Descendants are adjacent in the ordered map. Paths like "dir-x" are ordered between "dir" and "dir/", hence a separate lookup.
+    const std::string descendantsPrefix = directoryPath + '/';
+    auto it = directoryPathCacheKeys.lower_bound(descendantsPrefix);
+    while (it != directoryPathCacheKeys.end() && it->first.compare(0, descendantsPrefix.size(), descendantsPrefix) == 0) {
+        directoryPathCache.erase(it->second);
+        it = directoryPathCacheKeys.erase(it);
+    }
+}
+
+void FanotifyReactor::clearDirectoryPathCache() {
+    directoryPathCache.clear();
+    directoryPathCacheKeys.clear();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "charon/charon/os_handle.h"
+#include "charon/util/class_traits.h"
+#include "charon/watcher/linux/polling_thread.h"
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class DirectoryWatcherFanotify;
+struct fanotify_event_metadata;
+
+// Single fanotify instance shared by all DirectoryWatcherFanotify objects in the process. Instead of one watch per
+// directory, whole filesystems containing the watched directories are marked, so the number of kernel objects does not
+// depend on the size of the watched trees. The kernel reports events for the entire filesystem, so they are filtered
+// in user space by looking up the watched root directories among ancestors of the event's directory.
+class FanotifyReactor : NonCopyableAndMovable {
+public:
+    // Returns nullptr if fanotify cannot be used in the current process, e.g. due to missing privileges.
+    // Buffer size is used only if the shared reactor doesn't exist yet.
+    static std::shared_ptr<FanotifyReactor> getShared(size_t bufferSize);
+    static bool isSupported();
+    static bool isPathSupported(const std::filesystem::path &path);
+
+    FanotifyReactor(OsHandle fanotifyEventQueue, size_t bufferSize);
+    ~FanotifyReactor();
+
+    // Watchers have to hold the lock while modifying their roots. The lock is already held while watchers are handling events.
+    auto lock() { return std::unique_lock{rootsMutex}; }
+    bool addRoot(DirectoryWatcherFanotify &watcher, const std::filesystem::path &canonicalRootPath);
+    void removeRoots(DirectoryWatcherFanotify &watcher);
+
+    // Reads and dispatches events already queued by the kernel. Called by the reactor thread, but also by watchers
+    // being stopped, so events which happened before the stop are not lost.
+    void readEvents();
+
+private:
+    struct MarkedFilesystem {
+        OsHandle mountHandle = defaultOsHandle;
+        size_t rootsCount = 0u;
+    };
+    struct Root {
+        DirectoryWatcherFanotify *watcher = nullptr;
+        uint64_t filesystemId = 0u;
+    };
+
+    void scheduleFlush(DirectoryWatcherFanotify &watcher);
+    void dispatchEvent(const fanotify_event_metadata &eventMetadata);
+    bool resolveDirectoryPath(uint64_t filesystemId, const std::byte *fileHandle, size_t fileHandleSize, std::string &outPath);
+    void invalidateDirectoryPathCache(const std::string &directoryPath);
+    void clearDirectoryPathCache();
+
+    const size_t bufferSize;
+    std::mutex bufferMutex = {};
+    std::unique_ptr<std::byte[]> buffer = nullptr;
+    OsHandle fanotifyEventQueue = defaultOsHandle;
+    std::unique_ptr<PollingThread> pollingThread = nullptr;
+
+    // Recursive, because watchers are called by the reactor thread with the lock held
+    std::recursive_mutex rootsMutex = {};
+    std::unordered_map<std::string, std::vector<Root>> roots = {};
+    std::unordered_map<uint64_t, MarkedFilesystem> markedFilesystems = {};
+    std::vector<DirectoryWatcherFanotify *> watchersToFlush = {};
+    uint64_t eventsCount = 0u;
+
+    // Resolving a file handle to a path requires two syscalls, so results are cached. When a directory is moved or
+    // deleted, entries for it and its descendants are invalidated. They are found by path, so the cache is also
+    // indexed by path, ordered to keep a subtree in one range.
+    std::unordered_map<std::string, std::string> directoryPathCache = {};
+    std::map<std::string, std::string> directoryPathCacheKeys = {};
+};
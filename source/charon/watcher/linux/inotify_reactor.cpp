@@ -0,0 +1,163 @@
+#include "charon/util/linux/error.h"
+#include "charon/watcher/linux/directory_watcher_linux.h"
+#include "charon/watcher/linux/inotify_reactor.h"
+
+#include <algorithm>
+#include <climits>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <unordered_set>
+
+// IN_CREATE is needed to detect new subdirectories in recursive mode. Watch masks are per directory, so all watches
+// have to use the same mask, even if only some of the watchers are recursive.
+constexpr static inline uint32_t watchMask = IN_CLOSE_WRITE | IN_DELETE | IN_MOVE | IN_CREATE;
+
+// Kernel refuses to read into a buffer which cannot fit a single event with the longest possible name
+constexpr static inline size_t minBufferSize = sizeof(inotify_event) + NAME_MAX + 1;
+
+std::shared_ptr<InotifyReactor> InotifyReactor::getShared(size_t bufferSize) {
+    static std::mutex mutex{};
+    static std::weak_ptr<InotifyReactor> sharedReactor{};
+
+    std::lock_guard lock{mutex};
+    std::shared_ptr<InotifyReactor> reactor = sharedReactor.lock();
+    if (reactor == nullptr) {
+        reactor = std::make_shared<InotifyReactor>(bufferSize);
+        sharedReactor = reactor;
+    }
+    return reactor;
+}
+
+InotifyReactor::InotifyReactor(size_t bufferSize)
+    : bufferSize(std::max(bufferSize, minBufferSize)) {
+    inotifyEventQueue = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    FATAL_ERROR_IF_SYSCALL_FAILED(inotifyEventQueue, "Failed inotify_init1");
+
+    buffer = std::make_unique<std::byte[]>(this->bufferSize);
+    pollingThread = std::make_unique<PollingThread>(inotifyEventQueue, [this]() { readEvents(); });
+}
+
+InotifyReactor::~InotifyReactor() {
+    // Stop background thread before closing the queue. Closing inotify queue implicitly removes all remaining watches.
+    pollingThread.reset();
+    FATAL_ERROR_IF_SYSCALL_FAILED(close(inotifyEventQueue), "Failed closing inotify queue");
+}
+
+int InotifyReactor::addWatch(DirectoryWatcherLinux &watcher, const std::filesystem::path &directoryPath) {
+    std::lock_guard lock{watchesMutex};
+
+    const int watchDescriptor = inotify_add_watch(inotifyEventQueue, directoryPath.c_str(), watchMask);
+    if (watchDescriptor < 0) {
+        return watchDescriptor;
+    }
+
+    // Multiple watchers can watch the same directory. Kernel returns the same watch descriptor in such case.
+    std::vector<DirectoryWatcherLinux *> &watchersForDescriptor = watches[watchDescriptor];
+    if (std::find(watchersForDescriptor.begin(), watchersForDescriptor.end(), &watcher) == watchersForDescriptor.end()) {
+        watchersForDescriptor.push_back(&watcher);
+    }
+    return watchDescriptor;
+}
+
+void InotifyReactor::removeWatch(DirectoryWatcherLinux &watcher, int watchDescriptor) {
+    std::lock_guard lock{watchesMutex};
+
+    auto it = watches.find(watchDescriptor);
+    if (it == watches.end()) {
+        return;
+    }
+
+    std::vector<DirectoryWatcherLinux *> &watchersForDescriptor = it->second;
+    watchersForDescriptor.erase(std::remove(watchersForDescriptor.begin(), watchersForDescriptor.end(), &watcher), watchersForDescriptor.end());
+    if (watchersForDescriptor.empty()) {
+        // Watch could have already been removed by the kernel (e.g. directory was deleted), so we don't check for errors
+        inotify_rm_watch(inotifyEventQueue, watchDescriptor);
+        watches.erase(it);
+    }
+}
+
+void InotifyReactor::removeWatches(DirectoryWatcherLinux &watcher) {
+    std::lock_guard lock{watchesMutex};
+
+    for (auto it = watches.begin(); it != watches.end();) {
+        std::vector<DirectoryWatcherLinux *> &watchersForDescriptor = it->second;
+        watchersForDescriptor.erase(std::remove(watchersForDescriptor.begin(), watchersForDescriptor.end(), &watcher), watchersForDescriptor.end());
+
+        if (watchersForDescriptor.empty()) {
+            inotify_rm_watch(inotifyEventQueue, it->first);
+            it = watches.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+void InotifyReactor::readEvents() {
+    std::lock_guard bufferLock{bufferMutex};
+
+    // Drain the queue, so events from a burst are published in as few batches as possible
+    while (true) {
+        const ssize_t readResult = read(inotifyEventQueue, buffer.get(), bufferSize);
+        if (readResult < 0 && errno == EAGAIN) {
+            return;
+        }
+        FATAL_ERROR_IF_SYSCALL_FAILED(readResult, "Read from inotify queue failed");
+
+        std::lock_guard lock{watchesMutex};
+        for (ssize_t positionInBuffer = 0; positionInBuffer < readResult;) {
+            const inotify_event &inotifyEvent = reinterpret_cast<inotify_event &>(buffer[positionInBuffer]);
+            dispatchEvent(inotifyEvent);
+            positionInBuffer += sizeof(inotify_event) + inotifyEvent.len;
+        }
+
+        for (DirectoryWatcherLinux *watcher : watchersToFlush) {
+            watcher->flushEvents();
+        }
+        watchersToFlush.clear();
+    }
+}
+
+void InotifyReactor::scheduleFlush(DirectoryWatcherLinux &watcher) {
+    // Events of different watchers are published in the order in which watchers first received them
+    if (std::find(watchersToFlush.rbegin(), watchersToFlush.rend(), &watcher) == watchersToFlush.rend()) {
+        watchersToFlush.push_back(&watcher);
+    }
+}
+
+void InotifyReactor::dispatchEvent(const inotify_event &inotifyEvent) {
+    if (inotifyEvent.mask & IN_Q_OVERFLOW) {
+        // Overflow is not related to any watch descriptor. We don't know which events were lost, so every watcher has to check its directories.
+        std::unordered_set<DirectoryWatcherLinux *> watchers{};
+        for (const auto &[watchDescriptor, watchersForDescriptor] : watches) {
+            watchers.insert(watchersForDescriptor.begin(), watchersForDescriptor.end());
+        }
+        for (DirectoryWatcherLinux *watcher : watchers) {
+            watcher->handleQueueOverflow();
+            scheduleFlush(*watcher);
+        }
+        return;
+    }
+
+    auto it = watches.find(inotifyEvent.wd);
+    if (it == watches.end()) {
+        // Watch has already been removed, but there were still some events pending
+        return;
+    }
+
+    // Watchers can add or remove watches while handling the event, so we cannot iterate directly over the map
+    const std::vector<DirectoryWatcherLinux *> watchersForDescriptor = it->second;
+
+    if (inotifyEvent.mask & IN_IGNORED) {
+        // Kernel removed the watch, e.g. because the directory was deleted
+        watches.erase(it);
+        for (DirectoryWatcherLinux *watcher : watchersForDescriptor) {
+            watcher->handleWatchRemoved(inotifyEvent.wd);
+        }
+        return;
+    }
+
+    for (DirectoryWatcherLinux *watcher : watchersForDescriptor) {
+        watcher->handleInotifyEvent(inotifyEvent);
+        scheduleFlush(*watcher);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "charon/charon/os_handle.h"
+#include "charon/util/class_traits.h"
+#include "charon/watcher/linux/polling_thread.h"
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class DirectoryWatcherLinux;
+struct inotify_event;
+
+// Single inotify instance shared by all DirectoryWatcherLinux objects in the process. One epoll-driven thread
+// reads the events and routes them to the watchers based on watch descriptors.
+class InotifyReactor : NonCopyableAndMovable {
+public:
+    // Buffer size is used only if the shared reactor doesn't exist yet
+    static std::shared_ptr<InotifyReactor> getShared(size_t bufferSize);
+
+    explicit InotifyReactor(size_t bufferSize);
+    ~InotifyReactor();
+
+    // Watchers have to hold the lock while modifying their watches, so the reactor thread doesn't dispatch events for
+    // watch descriptors they haven't recorded yet. The lock is already held while watchers are handling events.
+    auto lock() { return std::unique_lock{watchesMutex}; }
+    int addWatch(DirectoryWatcherLinux &watcher, const std::filesystem::path &directoryPath);
+    void removeWatch(DirectoryWatcherLinux &watcher, int watchDescriptor);
+    void removeWatches(DirectoryWatcherLinux &watcher);
+
+    // Reads and dispatches events already queued by the kernel. Called by the reactor thread, but also by watchers
+    // being stopped, so events which happened before the stop are not lost.
+    void readEvents();
+
+private:
+    void scheduleFlush(DirectoryWatcherLinux &watcher);
+    void dispatchEvent(const inotify_event &inotifyEvent);
+
+    const size_t bufferSize;
+    std::mutex bufferMutex = {};
+    std::unique_ptr<std::byte[]> buffer = nullptr;
+    OsHandle inotifyEventQueue = defaultOsHandle;
+    std::unique_ptr<PollingThread> pollingThread = nullptr;
+
+    // Recursive, because watchers may register new watches while handling events dispatched by the reactor thread.
+    std::recursive_mutex watchesMutex = {};
+    std::unordered_map<int, std::vector<DirectoryWatcherLinux *>> watches = {};
+    std::vector<DirectoryWatcherLinux *> watchersToFlush = {};
+};
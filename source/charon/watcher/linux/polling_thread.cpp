@@ -0,0 +1,63 @@
+#include "charon/util/linux/error.h"
+#include "charon/watcher/linux/polling_thread.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+PollingThread::PollingThread(OsHandle handle, std::function<void()> readCallback)
+    : handle(handle),
+      readCallback(std::move(readCallback)) {
+    // Initialize eventfd used to interrupt the thread from the main thread
+    interruptEventHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    FATAL_ERROR_IF_SYSCALL_FAILED(interruptEventHandle, "Failed eventfd creation");
+
+    // Register both handles in epoll
+    epollHandle = epoll_create1(EPOLL_CLOEXEC);
+    FATAL_ERROR_IF_SYSCALL_FAILED(epollHandle, "Failed epoll_create1");
+    for (OsHandle handleToPoll : {handle, interruptEventHandle}) {
+        epoll_event epollEvent{};
+        epollEvent.events = EPOLLIN;
+        epollEvent.data.fd = handleToPoll;
+        FATAL_ERROR_IF_SYSCALL_FAILED(epoll_ctl(epollHandle, EPOLL_CTL_ADD, handleToPoll, &epollEvent), "Failed epoll_ctl");
+    }
+
+    // Start background thread
+    thread = std::make_unique<std::thread>(threadProcedure, std::reference_wrapper{*this});
+}
+
+PollingThread::~PollingThread() {
+    // Interrupt background thread and wait for completion
+    const uint64_t interruptValue = 1;
+    FATAL_ERROR_IF_SYSCALL_FAILED(write(interruptEventHandle, &interruptValue, sizeof(interruptValue)), "Failed interrupting polling thread");
+    thread->join();
+
+    FATAL_ERROR_IF_SYSCALL_FAILED(close(epollHandle), "Failed closing epoll");
+    FATAL_ERROR_IF_SYSCALL_FAILED(close(interruptEventHandle), "Failed closing eventfd");
+}
+
+void PollingThread::threadProcedure(PollingThread &pollingThread) {
+    constexpr int maxEpollEvents = 2;
+    epoll_event epollEvents[maxEpollEvents];
+
+    while (true) {
+        const int epollEventsCount = epoll_wait(pollingThread.epollHandle, epollEvents, maxEpollEvents, -1);
+        if (epollEventsCount < 0 && errno == EINTR) {
+            continue;
+        }
+        FATAL_ERROR_IF_SYSCALL_FAILED(epollEventsCount, "epoll_wait() failed");
+
+        bool interrupted = false;
+        for (int epollEventIndex = 0; epollEventIndex < epollEventsCount; epollEventIndex++) {
+            if (epollEvents[epollEventIndex].data.fd == pollingThread.handle) {
+                pollingThread.readCallback();
+            } else {
+                interrupted = true;
+            }
+        }
+
+        if (interrupted) {
+            break;
+        }
+    }
+}
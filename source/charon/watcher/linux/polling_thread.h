@@ -0,0 +1,25 @@
+#pragma once
+
+#include "charon/charon/os_handle.h"
+#include "charon/util/class_traits.h"
+
+#include <functional>
+#include <memory>
+#include <thread>
+
+// Background thread, which waits for a handle to become readable and calls a callback each time it happens.
+// The thread is interrupted and joined on destruction.
+class PollingThread : NonCopyableAndMovable {
+public:
+    PollingThread(OsHandle handle, std::function<void()> readCallback);
+    ~PollingThread();
+
+private:
+    static void threadProcedure(PollingThread &pollingThread);
+
+    const OsHandle handle;
+    const std::function<void()> readCallback;
+    OsHandle epollHandle = defaultOsHandle;
+    OsHandle interruptEventHandle = defaultOsHandle;
+    std::unique_ptr<std::thread> thread = nullptr;
+};
@@ -0,0 +1,157 @@
+#include "charon/util/directory_enumerator.h"
+#include "charon/util/logger.h"
+#include "charon/watcher/startup_scanner.h"
+
+#include <algorithm>
+
+StartupScanner::StartupScanner(FileEventQueue &outputQueue)
+    : outputQueue(outputQueue) {}
+
+StartupScanner::~StartupScanner() {
+    stop();
+}
+
+void StartupScanner::addDirectory(const fs::path &directory, bool recursive) {
+    rootDirectories.push_back(PendingDirectory{directory, directory, recursive});
+    isTrackingReportedPaths.store(true);
+}
+
+void StartupScanner::start() {
+    startTime = Clock::now();
+    nextPublishTime = startTime;
+    pendingDirectories.assign(rootDirectories.begin(), rootDirectories.end());
+    for (size_t workerIndex = 0u; workerIndex < std::max<size_t>(threadsCount, 1u); workerIndex++) {
+        workers.emplace_back([this]() { runWorker(); });
+    }
+}
+
+void StartupScanner::stop() {
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+    }
+    conditionVariable.notify_all();
+    waitForCompletion();
+}
+
+void StartupScanner::waitForCompletion() {
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void StartupScanner::runWorker() {
+    while (true) {
+        PendingDirectory directory{};
+        {
+            std::unique_lock lock{mutex};
+            conditionVariable.wait(lock, [this]() { return stopping || finished || !pendingDirectories.empty() || busyWorkersCount == 0; });
+            if (stopping || finished) {
+                return;
+            }
+            if (pendingDirectories.empty()) {
+                // Nothing to scan and no one can find new directories - the scan is complete
+                finished = true;
+                conditionVariable.notify_all();
+                const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime);
+                log(LogLevel::Info) << "Startup scan found " << scannedFilesCount.load() << " files in " << duration.count() << "ms";
+                isScanComplete.store(true);
+                lock.unlock();
+
+                std::lock_guard reportedPathsLock{reportedPathsMutex};
+                stopTrackingReportedPathsIfDone();
+                return;
+            }
+            directory = std::move(pendingDirectories.front());
+            pendingDirectories.pop_front();
+            busyWorkersCount++;
+        }
+
+        scanDirectory(directory);
+
+        {
+            std::lock_guard lock{mutex};
+            busyWorkersCount--;
+        }
+        conditionVariable.notify_all();
+    }
+}
+
+void StartupScanner::scanDirectory(const PendingDirectory &directory) {
+    std::vector<FileEvent> events{};
+    std::vector<PendingDirectory> subdirectories{};
+    const auto callback = [&](const fs::path &path, fs::file_type type) {
+        if (type == fs::file_type::regular) {
+            events.push_back(FileEvent{directory.watchedRootPath, FileEvent::Type::Add, path, defaultOsHandle, true});
+            if (events.size() == maxBatchSize) {
+                publishEvents(events);
+            }
+        } else if (type == fs::file_type::directory && directory.recursive) {
+            subdirectories.push_back(PendingDirectory{directory.watchedRootPath, path, true});
+        }
+    };
+    if (!enumerateDirectory(directory.path, callback)) {
+        log(LogLevel::Warning) << "Startup scan could not read directory " << directory.path;
+    }
+    publishEvents(events);
+
+    if (!subdirectories.empty()) {
+        std::lock_guard lock{mutex};
+        pendingDirectories.insert(pendingDirectories.end(), subdirectories.begin(), subdirectories.end());
+    }
+}
+
+void StartupScanner::publishEvents(std::vector<FileEvent> &events) {
+    if (events.empty()) {
+        return;
+    }
+
+    if (waitForRateLimit(events.size())) {
+        const size_t eventsCount = events.size();
+        const size_t queuedCount = outputQueue.pushBatch(events);
+        scannedFilesCount += eventsCount;
+        queuedFilesCount += queuedCount;
+    }
+    events.clear();
+}
+
+bool StartupScanner::waitForRateLimit(size_t eventsCount) {
+    std::unique_lock lock{mutex};
+    if (eventsPerSecond == 0) {
+        return !stopping;
+    }
+
+    // Each event takes its time slot, so the events are spread evenly regardless of how many threads publish them
+    const auto publishTime = std::max(nextPublishTime, Clock::now());
+    nextPublishTime = publishTime + std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(eventsCount)) / eventsPerSecond;
+    return !conditionVariable.wait_until(lock, publishTime, [this]() { return stopping; });
+}
+
+bool StartupScanner::filterEvent(const FileEvent &event) {
+    if (!isTrackingReportedPaths.load()) {
+        return true;
+    }
+
+    std::lock_guard lock{reportedPathsMutex};
+    if (!event.isFromStartupScan) {
+        if (event.needsFileLocking()) {
+            reportedPaths.insert(event.path.native());
+        }
+        return true;
+    }
+
+    const bool isReported = reportedPaths.find(event.path.native()) != reportedPaths.end();
+    filteredFilesCount++;
+    stopTrackingReportedPathsIfDone();
+    return !isReported;
+}
+
+void StartupScanner::stopTrackingReportedPathsIfDone() {
+    // Called with reportedPathsMutex locked
+    // Events coalesced in the queue never reach the filter, so only the queued ones are awaited
+    if (isScanComplete.load() && filteredFilesCount == queuedFilesCount.load()) {
+        isTrackingReportedPaths.store(false);
+        reportedPaths = {};
+    }
+}
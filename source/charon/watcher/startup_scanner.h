@@ -0,0 +1,82 @@
+#pragma once
+
+#include "charon/util/class_traits.h"
+#include "charon/watcher/file_event_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Reports files which appeared in watched directories while Charon was not running. Directories are enumerated by
+// multiple threads and every regular file is published as an Add event, as if a watcher has just seen it, so it goes
+// through the DeferredFileLocker and the Processor like any other file. Events are published at a limited rate, so a
+// large backlog doesn't delay processing of live events.
+//
+// Watchers are started before the scan, so no file is missed, but files created or modified in the meantime can be
+// reported by both. The consumer of the output queue passes all events through filterEvent(), which drops scanned
+// files already reported by watchers. Paths are remembered only until all queued scan events have been filtered.
+class StartupScanner : NonCopyableAndMovable {
+public:
+    explicit StartupScanner(FileEventQueue &outputQueue);
+    ~StartupScanner();
+
+    // Have to be called before start(). Rate equal to 0 means no limit.
+    void addDirectory(const fs::path &directory, bool recursive);
+    void setRateLimit(size_t eventsPerSecond) { this->eventsPerSecond = eventsPerSecond; }
+    void setThreadsCount(size_t threadsCount) { this->threadsCount = threadsCount; }
+
+    bool hasDirectories() const { return !rootDirectories.empty(); }
+    void start();
+    // Interrupts the scan if it's still running
+    void stop();
+    void waitForCompletion();
+
+    size_t getScannedFilesCount() const { return scannedFilesCount.load(); }
+
+    // Returns false if the event comes from the scan and the file has already been reported by a watcher
+    bool filterEvent(const FileEvent &event);
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct PendingDirectory {
+        fs::path watchedRootPath;
+        fs::path path;
+        bool recursive;
+    };
+
+    void runWorker();
+    void scanDirectory(const PendingDirectory &directory);
+    void publishEvents(std::vector<FileEvent> &events);
+    bool waitForRateLimit(size_t eventsCount);
+    void stopTrackingReportedPathsIfDone();
+
+    constexpr static inline size_t maxBatchSize = 64u;
+
+    FileEventQueue &outputQueue;
+    std::vector<PendingDirectory> rootDirectories = {};
+    size_t eventsPerSecond = 0u;
+    size_t threadsCount = 4u;
+
+    std::vector<std::thread> workers = {};
+    std::mutex mutex = {};
+    std::condition_variable conditionVariable = {};
+    std::deque<PendingDirectory> pendingDirectories = {};
+    size_t busyWorkersCount = 0u;
+    bool stopping = false;
+    bool finished = false;
+    Clock::time_point nextPublishTime = {};
+    Clock::time_point startTime = {};
+    std::atomic_size_t scannedFilesCount = 0u;
+    std::atomic_size_t queuedFilesCount = 0u;
+    std::atomic_bool isScanComplete = false;
+
+    std::atomic_bool isTrackingReportedPaths = false;
+    std::mutex reportedPathsMutex = {};
+    std::unordered_set<PathStringType> reportedPaths = {};
+    size_t filteredFilesCount = 0u;
+};
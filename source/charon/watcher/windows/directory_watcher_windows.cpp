@@ -1,19 +1,28 @@
+#include "charon/util/directory_enumerator.h"
 #include "charon/util/error.h"
 #include "charon/util/logger.h"
 #include "charon/watcher/directory_watcher_factory.h"
 #include "charon/watcher/windows/directory_watcher_windows.h"
 
 std::unique_ptr<DirectoryWatcher> DirectoryWatcherFactoryImpl::create(const std::filesystem::path &directoryPath,
+                                                                      bool recursive,
                                                                       FileEventQueue &outputQueue,
                                                                       FileEventQueue &deferredOutputQueue) {
-    return std::unique_ptr<DirectoryWatcher>(new DirectoryWatcherWindows(directoryPath, outputQueue, deferredOutputQueue));
+    return std::unique_ptr<DirectoryWatcher>(new DirectoryWatcherWindows(directoryPath, recursive, outputQueue, deferredOutputQueue, readBufferSize));
+}
+
+bool DirectoryWatcherFactoryImpl::isMountWideWatchingSupported() {
+    return false;
 }
 
 DirectoryWatcherWindows::DirectoryWatcherWindows(const std::filesystem::path &directoryPath,
+                                                 bool recursive,
                                                  FileEventQueue &outputQueue,
-                                                 FileEventQueue &deferredOutputQueue)
-    : DirectoryWatcher(directoryPath, outputQueue, deferredOutputQueue),
-      interruptEvent(true) {}
+                                                 FileEventQueue &deferredOutputQueue,
+                                                 size_t bufferSize)
+    : DirectoryWatcher(directoryPath, recursive, outputQueue, deferredOutputQueue),
+      interruptEvent(true),
+      bufferSize(bufferSize) {}
 
 DirectoryWatcherWindows::~DirectoryWatcherWindows() {
     stop();
@@ -67,8 +76,8 @@ bool DirectoryWatcherWindows::stopImpl() {
 }
 
 void DirectoryWatcherWindows::watcherThreadProcedure(DirectoryWatcherWindows &watcher) {
-    constexpr size_t bufferSize = 4096;
-    auto buffer = std::make_unique<std::byte[]>(bufferSize);
+    const DWORD bufferSize = static_cast<DWORD>(watcher.bufferSize);
+    auto buffer = std::make_unique<DWORD[]>(bufferSize / sizeof(DWORD));
 
     Event watcherEvent{false};
     OVERLAPPED overlapped{};
@@ -81,7 +90,7 @@ void DirectoryWatcherWindows::watcherThreadProcedure(DirectoryWatcherWindows &wa
             watcher.directoryHandle,
             buffer.get(),
             bufferSize,
-            false,
+            watcher.recursive,
             FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME,
             nullptr,
             &overlapped,
@@ -111,10 +120,21 @@ void DirectoryWatcherWindows::watcherThreadProcedure(DirectoryWatcherWindows &wa
         retVal = GetOverlappedResult(watcher.directoryHandle, &overlapped, &outputBufferSize, false);
         FATAL_ERROR_IF(retVal == FALSE, "GetOverlappedResult failed"); // TODO handle this
 
+        // Empty result means that the buffer was too small and the system dropped the events
+        if (outputBufferSize == 0) {
+            watcher.rescanAfterOverflow();
+            watcher.flushEvents();
+            continue;
+        }
+
         // Process returned events
         auto currentEntry = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(buffer.get());
         while (true) {
             FileEvent event = watcher.createFileEvent(*currentEntry);
+            if (watcher.recursive && watcher.isNewDirectory(event)) {
+                // Files could have been placed in the new directory before it appeared in our tree, so we have to report them.
+                watcher.pushEventsForExistingFiles(event.path);
+            }
             watcher.pushEvent(std::move(event));
 
             if (currentEntry->NextEntryOffset == 0) {
@@ -122,6 +142,7 @@ void DirectoryWatcherWindows::watcherThreadProcedure(DirectoryWatcherWindows &wa
             }
             currentEntry = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(reinterpret_cast<uintptr_t>(currentEntry) + currentEntry->NextEntryOffset);
         }
+        watcher.flushEvents();
     }
 }
 
@@ -150,3 +171,14 @@ FileEvent DirectoryWatcherWindows::createFileEvent(const FILE_NOTIFY_INFORMATION
     const std::wstring path{notifyInfo.FileName, notifyInfo.FileNameLength / sizeof(WCHAR)};
     return FileEvent{this->directoryPath, type, this->directoryPath / path};
 }
+
+bool DirectoryWatcherWindows::isNewDirectory(const FileEvent &event) {
+    const bool isNewPath = event.type == FileEvent::Type::Add || event.type == FileEvent::Type::RenameNew;
+    return isNewPath && std::filesystem::is_directory(event.path);
+}
+
+void DirectoryWatcherWindows::pushEventsForExistingFiles(const std::filesystem::path &subdirectoryPath) {
+    enumerateFiles(subdirectoryPath, true, [this](const std::filesystem::path &path) {
+        pushEvent(FileEvent{directoryPath, FileEvent::Type::Add, path});
+    });
+}
@@ -6,7 +6,8 @@
 
 class DirectoryWatcherWindows : public DirectoryWatcher {
 public:
-    DirectoryWatcherWindows(const std::filesystem::path &directoryPath, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue);
+    DirectoryWatcherWindows(const std::filesystem::path &directoryPath, bool recursive, FileEventQueue &outputQueue, FileEventQueue &deferredOutputQueue,
+                            size_t bufferSize);
     DirectoryWatcherWindows::~DirectoryWatcherWindows() override;
 
     bool startImpl() override;
@@ -26,9 +27,12 @@ private:
     static HANDLE openHandle(const std::filesystem::path &directoryPath);
     static void watcherThreadProcedure(DirectoryWatcherWindows &watcher);
     FileEvent createFileEvent(const FILE_NOTIFY_INFORMATION &notifyInfo) const;
+    static bool isNewDirectory(const FileEvent &event);
+    void pushEventsForExistingFiles(const std::filesystem::path &subdirectoryPath);
 
     // Contant data
     Event interruptEvent;
+    const size_t bufferSize;
 
     // Data created for current start() session
     HANDLE directoryHandle = INVALID_HANDLE_VALUE;
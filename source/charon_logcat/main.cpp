@@ -0,0 +1,26 @@
+#include "charon/util/binary_logger.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: charon-logcat <binary log file>\n";
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream file{argv[1], std::ios::in | std::ios::binary};
+    if (!file) {
+        std::cerr << "Could not open " << argv[1] << '\n';
+        return EXIT_FAILURE;
+    }
+    const std::string contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+    if (!decodeBinaryLog(contents, std::cout)) {
+        std::cout.flush();
+        std::cerr << "Log file is malformed\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
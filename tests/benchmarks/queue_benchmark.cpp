@@ -0,0 +1,71 @@
+#include "charon/util/blocking_queue.h"
+#include "charon/util/lock_free_queue.h"
+#include "charon/watcher/file_event.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measures throughput of passing FileEvents from multiple producers (watchers) to a single consumer (Processor or
+// DeferredFileLocker) through both queue implementations, regardless of which one is selected as FileEventQueue.
+
+template <typename Queue>
+static double measureEventsPerSecond(size_t producersCount, size_t eventsPerProducer, size_t batchSize) {
+    Queue queue{};
+    const FileEvent prototypeEvent{"/watched", FileEvent::Type::Add, "/watched/some_directory/some_file.png"};
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> producers{};
+    for (size_t producerIndex = 0; producerIndex < producersCount; producerIndex++) {
+        producers.emplace_back([&]() {
+            std::vector<FileEvent> batch{};
+            for (size_t eventIndex = 0; eventIndex < eventsPerProducer; eventIndex++) {
+                if (batchSize == 1) {
+                    queue.push(prototypeEvent);
+                    continue;
+                }
+                batch.push_back(prototypeEvent);
+                if (batch.size() == batchSize) {
+                    queue.pushBatch(batch);
+                }
+            }
+            queue.pushBatch(batch);
+        });
+    }
+
+    const size_t totalEvents = producersCount * eventsPerProducer;
+    FileEvent event{};
+    for (size_t eventIndex = 0; eventIndex < totalEvents; eventIndex++) {
+        queue.blockingPop(event);
+    }
+
+    const auto endTime = std::chrono::steady_clock::now();
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+
+    const std::chrono::duration<double> duration = endTime - startTime;
+    return totalEvents / duration.count();
+}
+
+int main(int argc, char **argv) {
+    const size_t eventsPerProducer = argc > 1 ? std::stoul(argv[1]) : 100000u;
+
+    std::cout << std::left << std::setw(12) << "producers" << std::setw(12) << "batch"
+              << std::setw(24) << "BlockingQueue [ev/s]" << std::setw(24) << "LockFreeQueue [ev/s]" << std::endl;
+    for (size_t producersCount : {1u, 2u, 4u, 8u}) {
+        for (size_t batchSize : {1u, 64u}) {
+            const double blockingQueueResult = measureEventsPerSecond<BlockingQueue<FileEvent>>(producersCount, eventsPerProducer, batchSize);
+            const double lockFreeQueueResult = measureEventsPerSecond<LockFreeQueue<FileEvent>>(producersCount, eventsPerProducer, batchSize);
+            std::cout << std::left << std::setw(12) << producersCount << std::setw(12) << batchSize
+                      << std::setw(24) << static_cast<uint64_t>(blockingQueueResult)
+                      << std::setw(24) << static_cast<uint64_t>(lockFreeQueueResult) << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#include "charon/util/async_logger.h"
+#include "charon/util/binary_logger.h"
+#include "os_tests/test_files_helper.h"
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <sstream>
+
+struct BinaryLoggerTest : ::testing::Test {
+    static std::string readFile(const fs::path &path) {
+        std::ifstream file{path, std::ios::in | std::ios::binary};
+        return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
+
+    // Removes the timestamp, which precedes each line in brackets
+    static std::vector<std::string> decodeWithoutTimestamps(const fs::path &path) {
+        std::ostringstream text{};
+        EXPECT_TRUE(decodeBinaryLog(readFile(path), text));
+
+        std::vector<std::string> lines{};
+        std::istringstream stream{text.str()};
+        std::string line{};
+        while (std::getline(stream, line)) {
+            EXPECT_EQ('[', line[0]);
+            lines.push_back(line.substr(line.find(']') + 1));
+        }
+        return lines;
+    }
+
+    const fs::path path = TestFilesHelper::getTestFilePath("log.bin");
+};
+
+TEST_F(BinaryLoggerTest, whenMessagesAreLoggedThenTheyCanBeDecodedToText) {
+    {
+        BinaryLogger logger{path, defaultLogLevel};
+        ASSERT_TRUE(logger.isOpen());
+        EXPECT_TRUE(logger.acceptsRecords());
+        for (int i = 0; i < 3; i++) {
+            log(LogLevel::Info, &logger) << "File " << fs::path{"dir/a.txt"} << " has been created " << i;
+        }
+        log(LogLevel::Error, &logger) << "Filesystem operation returned code " << -2 << ": " << std::string{"error"};
+        log(LogLevel::VerboseInfo, &logger) << "Not allowed";
+        logger.log(LogLevel::Warning, "Plain text");
+    }
+
+    const std::vector<std::string> expectedLines{
+        "[Info] File dir/a.txt has been created 0",
+        "[Info] File dir/a.txt has been created 1",
+        "[Info] File dir/a.txt has been created 2",
+        "[Error] Filesystem operation returned code -2: error",
+        "[Warning] Plain text",
+    };
+    EXPECT_EQ(expectedLines, decodeWithoutTimestamps(path));
+}
+
+TEST_F(BinaryLoggerTest, givenExistingLogWhenNewLoggerIsCreatedThenAppendNewSession) {
+    for (int i = 0; i < 2; i++) {
+        BinaryLogger logger{path, defaultLogLevel};
+        log(LogLevel::Info, &logger) << "Session " << i;
+    }
+
+    const std::vector<std::string> expectedLines{"[Info] Session 0", "[Info] Session 1"};
+    EXPECT_EQ(expectedLines, decodeWithoutTimestamps(path));
+}
+
+TEST_F(BinaryLoggerTest, givenAsyncLoggerWhenBinaryLoggerIsTargetThenPassRecords) {
+    {
+        BinaryLogger binaryLogger{path, defaultLogLevel};
+        AsyncLogger logger{binaryLogger, 16, AsyncLogger::OverflowPolicy::Block};
+        EXPECT_TRUE(logger.acceptsRecords());
+        for (int i = 0; i < 100; i++) {
+            log(LogLevel::Info, &logger) << "Message " << i;
+        }
+    }
+
+    const std::vector<std::string> lines = decodeWithoutTimestamps(path);
+    ASSERT_EQ(100u, lines.size());
+    EXPECT_EQ("[Info] Message 99", lines[99]);
+}
+
+TEST_F(BinaryLoggerTest, givenTruncatedOrInvalidLogWhenDecodingThenReturnFalse) {
+    {
+        BinaryLogger logger{path, defaultLogLevel};
+        log(LogLevel::Info, &logger) << "Message " << 1;
+    }
+    std::string contents = readFile(path);
+    std::ostringstream text{};
+    EXPECT_TRUE(decodeBinaryLog(contents, text));
+
+    contents.pop_back();
+    EXPECT_FALSE(decodeBinaryLog(contents, text));
+    EXPECT_FALSE(decodeBinaryLog("not a log", text));
+}
+
+TEST(MappedFileWriterTest, givenDataLargerThanSegmentWhenWritingThenFileContainsAllDataAndNoPadding) {
+    const fs::path path = TestFilesHelper::getTestFilePath("file.bin");
+    std::string expectedContents{};
+    {
+        MappedFileWriter writer{path, 4096};
+        ASSERT_TRUE(writer.isOpen());
+        for (int i = 0; i < 1000; i++) {
+            const std::string chunk(static_cast<size_t>(i % 50 + 1), static_cast<char>('a' + i % 26));
+            EXPECT_TRUE(writer.write(chunk.data(), chunk.size()));
+            expectedContents += chunk;
+        }
+        const std::string largeChunk(10000, 'z');
+        EXPECT_TRUE(writer.write(largeChunk.data(), largeChunk.size()));
+        expectedContents += largeChunk;
+        EXPECT_EQ(expectedContents.size(), writer.getSize());
+    }
+    EXPECT_TRUE(TestFilesHelper::fileContains(path, expectedContents));
+
+    {
+        MappedFileWriter writer{path, 4096};
+        EXPECT_EQ(expectedContents.size(), writer.getSize());
+        EXPECT_TRUE(writer.write("end", 3));
+    }
+    EXPECT_TRUE(TestFilesHelper::fileContains(path, expectedContents + "end"));
+}
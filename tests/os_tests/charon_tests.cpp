@@ -4,7 +4,9 @@
 #include "charon/watcher/directory_watcher_factory.h"
 #include "os_tests/fixtures/processor_config_fixture.h"
 
+#include <atomic>
 #include <gtest/gtest.h>
+#include <thread>
 
 struct RaiiCharonRunner {
     RaiiCharonRunner(Charon &charon) : charon(charon) {
@@ -32,9 +34,9 @@ struct WhiteboxFilesystem : FilesystemImpl {
         return FilesystemImpl::remove(file);
     }
 
-    mutable size_t copyCount = 0u;
-    mutable size_t moveCount = 0u;
-    mutable size_t removeCount = 0u;
+    mutable std::atomic_size_t copyCount = 0u;
+    mutable std::atomic_size_t moveCount = 0u;
+    mutable std::atomic_size_t removeCount = 0u;
 };
 
 struct CharonOsTests : ::testing::Test,
@@ -116,6 +118,68 @@ TEST_F(CharonOsTests, givenConfigWithMatchersAndMultipleFileEventsWhenCharonIsRu
     EXPECT_EQ(0u, filesystem.removeCount);
 }
 
+TEST_F(CharonOsTests, givenMultipleProcessorWorkersAndMultipleFileEventsWhenCharonIsRunningThenResolveUniqueCounters) {
+    ProcessorConfig processorConfig = createProcessorConfigWithOneMatcher();
+    processorConfig.matchers()->matchers[0].actions = {createCopyAction("a#")};
+    Charon charon{processorConfig, filesystem, watcherFactory};
+    charon.setProcessorWorkersCount(4);
+
+    {
+        RaiiCharonRunner charonRunner{charon};
+        for (int i = 0; i < 7; i++) {
+            TestFilesHelper::createFile(srcPath / (std::string("file") + std::to_string(i)));
+        }
+    }
+    rerunCharon(charon);
+
+    for (int i = 0; i < 7; i++) {
+        EXPECT_TRUE(TestFilesHelper::fileExists(srcPath / (std::string("file") + std::to_string(i))));
+        EXPECT_TRUE(TestFilesHelper::fileExists(dstPath / (std::string("a") + std::to_string(i))));
+    }
+    EXPECT_EQ(7u, filesystem.copyCount);
+    EXPECT_EQ(0u, filesystem.moveCount);
+    EXPECT_EQ(0u, filesystem.removeCount);
+}
+
+TEST_F(CharonOsTests, givenSmallBlockingQueuesAndMultipleFileEventsWhenCharonIsStoppedThenProcessAllEvents) {
+    ProcessorConfig processorConfig = createProcessorConfigWithOneMatcher();
+    processorConfig.matchers()->matchers[0].actions = {createCopyAction("${name}")};
+    Charon charon{processorConfig, filesystem, watcherFactory};
+    charon.setEventQueueCapacity(1u, FileEventQueue::OverflowPolicy::Block, {});
+
+    {
+        RaiiCharonRunner charonRunner{charon};
+        for (int i = 0; i < 20; i++) {
+            TestFilesHelper::createFile(srcPath / (std::string("file") + std::to_string(i)));
+        }
+    }
+
+    for (int i = 0; i < 20; i++) {
+        EXPECT_TRUE(TestFilesHelper::fileExists(dstPath / (std::string("file") + std::to_string(i))));
+    }
+    EXPECT_EQ(20u, filesystem.copyCount);
+}
+
+TEST_F(CharonOsTests, givenSmallBlockingQueuesAndMultipleProcessorWorkersWhenCharonIsStoppedThenProcessAllEvents) {
+    ProcessorConfig processorConfig = createProcessorConfigWithOneMatcher();
+    processorConfig.matchers()->matchers[0].actions = {createCopyAction("${name}")};
+    Charon charon{processorConfig, filesystem, watcherFactory};
+    charon.setEventQueueCapacity(2u, FileEventQueue::OverflowPolicy::Block, {});
+    charon.setProcessorWorkersCount(3u);
+
+    {
+        RaiiCharonRunner charonRunner{charon};
+        for (int i = 0; i < 20; i++) {
+            TestFilesHelper::createFile(srcPath / (std::string("file") + std::to_string(i)));
+        }
+    }
+
+    for (int i = 0; i < 20; i++) {
+        EXPECT_TRUE(TestFilesHelper::fileExists(dstPath / (std::string("file") + std::to_string(i))));
+    }
+    EXPECT_EQ(20u, filesystem.copyCount);
+}
+
 TEST_F(CharonOsTests, givenConfigWithMatchersAndMultipleFileEventsAndMultipleActionsWhenCharonIsRunningThenExecuteActions) {
     ProcessorConfig processorConfig = createProcessorConfigWithOneMatcher();
     processorConfig.matchers()->matchers[0].actions = {
@@ -231,3 +295,26 @@ TEST_F(CharonOsTests, givenConfigWithActionsAndFileToProcessWhenCharonIsRunningT
     EXPECT_EQ(1u, filesystem.moveCount);
     EXPECT_EQ(0u, filesystem.removeCount);
 }
+
+TEST_F(CharonOsTests, givenConfigWithMatchersScanningOnStartupAndExistingFilesWhenCharonIsStartedThenProcessExistingFiles) {
+    constexpr auto filesCount = 10u;
+    for (auto i = 0u; i < filesCount; i++) {
+        TestFilesHelper::createFile(srcPath / std::to_string(i));
+    }
+
+    ProcessorConfig processorConfig = createProcessorConfigWithOneMatcher();
+    processorConfig.matchers()->matchers[0].scanOnStartup = true;
+    processorConfig.matchers()->matchers[0].actions = {createMoveAction("${name}")};
+    Charon charon{processorConfig, filesystem, watcherFactory};
+
+    {
+        RaiiCharonRunner charonRunner{charon};
+        for (auto attempt = 0u; attempt < 100u && filesystem.moveCount < filesCount; attempt++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    EXPECT_EQ(0u, TestFilesHelper::countFilesInDirectory(srcPath));
+    EXPECT_EQ(filesCount, TestFilesHelper::countFilesInDirectory(dstPath));
+    EXPECT_EQ(filesCount, filesystem.moveCount);
+}
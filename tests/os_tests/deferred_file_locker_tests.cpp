@@ -48,7 +48,6 @@ TEST_F(DeferredFileLockerTest, givenFileEventWhenDeferredFileLockerIsAlreadyRunn
     EXPECT_EQ(event.type, FileEvent::Type::Add);
     EXPECT_EQ(event.watchedRootPath, testPath);
     EXPECT_EQ(event.path, testPath / "file");
-    EXPECT_NE(event.lockedFileHandle, defaultOsHandle);
 
     filesystem.unlockFile(event.lockedFileHandle);
 }
@@ -67,7 +66,6 @@ TEST_F(DeferredFileLockerTest, givenFileEventWhenDeferredFileLockerIsNotYetRunni
     EXPECT_EQ(event.type, FileEvent::Type::Add);
     EXPECT_EQ(event.watchedRootPath, testPath);
     EXPECT_EQ(event.path, testPath / "file");
-    EXPECT_NE(event.lockedFileHandle, defaultOsHandle);
 
     filesystem.unlockFile(event.lockedFileHandle);
 }
@@ -91,7 +89,6 @@ TEST_F(DeferredFileLockerTest, givenInterruptEventBeforeRegularEventsWhenDeferre
         EXPECT_EQ(event.type, FileEvent::Type::Add);
         EXPECT_EQ(event.watchedRootPath, testPath);
         EXPECT_EQ(event.path, testPath / std::to_string(i));
-        EXPECT_NE(event.lockedFileHandle, defaultOsHandle);
 
         filesystem.unlockFile(event.lockedFileHandle);
     }
@@ -103,10 +100,8 @@ TEST_F(DeferredFileLockerTest, givenFileIsLockedWhenFileLockerProcessesEventThen
     pushFileCreationEventAndCreateFile(testPath / "0");
     pushFileCreationEventAndCreateFile(testPath / "1");
 
-    // Lock file "0"
-    auto [lockedFileHandle, lockResult] = filesystem.lockFile(testPath / "0");
-    ASSERT_EQ(lockResult, Filesystem::LockResult::Success);
-    ASSERT_NE(lockedFileHandle, defaultOsHandle);
+    // Keep file "0" opened by someone else
+    auto lockedFile = TestFilesHelper::openFileForWriting(testPath / "0");
 
     // Run file locker
     DeferredFileLocker fileLocker{inputQueue, outputQueue, filesystem};
@@ -123,17 +118,44 @@ TEST_F(DeferredFileLockerTest, givenFileIsLockedWhenFileLockerProcessesEventThen
     // File "0" is still locked, we shouldn't be able to get anything in the output queue
     EXPECT_FALSE(outputQueue.blockingPop(event, hangTimeout));
 
-    // After unlocking, fileLocker can proceed. Let's push another event to wake the locker from sleep
-    filesystem.unlockFile(lockedFileHandle);
+    // New events don't have to wait for the locked file
     pushFileCreationEventAndCreateFile(testPath / "2");
     ASSERT_TRUE(outputQueue.blockingPop(event));
-    EXPECT_EQ(event.path, testPath / "0");
-    filesystem.unlockFile(event.lockedFileHandle);
-    ASSERT_TRUE(outputQueue.blockingPop(event, hangTimeout));
     EXPECT_EQ(event.path, testPath / "2");
     filesystem.unlockFile(event.lockedFileHandle);
 
+    // After closing, fileLocker can proceed on its next retry
+    lockedFile.close();
+    ASSERT_TRUE(outputQueue.blockingPop(event));
+    EXPECT_EQ(event.path, testPath / "0");
+    filesystem.unlockFile(event.lockedFileHandle);
+
     // Terminate fileLocker
     pushInterruptEvent();
     thread.join();
 }
+
+TEST_F(DeferredFileLockerTest, givenFileIsBeingWrittenWhenFileLockerProcessesEventThenDeferItUntilWritingIsFinished) {
+    auto file = TestFilesHelper::openFileForWriting(testPath / "0");
+    file << "partial";
+    file.flush();
+    inputQueue.push(FileEvent{testPath, FileEvent::Type::Add, testPath / "0"});
+
+    DeferredFileLocker fileLocker{inputQueue, outputQueue, filesystem};
+    std::thread thread{[&]() {
+        fileLocker.run();
+    }};
+
+    FileEvent event{};
+    EXPECT_FALSE(outputQueue.blockingPop(event, hangTimeout));
+
+    file << " and complete";
+    file.close();
+    ASSERT_TRUE(outputQueue.blockingPop(event));
+    EXPECT_EQ(event.path, testPath / "0");
+    EXPECT_TRUE(TestFilesHelper::fileContains(testPath / "0", "partial and complete"));
+    filesystem.unlockFile(event.lockedFileHandle);
+
+    pushInterruptEvent();
+    thread.join();
+}
@@ -1,15 +1,24 @@
 #include "charon/watcher/directory_watcher.h"
 #include "charon/watcher/directory_watcher_factory.h"
 #include "os_tests/test_files_helper.h"
+#include "os_tests/test_helpers.h"
 
+#include <algorithm>
 #include <gtest/gtest.h>
 
 using namespace std::chrono_literals;
 
-struct DirectoryWatcherTest : ::testing::Test {
+struct DirectoryWatcherTest : ::testing::TestWithParam<DirectoryWatcherFactoryImpl::Backend> {
     void SetUp() override {
+        if (GetParam() == DirectoryWatcherFactoryImpl::Backend::MountWide && !DirectoryWatcherFactoryImpl::isMountWideWatchingSupported()) {
+            SKIP();
+        }
         watchedDir = TestFilesHelper::createDirectory("dir");
-        watcher = DirectoryWatcherFactoryImpl{}.create(watchedDir, eventQueue, deferredEventQueue);
+        watcher = createWatcher(watchedDir, false);
+    }
+
+    std::unique_ptr<DirectoryWatcher> createWatcher(const std::filesystem::path &directoryPath, bool recursive) {
+        return DirectoryWatcherFactoryImpl{GetParam()}.create(directoryPath, recursive, eventQueue, deferredEventQueue);
     }
 
     const static inline auto popTimeoutDuration = 5ms;
@@ -19,7 +28,7 @@ struct DirectoryWatcherTest : ::testing::Test {
     std::unique_ptr<DirectoryWatcher> watcher{};
 };
 
-TEST_F(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsStartedThenPushEventToDeferredQueue) {
+TEST_P(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsStartedThenPushEventToDeferredQueue) {
     EXPECT_TRUE(watcher->start());
 
     TestFilesHelper::createFile(watchedDir / "file");
@@ -31,7 +40,7 @@ TEST_F(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsStartedThenPushEventTo
     EXPECT_EQ(FileEvent::Type::Add, event.type);
 }
 
-TEST_F(DirectoryWatcherTest, givenFileRemovedWhenWatcherIsStartedThenPushEventToNormalQueue) {
+TEST_P(DirectoryWatcherTest, givenFileRemovedWhenWatcherIsStartedThenPushEventToNormalQueue) {
     TestFilesHelper::createFile(watchedDir / "file");
 
     EXPECT_TRUE(watcher->start());
@@ -45,7 +54,7 @@ TEST_F(DirectoryWatcherTest, givenFileRemovedWhenWatcherIsStartedThenPushEventTo
     EXPECT_EQ(FileEvent::Type::Remove, event.type);
 }
 
-TEST_F(DirectoryWatcherTest, givenFileRenamedWhenWatcherIsStartedThenPushEvents) {
+TEST_P(DirectoryWatcherTest, givenFileRenamedWhenWatcherIsStartedThenPushEvents) {
     TestFilesHelper::createFile(watchedDir / "file");
 
     EXPECT_TRUE(watcher->start());
@@ -65,14 +74,14 @@ TEST_F(DirectoryWatcherTest, givenFileRenamedWhenWatcherIsStartedThenPushEvents)
     EXPECT_EQ(FileEvent::Type::RenameNew, event.type);
 }
 
-TEST_F(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsNotStartedThenDoNotDetectEvent) {
+TEST_P(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsNotStartedThenDoNotDetectEvent) {
     TestFilesHelper::createFile(watchedDir / "file");
 
     FileEvent event{};
     EXPECT_FALSE(eventQueue.blockingPop(event, popTimeoutDuration));
 }
 
-TEST_F(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsStoppedThenDoNotDetectEvent) {
+TEST_P(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsStoppedThenDoNotDetectEvent) {
     EXPECT_TRUE(watcher->start());
 
     EXPECT_TRUE(watcher->stop());
@@ -83,7 +92,7 @@ TEST_F(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsStoppedThenDoNotDetect
     EXPECT_FALSE(eventQueue.blockingPop(event, popTimeoutDuration));
 }
 
-TEST_F(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsRestartedThenDetectEvent) {
+TEST_P(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsRestartedThenDetectEvent) {
     EXPECT_TRUE(watcher->start());
 
     EXPECT_TRUE(watcher->stop());
@@ -99,7 +108,7 @@ TEST_F(DirectoryWatcherTest, givenFileCreatedWhenWatcherIsRestartedThenDetectEve
     EXPECT_EQ(FileEvent::Type::Add, event.type);
 }
 
-TEST_F(DirectoryWatcherTest, givenMultipleFilesCreatedWhenWatcherIsActiveThenDetectAllEvents) {
+TEST_P(DirectoryWatcherTest, givenMultipleFilesCreatedWhenWatcherIsActiveThenDetectAllEvents) {
     constexpr auto filesCount = 100u;
 
     EXPECT_TRUE(watcher->start());
@@ -117,7 +126,7 @@ TEST_F(DirectoryWatcherTest, givenMultipleFilesCreatedWhenWatcherIsActiveThenDet
     }
 }
 
-TEST_F(DirectoryWatcherTest, givenWatchedDirectoryDoesNotExistWhenWatcherIsStartedThenCreateWatchedDirectory) {
+TEST_P(DirectoryWatcherTest, givenWatchedDirectoryDoesNotExistWhenWatcherIsStartedThenCreateWatchedDirectory) {
     for (int i = 0; i < 2; i++) {
         TestFilesHelper::removeDirectory(watchedDir);
         ASSERT_FALSE(TestFilesHelper::directoryExists(watchedDir));
@@ -128,3 +137,327 @@ TEST_F(DirectoryWatcherTest, givenWatchedDirectoryDoesNotExistWhenWatcherIsStart
         EXPECT_TRUE(watcher->stop());
     }
 }
+
+TEST_P(DirectoryWatcherTest, givenMultipleWatchersWhenFilesAreCreatedThenEventsAreRoutedToCorrectWatchedDirectories) {
+    const auto watchedDir2 = TestFilesHelper::createDirectory("dir2");
+    auto watcher2 = createWatcher(watchedDir2, false);
+
+    EXPECT_TRUE(watcher->start());
+    EXPECT_TRUE(watcher2->start());
+
+    TestFilesHelper::createFile(watchedDir / "file");
+    TestFilesHelper::createFile(watchedDir2 / "file");
+
+    FileEvent event{};
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir, event.watchedRootPath);
+    EXPECT_EQ(watchedDir / "file", event.path);
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir2, event.watchedRootPath);
+    EXPECT_EQ(watchedDir2 / "file", event.path);
+
+    EXPECT_TRUE(watcher2->stop());
+    TestFilesHelper::createFile(watchedDir2 / "file2");
+    TestFilesHelper::createFile(watchedDir / "file2");
+
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir, event.watchedRootPath);
+    EXPECT_EQ(watchedDir / "file2", event.path);
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+}
+
+TEST_P(DirectoryWatcherTest, givenMultipleWatchersForTheSameDirectoryWhenFileIsCreatedThenEachWatcherPushesAnEvent) {
+    auto watcher2 = createWatcher(watchedDir, false);
+
+    EXPECT_TRUE(watcher->start());
+    EXPECT_TRUE(watcher2->start());
+
+    TestFilesHelper::createFile(watchedDir / "file");
+
+    FileEvent event{};
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir / "file", event.path);
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir / "file", event.path);
+
+    EXPECT_TRUE(watcher->stop());
+    TestFilesHelper::createFile(watchedDir / "file2");
+
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir / "file2", event.path);
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+}
+
+struct RecursiveDirectoryWatcherTest : DirectoryWatcherTest {
+    void SetUp() override {
+        DirectoryWatcherTest::SetUp();
+        if (IsSkipped()) {
+            return;
+        }
+        watcher = createWatcher(watchedDir, true);
+    }
+
+    void expectAddEvents(std::vector<std::filesystem::path> expectedPaths) {
+        std::vector<std::filesystem::path> actualPaths{};
+        FileEvent event{};
+        while (deferredEventQueue.blockingPop(event, popTimeoutDuration)) {
+            EXPECT_EQ(watchedDir, event.watchedRootPath);
+            EXPECT_EQ(FileEvent::Type::Add, event.type);
+            actualPaths.push_back(event.path);
+        }
+
+        // Files found during directory scans can be additionally reported by the kernel, so we ignore duplicates
+        std::sort(actualPaths.begin(), actualPaths.end());
+        actualPaths.erase(std::unique(actualPaths.begin(), actualPaths.end()), actualPaths.end());
+        std::sort(expectedPaths.begin(), expectedPaths.end());
+        EXPECT_EQ(expectedPaths, actualPaths);
+    }
+};
+
+TEST_P(DirectoryWatcherTest, givenNonRecursiveWatcherWhenFileIsCreatedInSubdirectoryThenDoNotDetectEvent) {
+    const auto subdirectory = TestFilesHelper::createDirectory(watchedDir / "sub");
+    EXPECT_TRUE(watcher->start());
+
+    TestFilesHelper::createFile(subdirectory / "file");
+
+    FileEvent event{};
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+}
+
+TEST_P(RecursiveDirectoryWatcherTest, givenExistingSubdirectoryWhenFileIsCreatedInItThenDetectEvent) {
+    const auto subdirectory = TestFilesHelper::createDirectory(watchedDir / "sub" / "sub2");
+    EXPECT_TRUE(watcher->start());
+
+    TestFilesHelper::createFile(subdirectory / "file");
+
+    FileEvent event{};
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir, event.watchedRootPath);
+    EXPECT_EQ(subdirectory / "file", event.path);
+    EXPECT_EQ(FileEvent::Type::Add, event.type);
+}
+
+TEST_P(RecursiveDirectoryWatcherTest, givenSubdirectoryCreatedAfterStartWhenFileIsCreatedInItThenDetectEvent) {
+    EXPECT_TRUE(watcher->start());
+
+    const auto subdirectory = TestFilesHelper::createDirectory(watchedDir / "sub");
+    TestFilesHelper::createFile(subdirectory / "file");
+
+    expectAddEvents({subdirectory / "file"});
+}
+
+TEST_P(RecursiveDirectoryWatcherTest, givenDirectoryTreeMovedIntoWatchedDirectoryThenReportExistingFilesAndWatchNewFiles) {
+    const auto outsideDirectory = TestFilesHelper::createDirectory("outside");
+    TestFilesHelper::createDirectory(outsideDirectory / "sub");
+    TestFilesHelper::createFile(outsideDirectory / "file1");
+    TestFilesHelper::createFile(outsideDirectory / "sub" / "file2");
+    EXPECT_TRUE(watcher->start());
+
+    std::filesystem::rename(outsideDirectory, watchedDir / "moved");
+    expectAddEvents({watchedDir / "moved" / "file1", watchedDir / "moved" / "sub" / "file2"});
+
+    TestFilesHelper::createFile(watchedDir / "moved" / "sub" / "file3");
+    expectAddEvents({watchedDir / "moved" / "sub" / "file3"});
+}
+
+TEST_P(RecursiveDirectoryWatcherTest, givenSubdirectoryRenamedWithinWatchedDirectoryThenDoNotReportExistingFilesAndWatchNewFiles) {
+    const auto subdirectory = TestFilesHelper::createDirectory(watchedDir / "sub");
+    TestFilesHelper::createFile(subdirectory / "file1");
+    EXPECT_TRUE(watcher->start());
+
+    std::filesystem::rename(subdirectory, watchedDir / "renamed");
+    FileEvent event{};
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+
+    TestFilesHelper::createFile(watchedDir / "renamed" / "file2");
+    expectAddEvents({watchedDir / "renamed" / "file2"});
+}
+
+TEST_P(RecursiveDirectoryWatcherTest, givenSubdirectoryRenamedAfterFilesWereReportedInItThenReportNewFilesWithNewPaths) {
+    TestFilesHelper::createDirectory(watchedDir / "sub" / "nested");
+    TestFilesHelper::createDirectory(watchedDir / "sub-x");
+    EXPECT_TRUE(watcher->start());
+    TestFilesHelper::createFile(watchedDir / "sub" / "nested" / "file1");
+    TestFilesHelper::createFile(watchedDir / "sub-x" / "file1");
+    expectAddEvents({watchedDir / "sub" / "nested" / "file1", watchedDir / "sub-x" / "file1"});
+
+    std::filesystem::rename(watchedDir / "sub", watchedDir / "renamed");
+    TestFilesHelper::createFile(watchedDir / "renamed" / "nested" / "file2");
+    TestFilesHelper::createFile(watchedDir / "sub-x" / "file2");
+    expectAddEvents({watchedDir / "renamed" / "nested" / "file2", watchedDir / "sub-x" / "file2"});
+}
+
+TEST_P(RecursiveDirectoryWatcherTest, givenSubdirectoryMovedOutOfWatchedDirectoryWhenFileIsCreatedInItThenDoNotDetectEvent) {
+    const auto subdirectory = TestFilesHelper::createDirectory(watchedDir / "sub");
+    EXPECT_TRUE(watcher->start());
+
+    const auto outsideDirectory = TestFilesHelper::getTestFilePath("outside");
+    std::filesystem::rename(subdirectory, outsideDirectory);
+    TestFilesHelper::createFile(outsideDirectory / "file");
+
+    FileEvent event{};
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+}
+
+struct DirectoryWatcherOverflowTest : ::testing::Test {
+    // Watcher which doesn't receive any events from the OS, so we can simulate lost events
+    struct ManualDirectoryWatcher : DirectoryWatcher {
+        using DirectoryWatcher::DirectoryWatcher;
+        using DirectoryWatcher::flushEvents;
+        using DirectoryWatcher::pushEvent;
+        using DirectoryWatcher::rescanAfterOverflow;
+
+        bool startImpl() override {
+            working = true;
+            return true;
+        }
+        bool stopImpl() override {
+            working = false;
+            return true;
+        }
+        bool isWorking() const override { return working; }
+
+        bool working = false;
+    };
+
+    void SetUp() override {
+        watchedDir = TestFilesHelper::createDirectory("dir");
+    }
+
+    const static inline auto popTimeoutDuration = 5ms;
+    std::filesystem::path watchedDir{};
+    FileEventQueue eventQueue{};
+    FileEventQueue deferredEventQueue{};
+};
+
+TEST_F(DirectoryWatcherOverflowTest, givenFilesCreatedWithoutEventsWhenOverflowOccursThenReportOnlyNewFiles) {
+    const auto existingFilePath = TestFilesHelper::createFile(watchedDir / "existing");
+    std::filesystem::last_write_time(existingFilePath, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+    ManualDirectoryWatcher watcher{watchedDir, false, eventQueue, deferredEventQueue};
+    EXPECT_TRUE(watcher.start());
+
+    TestFilesHelper::createFile(watchedDir / "missed");
+    watcher.rescanAfterOverflow();
+    watcher.flushEvents();
+
+    FileEvent event{};
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir, event.watchedRootPath);
+    EXPECT_EQ(watchedDir / "missed", event.path);
+    EXPECT_EQ(FileEvent::Type::Add, event.type);
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(1u, watcher.getOverflowsCount());
+
+    watcher.rescanAfterOverflow();
+    watcher.flushEvents();
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(2u, watcher.getOverflowsCount());
+}
+
+TEST_F(DirectoryWatcherOverflowTest, givenFileReportedByEventWhenOverflowOccursThenDoNotReportItAgain) {
+    ManualDirectoryWatcher watcher{watchedDir, false, eventQueue, deferredEventQueue};
+    EXPECT_TRUE(watcher.start());
+
+    TestFilesHelper::createFile(watchedDir / "file");
+    watcher.pushEvent(FileEvent{watchedDir, FileEvent::Type::Add, watchedDir / "file"});
+    watcher.flushEvents();
+    FileEvent event{};
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+
+    watcher.rescanAfterOverflow();
+    watcher.flushEvents();
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+}
+
+TEST_F(DirectoryWatcherOverflowTest, givenFileReportedByEventAndModifiedWithoutEventWhenOverflowOccursThenReportItAgain) {
+    ManualDirectoryWatcher watcher{watchedDir, false, eventQueue, deferredEventQueue};
+    EXPECT_TRUE(watcher.start());
+
+    const auto filePath = TestFilesHelper::createFile(watchedDir / "file");
+    watcher.pushEvent(FileEvent{watchedDir, FileEvent::Type::Add, filePath});
+    watcher.flushEvents();
+    FileEvent event{};
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+
+    std::filesystem::last_write_time(filePath, std::filesystem::file_time_type::clock::now() + std::chrono::hours(1));
+    watcher.rescanAfterOverflow();
+    watcher.flushEvents();
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(filePath, event.path);
+    EXPECT_EQ(FileEvent::Type::Add, event.type);
+}
+
+TEST_F(DirectoryWatcherOverflowTest, givenFileModifiedWithoutEventWhenOverflowOccursThenReportIt) {
+    const auto filePath = TestFilesHelper::createFile(watchedDir / "file");
+    std::filesystem::last_write_time(filePath, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+    ManualDirectoryWatcher watcher{watchedDir, false, eventQueue, deferredEventQueue};
+    EXPECT_TRUE(watcher.start());
+
+    std::filesystem::last_write_time(filePath, std::filesystem::file_time_type::clock::now());
+    watcher.rescanAfterOverflow();
+    watcher.flushEvents();
+
+    FileEvent event{};
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir / "file", event.path);
+    EXPECT_EQ(FileEvent::Type::Add, event.type);
+}
+
+TEST_F(DirectoryWatcherOverflowTest, givenOldFileMovedIntoDirectoryWithoutEventWhenOverflowOccursThenReportIt) {
+    const auto outsideFilePath = TestFilesHelper::createFile(TestFilesHelper::getTestFilePath("outside"));
+    std::filesystem::last_write_time(outsideFilePath, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+    ManualDirectoryWatcher watcher{watchedDir, false, eventQueue, deferredEventQueue};
+    EXPECT_TRUE(watcher.start());
+
+    std::filesystem::rename(outsideFilePath, watchedDir / "moved");
+    watcher.rescanAfterOverflow();
+    watcher.flushEvents();
+
+    FileEvent event{};
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir / "moved", event.path);
+    EXPECT_EQ(FileEvent::Type::Add, event.type);
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+}
+
+TEST_F(DirectoryWatcherOverflowTest, givenFileRemovedByEventAndMovedBackWithoutEventWhenOverflowOccursThenReportIt) {
+    const auto filePath = TestFilesHelper::createFile(watchedDir / "file");
+    std::filesystem::last_write_time(filePath, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+    ManualDirectoryWatcher watcher{watchedDir, false, eventQueue, deferredEventQueue};
+    EXPECT_TRUE(watcher.start());
+
+    const auto outsideFilePath = TestFilesHelper::getTestFilePath("outside");
+    std::filesystem::rename(filePath, outsideFilePath);
+    watcher.pushEvent(FileEvent{watchedDir, FileEvent::Type::RenameOld, filePath});
+    watcher.flushEvents();
+    FileEvent event{};
+    EXPECT_TRUE(eventQueue.blockingPop(event, popTimeoutDuration));
+
+    std::filesystem::rename(outsideFilePath, filePath);
+    watcher.rescanAfterOverflow();
+    watcher.flushEvents();
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(filePath, event.path);
+    EXPECT_EQ(FileEvent::Type::Add, event.type);
+}
+
+TEST_F(DirectoryWatcherOverflowTest, givenRecursiveWatcherWhenOverflowOccursThenReportFilesFromSubdirectories) {
+    ManualDirectoryWatcher watcher{watchedDir, true, eventQueue, deferredEventQueue};
+    EXPECT_TRUE(watcher.start());
+
+    TestFilesHelper::createDirectory(watchedDir / "sub");
+    TestFilesHelper::createFile(watchedDir / "sub" / "file");
+    watcher.rescanAfterOverflow();
+    watcher.flushEvents();
+
+    FileEvent event{};
+    EXPECT_TRUE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+    EXPECT_EQ(watchedDir, event.watchedRootPath);
+    EXPECT_EQ(watchedDir / "sub" / "file", event.path);
+    EXPECT_FALSE(deferredEventQueue.blockingPop(event, popTimeoutDuration));
+}
+
+static const auto watcherBackends = ::testing::Values(DirectoryWatcherFactoryImpl::Backend::PerDirectory,
+                                                      DirectoryWatcherFactoryImpl::Backend::MountWide);
+INSTANTIATE_TEST_SUITE_P(DirectoryWatcherTestWithDifferentBackends, DirectoryWatcherTest, watcherBackends);
+INSTANTIATE_TEST_SUITE_P(RecursiveDirectoryWatcherTestWithDifferentBackends, RecursiveDirectoryWatcherTest, watcherBackends);
@@ -0,0 +1,51 @@
+#include "charon/util/filesystem_executor.h"
+#include "charon/util/filesystem_impl.h"
+#include "os_tests/test_files_helper.h"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+struct FilesystemExecutorTest : ::testing::Test {
+    void executeAll(FilesystemExecutor &executor) {
+        while (executor.getOperationsInFlightCount() > 0) {
+            executor.reap(10ms);
+        }
+    }
+
+    FilesystemImpl filesystem{};
+};
+
+TEST_F(FilesystemExecutorTest, givenManyFilesWhenMovingAndRemovingThemWithExecutorThenAllOperationsSucceed) {
+    constexpr size_t filesCount = 64;
+    auto executor = FilesystemExecutor::create(filesystem, 16);
+
+    size_t errorsCount = 0u;
+    const auto completion = [&](const OptionalError &result) { errorsCount += result.has_value(); };
+    for (size_t fileIndex = 0u; fileIndex < filesCount; fileIndex++) {
+        const std::string name = std::to_string(fileIndex) + ".txt";
+        TestFilesHelper::createFile(TestFilesHelper::getTestFilePath(name));
+        if (fileIndex % 2 == 0) {
+            executor->submit(FilesystemOperation{FilesystemOperation::Type::Move, TestFilesHelper::getTestFilePath(name), TestFilesHelper::getTestFilePath("dst/" + name)}, completion);
+        } else {
+            executor->submit(FilesystemOperation{FilesystemOperation::Type::Remove, TestFilesHelper::getTestFilePath(name), {}}, completion);
+        }
+    }
+    executeAll(*executor);
+
+    EXPECT_EQ(0u, errorsCount);
+    EXPECT_EQ(filesCount / 2, TestFilesHelper::countFilesInDirectory(TestFilesHelper::getTestFilePath("dst")));
+    EXPECT_EQ(1u, TestFilesHelper::countFilesInDirectory(TestFilesHelper::getTestFilePath("")));
+}
+
+TEST_F(FilesystemExecutorTest, givenNonExistingFileWhenRemovingItWithExecutorThenReportError) {
+    auto executor = FilesystemExecutor::create(filesystem, 4);
+
+    OptionalError error{};
+    executor->submit(FilesystemOperation{FilesystemOperation::Type::Remove, TestFilesHelper::getTestFilePath("missing.txt"), {}},
+                     [&](const OptionalError &result) { error = result; });
+    executeAll(*executor);
+
+    ASSERT_TRUE(error.has_value());
+    EXPECT_EQ(std::errc::no_such_file_or_directory, error.value());
+}
@@ -0,0 +1,184 @@
+#include "charon/util/crc32.h"
+#include "charon/util/filesystem_impl.h"
+#include "os_tests/test_files_helper.h"
+#include "os_tests/test_helpers.h"
+
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <tuple>
+
+#if !defined(WIN32)
+#include "charon/util/linux/file_copy.h"
+
+#include <sys/xattr.h>
+#endif
+
+struct FilesystemTest : ::testing::Test {
+    static std::string createContents(size_t size) {
+        std::string contents(size, '\0');
+        for (size_t i = 0; i < size; i++) {
+            contents[i] = static_cast<char>('a' + i % 26);
+        }
+        return contents;
+    }
+
+    static void writeFile(const fs::path &path, const std::string &contents) {
+        auto file = TestFilesHelper::openFileForWriting(path);
+        file << contents;
+    }
+
+    FilesystemImpl filesystem{};
+    const fs::path srcPath = TestFilesHelper::getTestFilePath("src.txt");
+    const fs::path dstPath = TestFilesHelper::getTestFilePath("dst/dst.txt");
+};
+
+TEST_F(FilesystemTest, givenLargeFileWhenCopyingThenDestinationHasTheSameContents) {
+    const std::string contents = createContents(3 * 1024 * 1024 + 17);
+    writeFile(srcPath, contents);
+
+    EXPECT_FALSE(filesystem.copy(srcPath, dstPath).has_value());
+    EXPECT_TRUE(TestFilesHelper::fileContains(srcPath, contents));
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, contents));
+}
+
+TEST_F(FilesystemTest, givenEmptyFileWhenCopyingThenDestinationIsEmpty) {
+    writeFile(srcPath, "");
+
+    EXPECT_FALSE(filesystem.copy(srcPath, dstPath).has_value());
+    EXPECT_TRUE(TestFilesHelper::fileExists(dstPath));
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, ""));
+}
+
+TEST_F(FilesystemTest, givenLongerDestinationFileWhenCopyingThenOverwriteIt) {
+    writeFile(srcPath, "short");
+    fs::create_directories(dstPath.parent_path());
+    writeFile(dstPath, createContents(1000));
+
+    EXPECT_FALSE(filesystem.copy(srcPath, dstPath).has_value());
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, "short"));
+}
+
+TEST_F(FilesystemTest, givenSourceAndDestinationAreTheSameFileWhenCopyingThenFailAndKeepContents) {
+    writeFile(srcPath, "contents");
+
+    EXPECT_TRUE(filesystem.copy(srcPath, srcPath).has_value());
+    EXPECT_TRUE(TestFilesHelper::fileContains(srcPath, "contents"));
+}
+
+TEST_F(FilesystemTest, givenNonExistingSourceWhenCopyingThenFail) {
+    EXPECT_TRUE(filesystem.copy(srcPath, dstPath).has_value());
+    EXPECT_FALSE(TestFilesHelper::fileExists(dstPath));
+}
+
+TEST_F(FilesystemTest, givenFileWhenMovingAcrossDevicesThenDestinationHasTheSameContentsAndSourceIsRemoved) {
+    const std::string contents = createContents(3 * 1024 * 1024 + 17);
+    writeFile(srcPath, contents);
+
+    EXPECT_FALSE(filesystem.moveAcrossDevices(srcPath, dstPath).has_value());
+    EXPECT_FALSE(TestFilesHelper::fileExists(srcPath));
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, contents));
+    EXPECT_EQ(1u, TestFilesHelper::countFilesInDirectory(dstPath.parent_path()));
+}
+
+#if !defined(WIN32)
+TEST_F(FilesystemTest, givenFileWhenMovingAcrossDevicesThenStoreItsChecksumInDestinationAttribute) {
+    const std::string contents = createContents(3 * 1024 * 1024 + 17);
+    writeFile(srcPath, contents);
+
+    EXPECT_FALSE(filesystem.moveAcrossDevices(srcPath, dstPath).has_value());
+    char value[9] = {};
+    if (::getxattr(dstPath.c_str(), checksumAttributeName, value, 8) != 8) {
+        SKIP(); // filesystem doesn't support user extended attributes
+    }
+    char expectedValue[9] = {};
+    std::snprintf(expectedValue, sizeof(expectedValue), "%08x", updateCrc32(0, contents.data(), contents.size()));
+    EXPECT_STREQ(expectedValue, value);
+}
+#endif
+
+TEST_F(FilesystemTest, givenEmptyFileWhenMovingAcrossDevicesThenDestinationIsEmptyAndSourceIsRemoved) {
+    writeFile(srcPath, "");
+
+    EXPECT_FALSE(filesystem.moveAcrossDevices(srcPath, dstPath).has_value());
+    EXPECT_FALSE(TestFilesHelper::fileExists(srcPath));
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, ""));
+}
+
+TEST_F(FilesystemTest, givenExistingDestinationWhenMovingAcrossDevicesThenOverwriteIt) {
+    writeFile(srcPath, "short");
+    fs::create_directories(dstPath.parent_path());
+    writeFile(dstPath, createContents(1000));
+
+    EXPECT_FALSE(filesystem.moveAcrossDevices(srcPath, dstPath).has_value());
+    EXPECT_FALSE(TestFilesHelper::fileExists(srcPath));
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, "short"));
+}
+
+TEST_F(FilesystemTest, givenNonExistingSourceWhenMovingAcrossDevicesThenFailAndDoNotLeaveAnyFiles) {
+    EXPECT_TRUE(filesystem.moveAcrossDevices(srcPath, dstPath).has_value());
+    EXPECT_EQ(0u, TestFilesHelper::countFilesInDirectory(dstPath.parent_path()));
+}
+
+TEST_F(FilesystemTest, givenFileWhenCopyingAtomicallyThenDestinationHasTheSameContentsAndNoTemporaryFilesAreLeft) {
+    const std::string contents = createContents(3 * 1024 * 1024 + 17);
+    writeFile(srcPath, contents);
+
+    EXPECT_FALSE(filesystem.copyAtomically(srcPath, dstPath).has_value());
+    EXPECT_TRUE(TestFilesHelper::fileContains(srcPath, contents));
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, contents));
+    EXPECT_EQ(1u, TestFilesHelper::countFilesInDirectory(dstPath.parent_path()));
+}
+
+TEST_F(FilesystemTest, givenExistingDestinationWhenCopyingAtomicallyThenFailAndKeepDestination) {
+    writeFile(srcPath, "short");
+    fs::create_directories(dstPath.parent_path());
+    writeFile(dstPath, "existing");
+
+    const OptionalError error = filesystem.copyAtomically(srcPath, dstPath);
+    ASSERT_TRUE(error.has_value());
+    EXPECT_EQ(std::errc::file_exists, error.value());
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, "existing"));
+    EXPECT_EQ(1u, TestFilesHelper::countFilesInDirectory(dstPath.parent_path()));
+}
+
+TEST_F(FilesystemTest, givenFileWhenMovingAtomicallyThenSourceIsRemoved) {
+    writeFile(srcPath, "contents");
+
+    EXPECT_FALSE(filesystem.moveAtomically(srcPath, dstPath).has_value());
+    EXPECT_FALSE(TestFilesHelper::fileExists(srcPath));
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, "contents"));
+}
+
+TEST_F(FilesystemTest, givenExistingDestinationWhenMovingAtomicallyThenFailAndKeepBothFiles) {
+    writeFile(srcPath, "contents");
+    fs::create_directories(dstPath.parent_path());
+    writeFile(dstPath, "existing");
+
+    const OptionalError error = filesystem.moveAtomically(srcPath, dstPath);
+    ASSERT_TRUE(error.has_value());
+    EXPECT_EQ(std::errc::file_exists, error.value());
+    EXPECT_TRUE(TestFilesHelper::fileContains(srcPath, "contents"));
+    EXPECT_TRUE(TestFilesHelper::fileContains(dstPath, "existing"));
+}
+
+TEST_F(FilesystemTest, givenFileOpenedForWritingWhenLockingThenReturnUsedByOtherProcessUntilItIsClosed) {
+    auto file = TestFilesHelper::openFileForWriting(srcPath);
+    file << "contents";
+    file.flush();
+
+    auto [handle, result] = filesystem.lockFile(srcPath);
+    EXPECT_EQ(Filesystem::LockResult::UsedByOtherProcess, result);
+    EXPECT_EQ(defaultOsHandle, handle);
+
+    file.close();
+    std::tie(handle, result) = filesystem.lockFile(srcPath);
+    EXPECT_EQ(Filesystem::LockResult::Success, result);
+    filesystem.unlockFile(handle);
+    EXPECT_EQ(defaultOsHandle, handle);
+}
+
+TEST_F(FilesystemTest, givenNonExistingFileWhenLockingThenReturnDoesNotExist) {
+    auto [handle, result] = filesystem.lockFile(srcPath);
+    EXPECT_EQ(Filesystem::LockResult::DoesNotExist, result);
+    EXPECT_EQ(defaultOsHandle, handle);
+}
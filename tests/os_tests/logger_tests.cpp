@@ -1,8 +1,11 @@
+#include "charon/util/async_logger.h"
+#include "charon/util/log_compressor.h"
 #include "charon/util/logger.h"
 #include "charon/util/time.h"
 #include "os_tests/test_files_helper.h"
 
 #include <gtest/gtest.h>
+#include <thread>
 
 TEST(LoggerTest, givenFileLoggerWhenItIsCreatedThenItAppendsToAnExistingFile) {
     const auto path = TestFilesHelper::getTestFilePath("log.txt");
@@ -41,3 +44,106 @@ TEST(LoggerTest, givenVerboseLevelAllowedWhenFileLoggerIsCreatedThenItAppendsToA
     }
     EXPECT_EQ(1u, TestFilesHelper::countLinesInFile(path));
 }
+
+TEST(LoggerTest, givenAsyncLoggerWithFileLoggerWhenItIsFlushedThenAllLinesAreInTheFile) {
+    const auto path = TestFilesHelper::getTestFilePath("log.txt");
+    TimeImpl time{};
+
+    FileLogger fileLogger{time, path, defaultLogLevel};
+    fileLogger.setAutoFlush(false);
+    AsyncLogger logger{fileLogger, 16, AsyncLogger::OverflowPolicy::Block};
+    for (int i = 0; i < 100; i++) {
+        log(LogLevel::Info, &logger) << "Hello " << i;
+    }
+    logger.flush();
+    EXPECT_EQ(100u, TestFilesHelper::countLinesInFile(path));
+}
+
+struct FileLoggerRotationTest : ::testing::Test {
+    std::vector<fs::path> getRotatedFiles() const {
+        std::vector<fs::path> result{};
+        for (const auto &entry : fs::directory_iterator(path.parent_path())) {
+            if (entry.path() != path) {
+                result.push_back(entry.path());
+            }
+        }
+        return result;
+    }
+
+    const fs::path path = TestFilesHelper::getTestFilePath("log.txt");
+    TimeImpl time{};
+};
+
+TEST_F(FileLoggerRotationTest, givenMaxSizeWhenLogFileExceedsItThenRotateAndCompressIt) {
+    LogRotationPolicy rotationPolicy{};
+    rotationPolicy.maxSize = 50;
+
+    FileLogger logger{time, path, defaultLogLevel, rotationPolicy};
+    for (int i = 0; i < 3; i++) {
+        log(LogLevel::Info, &logger) << "Message " << i << " long enough to exceed maximum size of the log file";
+        logger.waitForCompression();
+    }
+    log(LogLevel::Info, &logger) << "Last message";
+    logger.waitForCompression();
+
+    EXPECT_EQ(1u, TestFilesHelper::countLinesInFile(path));
+    const std::vector<fs::path> rotatedFiles = getRotatedFiles();
+    EXPECT_EQ(3u, rotatedFiles.size());
+    for (const fs::path &rotatedFile : rotatedFiles) {
+        EXPECT_EQ(0u, rotatedFile.filename().string().find("log.txt."));
+        if (LogCompressor::isSupported()) {
+            EXPECT_EQ(LogCompressor::extension, rotatedFile.extension());
+        } else {
+            EXPECT_EQ(1u, TestFilesHelper::countLinesInFile(rotatedFile));
+        }
+    }
+}
+
+TEST_F(FileLoggerRotationTest, givenExistingLogFileLargerThanMaxSizeWhenLoggerIsCreatedThenRotateAfterFirstMessage) {
+    {
+        FileLogger logger{time, path, defaultLogLevel};
+        for (int i = 0; i < 10; i++) {
+            logger.log(LogLevel::Info, "Message");
+        }
+    }
+
+    LogRotationPolicy rotationPolicy{};
+    rotationPolicy.maxSize = 100;
+    FileLogger logger{time, path, defaultLogLevel, rotationPolicy};
+    logger.log(LogLevel::Info, "Message");
+    logger.waitForCompression();
+
+    EXPECT_EQ(0u, TestFilesHelper::countLinesInFile(path));
+    EXPECT_EQ(1u, getRotatedFiles().size());
+}
+
+TEST_F(FileLoggerRotationTest, givenMaxAgeWhenLogFileIsOlderThenRotateIt) {
+    LogRotationPolicy rotationPolicy{};
+    rotationPolicy.maxAge = std::chrono::seconds(1);
+
+    FileLogger logger{time, path, defaultLogLevel, rotationPolicy};
+    logger.log(LogLevel::Info, "Message");
+    EXPECT_EQ(0u, getRotatedFiles().size());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    logger.log(LogLevel::Info, "Message");
+    logger.log(LogLevel::Info, "Message");
+    logger.waitForCompression();
+
+    EXPECT_EQ(1u, TestFilesHelper::countLinesInFile(path));
+    EXPECT_EQ(1u, getRotatedFiles().size());
+}
+
+TEST_F(FileLoggerRotationTest, givenLogFileRemovedWhenRotatingThenReportErrorAndDoNotRetryUntilFileGrowsAgain) {
+    LogRotationPolicy rotationPolicy{};
+    rotationPolicy.maxSize = 200;
+
+    FileLogger logger{time, path, defaultLogLevel, rotationPolicy};
+    fs::remove(path);
+    logger.log(LogLevel::Info, std::string(200, 'a'));
+    logger.log(LogLevel::Info, "Message");
+    logger.waitForCompression();
+
+    EXPECT_EQ(2u, TestFilesHelper::countLinesInFile(path));
+    EXPECT_EQ(0u, getRotatedFiles().size());
+}
@@ -558,7 +558,6 @@ TEST_F(ProcessorTest, givenConfigWithMatchersAndLockedFileWhenProcessingEventThe
 
         auto [lockedFileHandle, lockResult] = filesystem.lockFile(filePath);
         ASSERT_EQ(lockResult, Filesystem::LockResult::Success);
-        ASSERT_NE(lockedFileHandle, defaultOsHandle);
 
         eventQueue.push(FileEvent{srcPath, FileEvent::Type::Add, filePath, lockedFileHandle});
         pushInterruptEvent();
@@ -585,7 +584,6 @@ TEST_F(ProcessorTest, givenConfigWithMatchersAndLockedFileWithIgnoredExtensionWh
 
         auto [lockedFileHandle, lockResult] = filesystem.lockFile(filePath);
         ASSERT_EQ(lockResult, Filesystem::LockResult::Success);
-        ASSERT_NE(lockedFileHandle, defaultOsHandle);
 
         eventQueue.push(FileEvent{srcPath, FileEvent::Type::Add, filePath, lockedFileHandle});
         pushInterruptEvent();
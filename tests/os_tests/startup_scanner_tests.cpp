@@ -0,0 +1,124 @@
+#include "charon/watcher/startup_scanner.h"
+#include "os_tests/test_files_helper.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+struct StartupScannerTest : ::testing::Test {
+    void SetUp() override {
+        rootPath = TestFilesHelper::createDirectory("root");
+    }
+
+    std::vector<fs::path> popPaths() {
+        std::vector<fs::path> result{};
+        FileEvent event{};
+        while (outputQueue.nonBlockingPop(event)) {
+            EXPECT_EQ(FileEvent::Type::Add, event.type);
+            EXPECT_EQ(rootPath, event.watchedRootPath);
+            result.push_back(event.path);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    fs::path rootPath{};
+    FileEventQueue outputQueue{};
+};
+
+TEST_F(StartupScannerTest, givenFilesInSubdirectoriesWhenScanningRecursivelyThenReportAllFiles) {
+    TestFilesHelper::createDirectory(rootPath / "a" / "b");
+    TestFilesHelper::createFile(rootPath / "1");
+    TestFilesHelper::createFile(rootPath / "a" / "2");
+    TestFilesHelper::createFile(rootPath / "a" / "b" / "3");
+
+    StartupScanner scanner{outputQueue};
+    scanner.addDirectory(rootPath, true);
+    scanner.start();
+    scanner.waitForCompletion();
+
+    const std::vector<fs::path> expectedPaths = {rootPath / "1", rootPath / "a" / "2", rootPath / "a" / "b" / "3"};
+    EXPECT_EQ(expectedPaths, popPaths());
+    EXPECT_EQ(3u, scanner.getScannedFilesCount());
+}
+
+TEST_F(StartupScannerTest, givenFilesInSubdirectoriesWhenScanningNonRecursivelyThenReportOnlyTopLevelFiles) {
+    TestFilesHelper::createDirectory(rootPath / "a");
+    TestFilesHelper::createFile(rootPath / "1");
+    TestFilesHelper::createFile(rootPath / "2");
+    TestFilesHelper::createFile(rootPath / "a" / "3");
+
+    StartupScanner scanner{outputQueue};
+    scanner.addDirectory(rootPath, false);
+    scanner.start();
+    scanner.waitForCompletion();
+
+    const std::vector<fs::path> expectedPaths = {rootPath / "1", rootPath / "2"};
+    EXPECT_EQ(expectedPaths, popPaths());
+}
+
+TEST_F(StartupScannerTest, givenRateLimitWhenScanningThenSpreadEventsInTime) {
+    constexpr size_t filesCount = 200;
+    for (size_t fileIndex = 0; fileIndex < filesCount; fileIndex++) {
+        TestFilesHelper::createFile(rootPath / std::to_string(fileIndex));
+    }
+
+    StartupScanner scanner{outputQueue};
+    scanner.addDirectory(rootPath, false);
+    scanner.setRateLimit(1000);
+    const auto startTime = std::chrono::steady_clock::now();
+    scanner.start();
+    scanner.waitForCompletion();
+    const auto duration = std::chrono::steady_clock::now() - startTime;
+
+    EXPECT_EQ(filesCount, popPaths().size());
+    EXPECT_GE(duration, 150ms);
+}
+
+TEST_F(StartupScannerTest, givenFileReportedByWatcherWhenScannedEventIsFilteredThenDropIt) {
+    TestFilesHelper::createFile(rootPath / "1");
+    TestFilesHelper::createFile(rootPath / "2");
+
+    StartupScanner scanner{outputQueue};
+    scanner.addDirectory(rootPath, false);
+    EXPECT_TRUE(scanner.filterEvent(FileEvent{rootPath, FileEvent::Type::Add, rootPath / "1"}));
+    scanner.start();
+    scanner.waitForCompletion();
+
+    std::vector<fs::path> passedPaths{};
+    FileEvent event{};
+    while (outputQueue.nonBlockingPop(event)) {
+        EXPECT_TRUE(event.isFromStartupScan);
+        if (scanner.filterEvent(event)) {
+            passedPaths.push_back(event.path);
+        }
+    }
+    const std::vector<fs::path> expectedPaths = {rootPath / "2"};
+    EXPECT_EQ(expectedPaths, passedPaths);
+
+    // All scanned files have been filtered, so paths reported by watchers are no longer needed
+    EXPECT_TRUE(scanner.filterEvent(FileEvent{rootPath, FileEvent::Type::Add, rootPath / "1", defaultOsHandle, true}));
+}
+
+TEST_F(StartupScannerTest, givenScannedEventCoalescedByQueueWhenAllQueuedEventsAreFilteredThenStopTrackingReportedPaths) {
+    TestFilesHelper::createFile(rootPath / "1");
+    outputQueue.setCapacity(2, FileEventQueue::OverflowPolicy::Coalesce);
+    outputQueue.push(FileEvent{rootPath, FileEvent::Type::Add, rootPath / "1"});
+    outputQueue.push(FileEvent{rootPath, FileEvent::Type::Add, rootPath / "1"});
+
+    // Queue is full and already contains an identical event, so the scanned one is dropped
+    StartupScanner scanner{outputQueue};
+    scanner.addDirectory(rootPath, false);
+    scanner.start();
+    scanner.waitForCompletion();
+    EXPECT_EQ(1u, scanner.getScannedFilesCount());
+    EXPECT_EQ(1u, outputQueue.getCoalescedEventsCount());
+
+    FileEvent event{};
+    while (outputQueue.nonBlockingPop(event)) {
+        EXPECT_FALSE(event.isFromStartupScan);
+        EXPECT_TRUE(scanner.filterEvent(event));
+    }
+    EXPECT_TRUE(scanner.filterEvent(FileEvent{rootPath, FileEvent::Type::Add, rootPath / "1", defaultOsHandle, true}));
+}
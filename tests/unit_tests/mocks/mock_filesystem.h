@@ -12,6 +12,9 @@ struct MockFilesystem : Filesystem {
         const auto matcher = expectNoCalls ? Exactly(0) : AnyNumber();
         EXPECT_CALL(*this, copy).Times(matcher);
         EXPECT_CALL(*this, move).Times(matcher);
+        EXPECT_CALL(*this, moveAcrossDevices).Times(matcher);
+        EXPECT_CALL(*this, copyAtomically).Times(matcher);
+        EXPECT_CALL(*this, moveAtomically).Times(matcher);
         EXPECT_CALL(*this, remove).Times(matcher);
         EXPECT_CALL(*this, listFiles).Times(matcher);
         EXPECT_CALL(*this, lockFile).Times(matcher);
@@ -19,13 +22,18 @@ struct MockFilesystem : Filesystem {
 
         EXPECT_CALL(*this, isFileLockingSupported).Times(AnyNumber());
         EXPECT_CALL(*this, isDirectory).Times(AnyNumber());
+        EXPECT_CALL(*this, getLastWriteTime).Times(AnyNumber());
     }
 
     MOCK_METHOD(OptionalError, copy, (const fs::path &src, const fs::path &dst), (const, override));
     MOCK_METHOD(OptionalError, move, (const fs::path &src, const fs::path &dst), (const, override));
+    MOCK_METHOD(OptionalError, moveAcrossDevices, (const fs::path &src, const fs::path &dst), (const, override));
+    MOCK_METHOD(OptionalError, copyAtomically, (const fs::path &src, const fs::path &dst), (const, override));
+    MOCK_METHOD(OptionalError, moveAtomically, (const fs::path &src, const fs::path &dst), (const, override));
     MOCK_METHOD(OptionalError, remove, (const fs::path &file), (const, override));
     MOCK_METHOD(bool, isDirectory, (const fs::path &path), (const, override));
     MOCK_METHOD(std::vector<fs::path>, listFiles, (const fs::path &directory), (const, override));
+    MOCK_METHOD(std::optional<fs::file_time_type>, getLastWriteTime, (const fs::path &path), (const, override));
 
     MOCK_METHOD((bool), isFileLockingSupported, (), (const, override));
     MOCK_METHOD((std::pair<OsHandle, LockResult>), lockFile, (const fs::path &path), (const, override));
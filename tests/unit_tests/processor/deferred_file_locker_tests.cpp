@@ -0,0 +1,106 @@
+#include "charon/processor/deferred_file_locker.h"
+#include "unit_tests/mocks/mock_filesystem.h"
+#include "unit_tests/mocks/mock_logger.h"
+#include "unit_tests/mocks/mock_os_handle.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+using ::testing::_;
+using ::testing::Return;
+
+struct DeferredFileLockerTest : ::testing::Test {
+    void pushFileEvent(FileEvent::Type type, const fs::path &path) {
+        inputQueue.push(FileEvent{"dir", type, path});
+    }
+
+    const static inline auto usedByOtherProcess = std::make_pair(defaultOsHandle, Filesystem::LockResult::UsedByOtherProcess);
+    const static inline auto lockSuccess = std::make_pair(mockOsHandle, Filesystem::LockResult::Success);
+
+    FileEventQueue inputQueue{};
+    FileEventQueue outputQueue{};
+    MockFilesystem filesystem{};
+    NullLogger nullLogger{};
+};
+
+TEST_F(DeferredFileLockerTest, givenFileUsedByOtherProcessWhenItBecomesAvailableThenPassLockedFileToOutputQueue) {
+    EXPECT_CALL(filesystem, lockFile(fs::path("dir/a")))
+        .WillOnce(Return(usedByOtherProcess))
+        .WillOnce(Return(usedByOtherProcess))
+        .WillOnce(Return(usedByOtherProcess))
+        .WillOnce(Return(lockSuccess));
+
+    DeferredFileLocker fileLocker{inputQueue, outputQueue, filesystem};
+    fileLocker.setRetryPolicy(1ms, 4ms, 0ms);
+    std::thread thread{[&]() { fileLocker.run(); }};
+
+    pushFileEvent(FileEvent::Type::Add, "dir/a");
+    FileEvent event{};
+    ASSERT_TRUE(outputQueue.blockingPop(event));
+    EXPECT_EQ(fs::path("dir/a"), event.path);
+    EXPECT_EQ(mockOsHandle, event.lockedFileHandle);
+
+    inputQueue.push(FileEvent::interruptEvent);
+    thread.join();
+}
+
+TEST_F(DeferredFileLockerTest, givenMultipleEventsForFileUsedByOtherProcessWhenItBecomesAvailableThenPassThemInOrderWithOneLock) {
+    EXPECT_CALL(filesystem, lockFile(fs::path("dir/a")))
+        .WillOnce(Return(usedByOtherProcess))
+        .WillOnce(Return(lockSuccess));
+
+    DeferredFileLocker fileLocker{inputQueue, outputQueue, filesystem};
+    fileLocker.setRetryPolicy(20ms, 20ms, 0ms);
+    pushFileEvent(FileEvent::Type::Add, "dir/a");
+    pushFileEvent(FileEvent::Type::Modify, "dir/a");
+    std::thread thread{[&]() { fileLocker.run(); }};
+
+    FileEvent event{};
+    ASSERT_TRUE(outputQueue.blockingPop(event));
+    EXPECT_EQ(FileEvent::Type::Add, event.type);
+    EXPECT_EQ(mockOsHandle, event.lockedFileHandle);
+    ASSERT_TRUE(outputQueue.blockingPop(event));
+    EXPECT_EQ(FileEvent::Type::Modify, event.type);
+    EXPECT_EQ(defaultOsHandle, event.lockedFileHandle);
+
+    inputQueue.push(FileEvent::interruptEvent);
+    thread.join();
+}
+
+TEST_F(DeferredFileLockerTest, givenFileUsedByOtherProcessForLongerThanMaxWaitThenSkipItAndRetryOnlyFewTimes) {
+    size_t lockAttempts = 0u;
+    EXPECT_CALL(filesystem, lockFile(fs::path("dir/a"))).WillRepeatedly([&](const fs::path &) {
+        lockAttempts++;
+        return usedByOtherProcess;
+    });
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log(LogLevel::Warning, "File dir/a is still used by other process after 50ms. Skipping it."));
+
+    DeferredFileLocker fileLocker{inputQueue, outputQueue, filesystem};
+    fileLocker.setRetryPolicy(1ms, 16ms, 50ms);
+    std::thread thread{[&]() { fileLocker.run(); }};
+
+    pushFileEvent(FileEvent::Type::Add, "dir/a");
+    std::this_thread::sleep_for(200ms);
+    inputQueue.push(FileEvent::interruptEvent);
+    thread.join();
+
+    EXPECT_TRUE(outputQueue.empty());
+    EXPECT_LE(lockAttempts, 12u);
+}
+
+TEST_F(DeferredFileLockerTest, givenLockingFileFailsForUnknownReasonThenSkipItAndLogWarning) {
+    EXPECT_CALL(filesystem, lockFile(fs::path("dir/a"))).WillOnce(Return(std::make_pair(defaultOsHandle, Filesystem::LockResult::Unknown)));
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log(LogLevel::Warning, "Failed to check whether dir/a is used by other process. Skipping it."));
+
+    DeferredFileLocker fileLocker{inputQueue, outputQueue, filesystem};
+    pushFileEvent(FileEvent::Type::Add, "dir/a");
+    inputQueue.push(FileEvent::interruptEvent);
+    fileLocker.run();
+
+    EXPECT_TRUE(outputQueue.empty());
+}
@@ -0,0 +1,68 @@
+#include "charon/processor/directory_counter_cache.h"
+#include "unit_tests/mocks/mock_filesystem.h"
+
+#include <gtest/gtest.h>
+
+using ::testing::_;
+using ::testing::Return;
+
+struct DirectoryCounterCacheTest : ::testing::Test {
+    void SetUp() override {
+        ON_CALL(filesystem, getLastWriteTime(_)).WillByDefault(Return(std::nullopt));
+        ON_CALL(filesystem, getLastWriteTime(directory)).WillByDefault(Return(directoryWriteTime));
+    }
+
+    std::optional<size_t> findFreeCounter(size_t counterStart) {
+        return cache.findFreeCounter(directory, "a", 3, "b", ".jpg", counterStart);
+    }
+
+    const fs::path directory = "dummy/path/";
+    const fs::file_time_type directoryWriteTime = fs::file_time_type::clock::now();
+    MockFilesystem filesystem{};
+    DirectoryCounterCache cache{filesystem};
+};
+
+TEST_F(DirectoryCounterCacheTest, givenDirectoryWithGapsWhenFindingFreeCountersThenListDirectoryOnceAndFillGaps) {
+    EXPECT_CALL(filesystem, listFiles(directory))
+        .WillOnce(Return(std::vector<fs::path>{
+            directory / "a000b.jpg",
+            directory / "a002b.png",
+            directory / "a005b.jpg",
+            directory / "a001.jpg",
+            directory / "a00xb.jpg",
+            directory / "a0001b.jpg",
+        }));
+
+    EXPECT_EQ(1u, findFreeCounter(0));
+    cache.notifyFileCreated(directory / "a001b.jpg");
+    EXPECT_EQ(3u, findFreeCounter(0));
+    cache.notifyFileCreated(directory / "a003b.jpg");
+    EXPECT_EQ(4u, findFreeCounter(0));
+    cache.notifyFileCreated(directory / "a004b.jpg");
+    EXPECT_EQ(6u, findFreeCounter(0));
+    EXPECT_EQ(6u, findFreeCounter(5));
+    EXPECT_EQ(7u, findFreeCounter(7));
+}
+
+TEST_F(DirectoryCounterCacheTest, givenDirectoryModifiedExternallyWhenFindingFreeCounterThenListDirectoryAgain) {
+    EXPECT_CALL(filesystem, listFiles(directory))
+        .WillOnce(Return(std::vector<fs::path>{directory / "a000b.jpg"}))
+        .WillOnce(Return(std::vector<fs::path>{directory / "a000b.jpg", directory / "a001b.jpg"}));
+
+    EXPECT_EQ(1u, findFreeCounter(0));
+    EXPECT_CALL(filesystem, getLastWriteTime(directory)).WillRepeatedly(Return(directoryWriteTime + std::chrono::seconds(1)));
+    EXPECT_EQ(2u, findFreeCounter(0));
+}
+
+TEST_F(DirectoryCounterCacheTest, givenSelectedFileExistsWhenFindingFreeCounterThenSelectNextCounter) {
+    EXPECT_CALL(filesystem, listFiles(directory)).WillOnce(Return(std::vector<fs::path>{}));
+    EXPECT_CALL(filesystem, getLastWriteTime(directory / "a000b.jpg")).WillRepeatedly(Return(directoryWriteTime));
+
+    EXPECT_EQ(1u, findFreeCounter(0));
+}
+
+TEST_F(DirectoryCounterCacheTest, givenDirectoryCannotBeAccessedWhenFindingFreeCounterThenReturnNullopt) {
+    EXPECT_CALL(filesystem, getLastWriteTime(directory)).WillRepeatedly(Return(std::nullopt));
+
+    EXPECT_FALSE(findFreeCounter(0).has_value());
+}
@@ -0,0 +1,134 @@
+#include "charon/processor/event_coalescer.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+struct EventCoalescerTest : ::testing::Test {
+    void pushEvent(FileEvent::Type type, const char *fileName) {
+        inputQueue.push(createEvent(type, fileName));
+    }
+
+    static FileEvent createEvent(FileEvent::Type type, const char *fileName) {
+        return FileEvent{"/watched", type, fs::path{"/watched"} / fileName};
+    }
+
+    // Pushes all events before running the coalescer, so they all land in the same window
+    void runCoalescer(std::chrono::milliseconds window) {
+        inputQueue.push(FileEvent::interruptEvent);
+        EventCoalescer coalescer{inputQueue, outputQueue, deferredOutputQueue};
+        coalescer.setWindow(window);
+        coalescer.run();
+        coalescedEventsCount = coalescer.getCoalescedEventsCount();
+    }
+
+    static std::vector<FileEvent> popAll(FileEventQueue &queue) {
+        std::vector<FileEvent> result{};
+        FileEvent event{};
+        while (queue.nonBlockingPop(event)) {
+            result.push_back(event);
+        }
+        return result;
+    }
+
+    FileEventQueue inputQueue{};
+    FileEventQueue outputQueue{};
+    FileEventQueue deferredOutputQueue{};
+    size_t coalescedEventsCount = 0u;
+};
+
+TEST_F(EventCoalescerTest, givenZeroWindowWhenEventsArePushedThenPassThemThroughUnchanged) {
+    pushEvent(FileEvent::Type::Add, "a");
+    pushEvent(FileEvent::Type::Modify, "a");
+    pushEvent(FileEvent::Type::Remove, "a");
+    runCoalescer(0ms);
+
+    const std::vector<FileEvent> expectedEvents{createEvent(FileEvent::Type::Add, "a"), createEvent(FileEvent::Type::Modify, "a")};
+    const std::vector<FileEvent> expectedRemoveEvents{createEvent(FileEvent::Type::Remove, "a")};
+    EXPECT_EQ(expectedEvents, popAll(deferredOutputQueue));
+    EXPECT_EQ(expectedRemoveEvents, popAll(outputQueue));
+    EXPECT_EQ(0u, coalescedEventsCount);
+}
+
+TEST_F(EventCoalescerTest, givenFileCreatedAndRemovedWithinWindowThenNoEventsArePublished) {
+    pushEvent(FileEvent::Type::Add, "a");
+    pushEvent(FileEvent::Type::Modify, "a");
+    pushEvent(FileEvent::Type::Remove, "a");
+    runCoalescer(1h);
+
+    EXPECT_TRUE(popAll(deferredOutputQueue).empty());
+    EXPECT_TRUE(popAll(outputQueue).empty());
+    EXPECT_EQ(3u, coalescedEventsCount);
+}
+
+TEST_F(EventCoalescerTest, givenRenameChainWithinWindowThenOnlyFirstAndLastNamesArePublished) {
+    pushEvent(FileEvent::Type::RenameOld, "a");
+    pushEvent(FileEvent::Type::RenameNew, "b");
+    pushEvent(FileEvent::Type::RenameOld, "b");
+    pushEvent(FileEvent::Type::RenameNew, "c");
+    pushEvent(FileEvent::Type::RenameOld, "c");
+    pushEvent(FileEvent::Type::RenameNew, "d");
+    runCoalescer(1h);
+
+    const std::vector<FileEvent> expectedEvents{createEvent(FileEvent::Type::RenameNew, "d")};
+    const std::vector<FileEvent> expectedRemoveEvents{createEvent(FileEvent::Type::RenameOld, "a")};
+    EXPECT_EQ(expectedEvents, popAll(deferredOutputQueue));
+    EXPECT_EQ(expectedRemoveEvents, popAll(outputQueue));
+}
+
+TEST_F(EventCoalescerTest, givenRepeatedModificationsWithinWindowThenPublishOneEvent) {
+    pushEvent(FileEvent::Type::Modify, "a");
+    pushEvent(FileEvent::Type::Modify, "b");
+    pushEvent(FileEvent::Type::Modify, "a");
+    pushEvent(FileEvent::Type::Modify, "a");
+    runCoalescer(1h);
+
+    const std::vector<FileEvent> expectedEvents{createEvent(FileEvent::Type::Modify, "a"), createEvent(FileEvent::Type::Modify, "b")};
+    EXPECT_EQ(expectedEvents, popAll(deferredOutputQueue));
+    EXPECT_EQ(2u, coalescedEventsCount);
+}
+
+TEST_F(EventCoalescerTest, givenModifiedFileIsReplacedOrRemovedWithinWindowThenPublishOnlyTheLastEvent) {
+    pushEvent(FileEvent::Type::Modify, "a");
+    pushEvent(FileEvent::Type::RenameNew, "a");
+    pushEvent(FileEvent::Type::Modify, "b");
+    pushEvent(FileEvent::Type::Remove, "b");
+    pushEvent(FileEvent::Type::Remove, "b");
+    runCoalescer(1h);
+
+    const std::vector<FileEvent> expectedEvents{createEvent(FileEvent::Type::RenameNew, "a")};
+    const std::vector<FileEvent> expectedRemoveEvents{createEvent(FileEvent::Type::Remove, "b")};
+    EXPECT_EQ(expectedEvents, popAll(deferredOutputQueue));
+    EXPECT_EQ(expectedRemoveEvents, popAll(outputQueue));
+}
+
+TEST_F(EventCoalescerTest, givenFileRemovedAndCreatedWithinWindowThenPublishBothEvents) {
+    pushEvent(FileEvent::Type::Remove, "a");
+    pushEvent(FileEvent::Type::Add, "a");
+    pushEvent(FileEvent::Type::Remove, "a");
+    runCoalescer(1h);
+
+    const std::vector<FileEvent> expectedRemoveEvents{createEvent(FileEvent::Type::Remove, "a")};
+    EXPECT_TRUE(popAll(deferredOutputQueue).empty());
+    EXPECT_EQ(expectedRemoveEvents, popAll(outputQueue));
+}
+
+TEST_F(EventCoalescerTest, givenEventsOutsideOfWindowThenDoNotFoldThem) {
+    EventCoalescer coalescer{inputQueue, outputQueue, deferredOutputQueue};
+    coalescer.setWindow(1ms);
+    std::thread coalescerThread{[&]() { coalescer.run(); }};
+
+    FileEvent event{};
+    pushEvent(FileEvent::Type::Add, "a");
+    ASSERT_TRUE(deferredOutputQueue.blockingPop(event, 10s));
+    EXPECT_EQ(createEvent(FileEvent::Type::Add, "a"), event);
+
+    pushEvent(FileEvent::Type::Remove, "a");
+    ASSERT_TRUE(outputQueue.blockingPop(event, 10s));
+    EXPECT_EQ(createEvent(FileEvent::Type::Remove, "a"), event);
+
+    inputQueue.push(FileEvent::interruptEvent);
+    coalescerThread.join();
+    EXPECT_EQ(0u, coalescer.getCoalescedEventsCount());
+}
@@ -0,0 +1,80 @@
+#include "charon/processor/ignored_events.h"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+static FileEvent createRemoveEvent(const char *fileName) {
+    return FileEvent{"/watched", FileEvent::Type::Remove, fs::path{"/watched"} / fileName};
+}
+
+TEST(IgnoredEventsTest, givenRegisteredEventWhenConsumingThenItIsIgnoredOnce) {
+    IgnoredEvents ignoredEvents{};
+    ignoredEvents.add(createRemoveEvent("a"));
+    ignoredEvents.add(createRemoveEvent("a"));
+    EXPECT_EQ(2u, ignoredEvents.size());
+
+    EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("a")));
+    EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("a")));
+    EXPECT_FALSE(ignoredEvents.consume(createRemoveEvent("a")));
+    EXPECT_EQ(0u, ignoredEvents.size());
+}
+
+TEST(IgnoredEventsTest, givenEventDifferentThanRegisteredWhenConsumingThenItIsNotIgnored) {
+    IgnoredEvents ignoredEvents{};
+    ignoredEvents.add(createRemoveEvent("a"));
+
+    EXPECT_FALSE(ignoredEvents.consume(createRemoveEvent("b")));
+    EXPECT_FALSE(ignoredEvents.consume(FileEvent{"/watched", FileEvent::Type::Add, "/watched/a"}));
+    EXPECT_FALSE(ignoredEvents.consume(FileEvent{"/other", FileEvent::Type::Remove, "/watched/a"}));
+    EXPECT_EQ(1u, ignoredEvents.size());
+}
+
+TEST(IgnoredEventsTest, givenRegisteredEventExpiredWhenConsumingThenItIsNotIgnored) {
+    IgnoredEvents ignoredEvents{10s, 100};
+    const auto now = IgnoredEvents::Clock::now();
+    ignoredEvents.add(createRemoveEvent("a"), now);
+    ignoredEvents.add(createRemoveEvent("b"), now + 5s);
+
+    EXPECT_FALSE(ignoredEvents.consume(createRemoveEvent("a"), now + 10s));
+    EXPECT_EQ(1u, ignoredEvents.size());
+    EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("b"), now + 10s));
+}
+
+TEST(IgnoredEventsTest, givenConsumedEventWhenOlderEntryExpiresThenNewerEntryIsStillRegistered) {
+    IgnoredEvents ignoredEvents{10s, 100};
+    const auto now = IgnoredEvents::Clock::now();
+    ignoredEvents.add(createRemoveEvent("a"), now);
+    ignoredEvents.add(createRemoveEvent("a"), now + 5s);
+    EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("a"), now + 1s));
+
+    EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("a"), now + 12s));
+    EXPECT_EQ(0u, ignoredEvents.size());
+}
+
+TEST(IgnoredEventsTest, givenMaxSizeIsReachedWhenAddingEventThenOldestEventIsDropped) {
+    IgnoredEvents ignoredEvents{10s, 2};
+    ignoredEvents.add(createRemoveEvent("a"));
+    ignoredEvents.add(createRemoveEvent("b"));
+    ignoredEvents.add(createRemoveEvent("c"));
+    EXPECT_EQ(2u, ignoredEvents.size());
+
+    EXPECT_FALSE(ignoredEvents.consume(createRemoveEvent("a")));
+    EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("b")));
+    EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("c")));
+}
+
+TEST(IgnoredEventsTest, givenConsumedEventsWhenAddingNewEventsThenConsumedEventsDoNotCountTowardsMaxSize) {
+    IgnoredEvents ignoredEvents{10s, 2};
+    for (int i = 0; i < 10; i++) {
+        ignoredEvents.add(createRemoveEvent("a"));
+        EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("a")));
+    }
+    EXPECT_EQ(0u, ignoredEvents.size());
+
+    ignoredEvents.add(createRemoveEvent("b"));
+    ignoredEvents.add(createRemoveEvent("c"));
+    EXPECT_EQ(2u, ignoredEvents.size());
+    EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("b")));
+    EXPECT_TRUE(ignoredEvents.consume(createRemoveEvent("c")));
+}
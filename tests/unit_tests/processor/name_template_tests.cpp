@@ -0,0 +1,51 @@
+#include "charon/processor/name_template.h"
+#include "charon/util/string_literal.h"
+
+#include <gtest/gtest.h>
+
+TEST(NameTemplateTest, givenPatternWithVariablesWhenRenderingThenSubstituteThem) {
+    const NameTemplate nameTemplate{"${name}_${extension}-${previousName}${name}"};
+    EXPECT_FALSE(nameTemplate.hasCounter());
+
+    PathStringType buffer{};
+    EXPECT_EQ(NameTemplate::StringView::npos, nameTemplate.render(buffer, CSTRING("file"), CSTRING("png"), CSTRING("prev")));
+    EXPECT_EQ(CSTRING("file_png-prevfile"), buffer);
+}
+
+TEST(NameTemplateTest, givenPatternWithCounterWhenRenderingThenReturnCounterPosition) {
+    const NameTemplate nameTemplate{"${name}_###.x"};
+    EXPECT_TRUE(nameTemplate.hasCounter());
+    EXPECT_EQ(3u, nameTemplate.getCounterDigits());
+
+    PathStringType buffer{CSTRING("previous contents")};
+    const size_t counterPosition = nameTemplate.render(buffer, CSTRING("file"), CSTRING(""), CSTRING(""));
+    EXPECT_EQ(5u, counterPosition);
+    EXPECT_EQ(CSTRING("file_000.x"), buffer);
+
+    NameTemplate::writeCounter(buffer.data() + counterPosition, 42, 3);
+    EXPECT_EQ(CSTRING("file_042.x"), buffer);
+}
+
+TEST(NameTemplateTest, givenVariableValuesWithSpecialCharactersWhenRenderingThenTreatThemAsLiterals) {
+    const NameTemplate nameTemplate{"${name}#"};
+
+    PathStringType buffer{};
+    const size_t counterPosition = nameTemplate.render(buffer, CSTRING("a#${extension}"), CSTRING("png"), CSTRING(""));
+    EXPECT_EQ(14u, counterPosition);
+    EXPECT_EQ(CSTRING("a#${extension}0"), buffer);
+}
+
+TEST(NameTemplateTest, givenPatternWithUnknownVariableWhenRenderingThenKeepItAsLiteral) {
+    const NameTemplate nameTemplate{"${unknown}${name"};
+
+    PathStringType buffer{};
+    nameTemplate.render(buffer, CSTRING("file"), CSTRING("png"), CSTRING(""));
+    EXPECT_EQ(CSTRING("${unknown}${name"), buffer);
+}
+
+TEST(NameTemplateTest, givenPathsWhenGettingStemAndExtensionThenBehaveLikeStdFilesystem) {
+    for (const char *path : {"dir/file.png", "file.tar.gz", "dir/.hidden", "dir.x/file", "file.", "dir/..", "."}) {
+        EXPECT_EQ(fs::path{path}.stem().native(), NameTemplate::getStem(path)) << path;
+        EXPECT_EQ(fs::path{path}.extension().native(), NameTemplate::getExtension(path)) << path;
+    }
+}
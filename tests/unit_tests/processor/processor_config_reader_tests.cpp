@@ -104,6 +104,44 @@ TEST(ProcessorConfigReaderBadTypeTest, givenExtensionsMemberIsNotAnArrayWhenRead
     EXPECT_FALSE(reader.read(config, json, ProcessorConfig::Type::Matchers));
 }
 
+TEST(ProcessorConfigReaderBadTypeTest, givenRecursiveMemberIsNotABooleanWhenReadingConfigWithMatchersThenReturnError) {
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log(LogLevel::Error, "Action matcher \"recursive\" member must be a boolean."));
+
+    ProcessConfigReader reader{};
+    ProcessorConfig config{};
+    std::string json = R"(
+        [
+            {
+                "watchedFolder": "D:/Desktop/Test",
+                "recursive": "yes",
+                "actions": []
+            }
+        ]
+    )";
+    EXPECT_FALSE(reader.read(config, json, ProcessorConfig::Type::Matchers));
+}
+
+TEST(ProcessorConfigReaderBadTypeTest, givenScanOnStartupMemberIsNotABooleanWhenReadingConfigWithMatchersThenReturnError) {
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log(LogLevel::Error, "Action matcher \"scanOnStartup\" member must be a boolean."));
+
+    ProcessConfigReader reader{};
+    ProcessorConfig config{};
+    std::string json = R"(
+        [
+            {
+                "watchedFolder": "D:/Desktop/Test",
+                "scanOnStartup": 1,
+                "actions": []
+            }
+        ]
+    )";
+    EXPECT_FALSE(reader.read(config, json, ProcessorConfig::Type::Matchers));
+}
+
 TEST(ProcessorConfigReaderBadTypeTest, givenActionsMemberIsNotAnArrayWhenReadingConfigWithMatchersThenReturnError) {
     MockLogger logger{};
     auto loggerSetup = logger.raiiSetup();
@@ -161,6 +199,58 @@ TEST(ProcessorConfigReaderMissingFieldTest, givenNoExtensionsFieldWhenReadingCon
     EXPECT_EMPTY(config.matchers()->matchers[0].watchedExtensions);
 }
 
+TEST(ProcessorConfigReaderMissingFieldTest, givenNoRecursiveFieldWhenReadingConfigWithMatchersThenReturnSuccessAndNonRecursiveMatcher) {
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log).Times(0);
+
+    ProcessConfigReader reader{};
+    ProcessorConfig config{};
+    std::string json = R"(
+        [
+            {
+                "watchedFolder": "D:/Desktop/Test",
+                "actions": []
+            },
+            {
+                "watchedFolder": "D:/Desktop/Test2",
+                "recursive": true,
+                "actions": []
+            }
+        ]
+    )";
+    ASSERT_TRUE(reader.read(config, json, ProcessorConfig::Type::Matchers));
+    ASSERT_EQ(2u, config.matchers()->matchers.size());
+    EXPECT_FALSE(config.matchers()->matchers[0].recursive);
+    EXPECT_TRUE(config.matchers()->matchers[1].recursive);
+}
+
+TEST(ProcessorConfigReaderMissingFieldTest, givenNoScanOnStartupFieldWhenReadingConfigWithMatchersThenReturnSuccessAndDoNotScan) {
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log).Times(0);
+
+    ProcessConfigReader reader{};
+    ProcessorConfig config{};
+    std::string json = R"(
+        [
+            {
+                "watchedFolder": "D:/Desktop/Test",
+                "actions": []
+            },
+            {
+                "watchedFolder": "D:/Desktop/Test2",
+                "scanOnStartup": true,
+                "actions": []
+            }
+        ]
+    )";
+    ASSERT_TRUE(reader.read(config, json, ProcessorConfig::Type::Matchers));
+    ASSERT_EQ(2u, config.matchers()->matchers.size());
+    EXPECT_FALSE(config.matchers()->matchers[0].scanOnStartup);
+    EXPECT_TRUE(config.matchers()->matchers[1].scanOnStartup);
+}
+
 TEST(ProcessorConfigReaderMissingFieldTest, givenNoActionsFieldWhenReadingConfigWithMatchersThenReturnError) {
     MockLogger logger{};
     auto loggerSetup = logger.raiiSetup();
@@ -544,4 +634,50 @@ TEST(ProcessConfigReaderPositiveTest, givenCopyActionWithCounterStartWithInvalid
     )";
         ASSERT_FALSE(reader.read(config, json, ProcessorConfig::Type::Actions));
     }
-}
\ No newline at end of file
+}
+TEST(ProcessConfigReaderPositiveTest, givenMoveActionWithAtomicFieldWhenReadingConfigWithActionsThenParseCorrectly) {
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log).Times(0);
+
+    ProcessConfigReader reader{};
+    ProcessorConfig config{};
+    std::string json = R"(
+        [
+            {
+                "type": "move",
+                "destinationDir": "D:/Desktop/Dst1",
+                "destinationName": "#.${ext}",
+                "atomic": true
+            },
+            {
+                "type": "copy",
+                "destinationDir": "D:/Desktop/Dst1",
+                "destinationName": "#.${ext}"
+            }
+        ]
+    )";
+    ASSERT_TRUE(reader.read(config, json, ProcessorConfig::Type::Actions));
+    EXPECT_TRUE(std::get<ProcessorAction::MoveOrCopy>(config.actions()->actions[0].data).atomic);
+    EXPECT_FALSE(std::get<ProcessorAction::MoveOrCopy>(config.actions()->actions[1].data).atomic);
+}
+
+TEST(ProcessConfigReaderPositiveTest, givenCopyActionWithAtomicFieldWithInvalidFormatWhenReadingConfigWithActionsThenReturnError) {
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log(LogLevel::Error, "Field \"atomic\" must be a boolean."));
+
+    ProcessConfigReader reader{};
+    ProcessorConfig config{};
+    std::string json = R"(
+        [
+            {
+                "type": "copy",
+                "destinationDir": "D:/Desktop/Dst1",
+                "destinationName": "#.${ext}",
+                "atomic": 1
+            }
+        ]
+    )";
+    ASSERT_FALSE(reader.read(config, json, ProcessorConfig::Type::Actions));
+}
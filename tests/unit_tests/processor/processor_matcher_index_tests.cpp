@@ -0,0 +1,87 @@
+#include "charon/processor/processor_matcher_index.h"
+#include "unit_tests/fixtures/processor_config_fixture.h"
+
+#include <gtest/gtest.h>
+
+struct ProcessorMatcherIndexTest : ::testing::Test, ProcessorConfigFixture {
+    static FileEvent createEvent(const fs::path &watchedDir, const fs::path &path) {
+        return FileEvent{watchedDir, FileEvent::Type::Add, path};
+    }
+};
+
+TEST_F(ProcessorMatcherIndexTest, givenMatchersForDifferentFoldersWhenLookingUpThenReturnMatcherForEventFolder) {
+    ProcessorConfig config = createProcessorConfigWithMatchers({"A", "B"});
+    const ProcessorMatcherIndex index{config};
+    const auto &matchers = config.matchers()->matchers;
+
+    EXPECT_EQ(&matchers[0], index.find(createEvent("A", "A/file.png"), false));
+    EXPECT_EQ(&matchers[1], index.find(createEvent("B", "B/file.png"), false));
+    EXPECT_EQ(nullptr, index.find(createEvent("C", "C/file.png"), false));
+}
+
+TEST_F(ProcessorMatcherIndexTest, givenMatchersWithExtensionsWhenLookingUpThenReturnFirstMatchingMatcher) {
+    ProcessorConfig config = createProcessorConfigWithMatchers({"A", "A", "A", "A"});
+    auto &matchers = config.matchers()->matchers;
+    matchers[0].watchedExtensions = {"png"};
+    matchers[1].watchedExtensions = {"jpg", "png", ""};
+    matchers[3].watchedExtensions = {"mp4"};
+    const ProcessorMatcherIndex index{config};
+
+    EXPECT_EQ(&matchers[0], index.find(createEvent("A", "A/file.png"), false));
+    EXPECT_EQ(&matchers[1], index.find(createEvent("A", "A/file.jpg"), false));
+    EXPECT_EQ(&matchers[1], index.find(createEvent("A", "A/file"), false));
+    EXPECT_EQ(&matchers[2], index.find(createEvent("A", "A/file.mp4"), false));
+    EXPECT_EQ(&matchers[2], index.find(createEvent("A", "A/file.txt"), false));
+}
+
+TEST_F(ProcessorMatcherIndexTest, givenMatcherForAnyExtensionBeforeMatcherForSpecificExtensionWhenLookingUpThenReturnMatcherForAnyExtension) {
+    ProcessorConfig config = createProcessorConfigWithMatchers({"A", "A"});
+    auto &matchers = config.matchers()->matchers;
+    matchers[1].watchedExtensions = {"png"};
+    const ProcessorMatcherIndex index{config};
+
+    EXPECT_EQ(&matchers[0], index.find(createEvent("A", "A/file.png"), false));
+}
+
+TEST_F(ProcessorMatcherIndexTest, givenEventInSubdirectoryWhenLookingUpThenReturnOnlyRecursiveMatchers) {
+    ProcessorConfig config = createProcessorConfigWithMatchers({"A", "A", "A", "A"});
+    auto &matchers = config.matchers()->matchers;
+    matchers[0].watchedExtensions = {"png"};
+    matchers[1].watchedExtensions = {"png"};
+    matchers[1].recursive = true;
+    matchers[3].recursive = true;
+    const ProcessorMatcherIndex index{config};
+
+    EXPECT_EQ(&matchers[0], index.find(createEvent("A", "A/file.png"), false));
+    EXPECT_EQ(&matchers[1], index.find(createEvent("A", "A/sub/file.png"), true));
+    EXPECT_EQ(&matchers[2], index.find(createEvent("A", "A/file.jpg"), false));
+    EXPECT_EQ(&matchers[3], index.find(createEvent("A", "A/sub/file.jpg"), true));
+}
+
+TEST_F(ProcessorMatcherIndexTest, givenConfigWithActionsWhenLookingUpThenReturnNull) {
+    ProcessorConfig config{};
+    config.createActions().actions = {createPrintAction()};
+    const ProcessorMatcherIndex index{config};
+
+    EXPECT_EQ(nullptr, index.find(createEvent("A", "A/file.png"), false));
+}
+
+TEST_F(ProcessorMatcherIndexTest, givenMatchersForDifferentSpellingsOfTheSameFolderWhenLookingUpThenTreatThemAsOneFolder) {
+    ProcessorConfig config = createProcessorConfigWithMatchers({"A/", "A//B/../.", "A"});
+    auto &matchers = config.matchers()->matchers;
+    matchers[0].watchedExtensions = {"png"};
+    const ProcessorMatcherIndex index{config};
+
+    EXPECT_EQ(&matchers[0], index.find(createEvent("A", "A/file.png"), false));
+    EXPECT_EQ(&matchers[1], index.find(createEvent("A", "A/file.jpg"), false));
+    EXPECT_EQ(&matchers[0], index.find(createEvent("A/./", "A/file.png"), false));
+    EXPECT_EQ(&matchers[1], index.find(createEvent("A/B/..", "A/file.jpg"), false));
+}
+
+TEST_F(ProcessorMatcherIndexTest, whenNormalizingWatchedFolderThenRemoveRedundantElementsAndTrailingSeparator) {
+    EXPECT_EQ(fs::path("A").native(), ProcessorMatcherIndex::normalizeWatchedFolder("A"));
+    EXPECT_EQ(fs::path("A").native(), ProcessorMatcherIndex::normalizeWatchedFolder("A/"));
+    EXPECT_EQ(fs::path("A").native(), ProcessorMatcherIndex::normalizeWatchedFolder("./A/B/../"));
+    EXPECT_EQ(fs::path("A/B").make_preferred().native(), ProcessorMatcherIndex::normalizeWatchedFolder("A//B"));
+    EXPECT_EQ(fs::path("/").make_preferred().native(), ProcessorMatcherIndex::normalizeWatchedFolder("/"));
+}
@@ -6,7 +6,9 @@
 #include "unit_tests/mocks/mock_logger.h"
 #include "unit_tests/mocks/mock_os_handle.h"
 
+#include <atomic>
 #include <gtest/gtest.h>
+#include <thread>
 
 using ::testing::_;
 using ::testing::AtLeast;
@@ -206,6 +208,37 @@ TEST_F(ProcessorTest, givenConfigWithMatchersAndCounterUsedAndMultipleGapsInName
     processor.run();
 }
 
+TEST_F(ProcessorTest, givenConfigWithMatchersAndCounterUsedAndDestinationDirectoryIsNotModifiedExternallyWhenCopyActionsAreTriggeredThenListDirectoryOnce) {
+    MockFilesystem filesystem{};
+    const fs::file_time_type directoryWriteTime = fs::file_time_type::clock::now();
+    ON_CALL(filesystem, getLastWriteTime(_)).WillByDefault(Return(std::nullopt));
+    ON_CALL(filesystem, getLastWriteTime(dummyPath2)).WillByDefault(Return(directoryWriteTime));
+    {
+        InSequence seq{};
+        EXPECT_CALL(filesystem, listFiles(dummyPath2))
+            .WillOnce(Return(std::vector<fs::path>{
+                dummyPath2 / "000.jpg",
+                dummyPath2 / "002.jpg",
+                dummyPath2 / "005.jpg",
+            }));
+        EXPECT_CALL(filesystem, copy(dummyPath1 / "a.jpg", dummyPath2 / "001.jpg"));
+        EXPECT_CALL(filesystem, copy(dummyPath1 / "b.jpg", dummyPath2 / "003.jpg"));
+        EXPECT_CALL(filesystem, copy(dummyPath1 / "c.jpg", dummyPath2 / "004.jpg"));
+        EXPECT_CALL(filesystem, copy(dummyPath1 / "d.jpg", dummyPath2 / "006.jpg"));
+    }
+
+    ProcessorConfig config = createProcessorConfigWithOneMatcher(dummyPath1);
+    config.matchers()->matchers[0].actions = {createCopyAction(dummyPath2, "###")};
+    Processor processor{config, eventQueue, filesystem};
+
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "a.jpg");
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "b.jpg");
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "c.jpg");
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "d.jpg");
+    pushInterruptEvent();
+    processor.run();
+}
+
 TEST_F(ProcessorTest, givenConfigWithMatchersAndCounterUsedAndMultipleGapsInNamesWithDifferentExtensionsWhenCopyActionsAreTriggeredThenFillGaps) {
     MockFilesystem filesystem{};
     {
@@ -397,6 +430,25 @@ TEST_F(ProcessorTest, givenConfigWithMatchersAndMultipleActionMatchersWhenEventI
     processor.run();
 }
 
+TEST_F(ProcessorTest, givenScannedFilesWhenMatchedMatcherDidNotRequestStartupScanThenSkipThem) {
+    MockFilesystem filesystem{};
+    EXPECT_CALL(filesystem, copy(dummyPath1 / "a.jpg", dummyPath2 / "scanned.jpg"));
+    EXPECT_CALL(filesystem, copy(dummyPath1 / "b.png", dummyPath2 / "image.png"));
+
+    ProcessorConfig config = createProcessorConfigWithMatchers({dummyPath1, dummyPath1});
+    config.matchers()->matchers[0].actions = {createCopyAction(dummyPath2, "image")};
+    config.matchers()->matchers[0].watchedExtensions = {"png"};
+    config.matchers()->matchers[1].actions = {createCopyAction(dummyPath2, "scanned")};
+    config.matchers()->matchers[1].scanOnStartup = true;
+    Processor processor{config, eventQueue, filesystem};
+
+    eventQueue.push(FileEvent{dummyPath1, FileEvent::Type::Add, dummyPath1 / "a.png", defaultOsHandle, true});
+    eventQueue.push(FileEvent{dummyPath1, FileEvent::Type::Add, dummyPath1 / "a.jpg", defaultOsHandle, true});
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "b.png");
+    pushInterruptEvent();
+    processor.run();
+}
+
 TEST_F(ProcessorTest, givenConfigWithMatchersAndExtensionFiltersNotSatisfiedWhenEventIsTriggeredThenSkipIt) {
     MockFilesystem filesystem{};
     EXPECT_CALL(filesystem, copy(dummyPath1 / "a.jpg", dummyPath2 / "b.jpg"));
@@ -439,6 +491,25 @@ TEST_F(ProcessorTest, givenConfigWithMatchersAndMultipleActionMatchersExtensionF
     processor.run();
 }
 
+TEST_F(ProcessorTest, givenConfigWithMatchersAndEventFromSubdirectoryWhenEventIsTriggeredThenSelectOnlyRecursiveMatchers) {
+    MockFilesystem filesystem{};
+    EXPECT_CALL(filesystem, copy(dummyPath1 / "a.jpg", dummyPath2 / "direct.jpg"));
+    EXPECT_CALL(filesystem, copy(dummyPath1 / "sub" / "a.jpg", dummyPath2 / "nested.jpg"));
+    EXPECT_CALL(filesystem, copy(dummyPath1 / "sub" / "sub2" / "a.jpg", dummyPath2 / "nested.jpg"));
+
+    ProcessorConfig config = createProcessorConfigWithMatchers({dummyPath1, dummyPath1});
+    config.matchers()->matchers[0].actions = {createCopyAction(dummyPath2, "direct")};
+    config.matchers()->matchers[1].actions = {createCopyAction(dummyPath2, "nested")};
+    config.matchers()->matchers[1].recursive = true;
+    Processor processor{config, eventQueue, filesystem};
+
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "a.jpg");
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "sub" / "a.jpg");
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "sub" / "sub2" / "a.jpg");
+    pushInterruptEvent();
+    processor.run();
+}
+
 TEST_F(ProcessorTest, givenConfigWithMatchersWhenMoveActionIsExecutedThenLogInfo) {
     MockFilesystem filesystem{false};
     MockLogger logger{};
@@ -696,16 +767,15 @@ INSTANTIATE_TEST_SUITE_P(
     ProcessorTestWithDifferentEventsAndActions,
     ::testing::Combine(nonNewFileEvents, nonFilesystemActions, executeAction));
 
-TEST_F(ProcessorTest, givenCrossDeviceLinkErrorWhenMoveOperationIsTriggerredThenFallbackToCopyPlusRemove) {
+TEST_F(ProcessorTest, givenCrossDeviceLinkErrorWhenMoveOperationIsTriggerredThenFallbackToMoveAcrossDevices) {
     MockFilesystem filesystem{};
     EXPECT_CALL(filesystem, move(fs::path("a/src"), fs::path("b/dst"))).WillOnce(Return(std::make_error_code(std::errc::cross_device_link)));
-    EXPECT_CALL(filesystem, copy(fs::path("a/src"), fs::path("b/dst")));
-    EXPECT_CALL(filesystem, remove(fs::path("a/src")));
+    EXPECT_CALL(filesystem, moveAcrossDevices(fs::path("a/src"), fs::path("b/dst")));
 
     MockLogger logger{};
     auto loggerSetup = logger.raiiSetup();
     EXPECT_CALL(logger, log(LogLevel::Info, "Processor moving file a/src to b/dst"));
-    EXPECT_CALL(logger, log(LogLevel::Info, "Move operation had to be emulated with copy+remove."));
+    EXPECT_CALL(logger, log(LogLevel::Info, "Move operation had to be performed across devices."));
     EXPECT_CALL(logger, log(LogLevel::VerboseInfo, "Operation succeeded"));
 
     ProcessorConfig config = createProcessorConfigWithOneMatcher("a");
@@ -717,16 +787,17 @@ TEST_F(ProcessorTest, givenCrossDeviceLinkErrorWhenMoveOperationIsTriggerredThen
     processor.run();
 }
 
-TEST_F(ProcessorTest, givenCopyOperationFailsWhenPerformingCopyPlusRemoveFallbackThenReportError) {
-    const std::error_code err = std::make_error_code(std::errc::illegal_byte_sequence);
+TEST_F(ProcessorTest, givenMoveAcrossDevicesFailsWhenPerformingCrossDeviceFallbackThenReportError) {
+    const std::error_code err = std::make_error_code(std::errc::no_space_on_device);
 
     MockFilesystem filesystem{};
     EXPECT_CALL(filesystem, move(fs::path("a/src"), fs::path("b/dst"))).WillOnce(Return(std::make_error_code(std::errc::cross_device_link)));
-    EXPECT_CALL(filesystem, copy(fs::path("a/src"), fs::path("b/dst"))).WillOnce(Return(err));
+    EXPECT_CALL(filesystem, moveAcrossDevices(fs::path("a/src"), fs::path("b/dst"))).WillOnce(Return(err));
 
     MockLogger logger{};
     auto loggerSetup = logger.raiiSetup();
     EXPECT_CALL(logger, log(LogLevel::Info, "Processor moving file a/src to b/dst"));
+    EXPECT_CALL(logger, log(LogLevel::Error, "Move operation across devices failed"));
     std::ostringstream errorStringStream{};
     errorStringStream << "Filesystem operation returned code " << err.value() << ": " << err.message();
     EXPECT_CALL(logger, log(LogLevel::Error, errorStringStream.str().c_str()));
@@ -740,27 +811,79 @@ TEST_F(ProcessorTest, givenCopyOperationFailsWhenPerformingCopyPlusRemoveFallbac
     processor.run();
 }
 
-TEST_F(ProcessorTest, givenRemoveOperationFailsWhenPerformingCopyPlusRemoveFallbackThenReportError) {
-    const std::error_code err = std::make_error_code(std::errc::permission_denied);
+TEST_F(ProcessorTest, givenAtomicActionsWhenProcessorIsRunningThenRequestAtomicOperations) {
+    MockFilesystem filesystem{};
+    {
+        InSequence seq{};
+        EXPECT_CALL(filesystem, copyAtomically(dummyPath1 / "b.jpg", dummyPath2 / "aaa.jpg"));
+        EXPECT_CALL(filesystem, moveAtomically(dummyPath1 / "b.jpg", dummyPath2 / "bbb.jpg"));
+    }
+
+    ProcessorConfig config = createProcessorConfigWithActions({
+        createCopyAction(dummyPath2, "aaa"),
+        createMoveAction(dummyPath2, "bbb"),
+    });
+    for (ProcessorAction &action : config.actions()->actions) {
+        std::get<ProcessorAction::MoveOrCopy>(action.data).atomic = true;
+    }
+    Processor processor{config, eventQueue, filesystem};
+
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "b.jpg");
+    pushInterruptEvent();
+    processor.run();
+}
 
+TEST_F(ProcessorTest, givenAtomicActionWithCounterAndResolvedNameIsTakenInTheMeantimeWhenProcessorIsRunningThenRetryWithNextCounter) {
     MockFilesystem filesystem{};
-    EXPECT_CALL(filesystem, move(fs::path("a/src"), fs::path("b/dst"))).WillOnce(Return(std::make_error_code(std::errc::cross_device_link)));
-    EXPECT_CALL(filesystem, copy(fs::path("a/src"), fs::path("b/dst")));
-    EXPECT_CALL(filesystem, remove(fs::path("a/src"))).WillOnce(Return(err));
+    ON_CALL(filesystem, getLastWriteTime(_)).WillByDefault(Return(std::nullopt));
+    ON_CALL(filesystem, getLastWriteTime(dummyPath2)).WillByDefault(Return(fs::file_time_type::clock::now()));
+    {
+        InSequence seq{};
+        EXPECT_CALL(filesystem, listFiles(dummyPath2))
+            .WillOnce(Return(std::vector<fs::path>{dummyPath2 / "000.jpg"}));
+        EXPECT_CALL(filesystem, copyAtomically(dummyPath1 / "b.jpg", dummyPath2 / "001.jpg"))
+            .WillOnce(Return(std::make_error_code(std::errc::file_exists)));
+        EXPECT_CALL(filesystem, copyAtomically(dummyPath1 / "b.jpg", dummyPath2 / "002.jpg"))
+            .WillOnce(Return(std::make_error_code(std::errc::file_exists)));
+        EXPECT_CALL(filesystem, copyAtomically(dummyPath1 / "b.jpg", dummyPath2 / "003.jpg"));
+    }
 
     MockLogger logger{};
     auto loggerSetup = logger.raiiSetup();
-    EXPECT_CALL(logger, log(LogLevel::Info, "Processor moving file a/src to b/dst"));
-    EXPECT_CALL(logger, log(LogLevel::Error, "Move operation had to be emulated with copy+remove. Remove operation failed"));
+    EXPECT_CALL(logger, log(LogLevel::Info, "Processor copying file " + (dummyPath1 / "b.jpg").string() + " to " + (dummyPath2 / "001.jpg").string()));
+    EXPECT_CALL(logger, log(LogLevel::Info, "Destination file already exists. Processor copying file " + (dummyPath1 / "b.jpg").string() + " to " + (dummyPath2 / "002.jpg").string()));
+    EXPECT_CALL(logger, log(LogLevel::Info, "Destination file already exists. Processor copying file " + (dummyPath1 / "b.jpg").string() + " to " + (dummyPath2 / "003.jpg").string()));
+    EXPECT_CALL(logger, log(LogLevel::VerboseInfo, "Operation succeeded"));
+
+    ProcessorConfig config = createProcessorConfigWithOneMatcher(dummyPath1);
+    config.matchers()->matchers[0].actions = {createCopyAction(dummyPath2, "###")};
+    std::get<ProcessorAction::MoveOrCopy>(config.matchers()->matchers[0].actions[0].data).atomic = true;
+    Processor processor{config, eventQueue, filesystem};
+
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "b.jpg");
+    pushInterruptEvent();
+    processor.run();
+}
+
+TEST_F(ProcessorTest, givenAtomicActionWithoutCounterAndDestinationExistsWhenProcessorIsRunningThenReportError) {
+    const std::error_code err = std::make_error_code(std::errc::file_exists);
+
+    MockFilesystem filesystem{};
+    EXPECT_CALL(filesystem, moveAtomically(dummyPath1 / "b.jpg", dummyPath2 / "aaa.jpg")).WillOnce(Return(err));
+
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log(LogLevel::Info, "Processor moving file " + (dummyPath1 / "b.jpg").string() + " to " + (dummyPath2 / "aaa.jpg").string()));
     std::ostringstream errorStringStream{};
     errorStringStream << "Filesystem operation returned code " << err.value() << ": " << err.message();
     EXPECT_CALL(logger, log(LogLevel::Error, errorStringStream.str().c_str()));
 
-    ProcessorConfig config = createProcessorConfigWithOneMatcher("a");
-    config.matchers()->matchers[0].actions = {createMoveAction("b", "dst")};
+    ProcessorConfig config = createProcessorConfigWithOneMatcher(dummyPath1);
+    config.matchers()->matchers[0].actions = {createMoveAction(dummyPath2, "aaa")};
+    std::get<ProcessorAction::MoveOrCopy>(config.matchers()->matchers[0].actions[0].data).atomic = true;
     Processor processor{config, eventQueue, filesystem};
 
-    pushFileCreationEvent("a", "a/src");
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "b.jpg");
     pushInterruptEvent();
     processor.run();
 }
@@ -784,3 +907,81 @@ TEST_F(ProcessorTest, givenConfigWithMultipleActionsWhenProcessorIsRunningThenPe
     pushInterruptEvent();
     processor.run();
 }
+
+TEST_F(ProcessorTest, givenFilesystemExecutorWhenEventsForDifferentFilesArePushedThenPerformAllActionsInOrderForEachFile) {
+    MockFilesystem filesystem{};
+    ::testing::Sequence firstFileSequence{};
+    ::testing::Sequence secondFileSequence{};
+    EXPECT_CALL(filesystem, copy(dummyPath1 / "a.jpg", dummyPath2 / "a_copy.jpg")).InSequence(firstFileSequence);
+    EXPECT_CALL(filesystem, move(dummyPath1 / "a.jpg", dummyPath2 / "a_moved.jpg")).InSequence(firstFileSequence);
+    EXPECT_CALL(filesystem, copy(dummyPath1 / "b.jpg", dummyPath2 / "b_copy.jpg")).InSequence(secondFileSequence);
+    EXPECT_CALL(filesystem, move(dummyPath1 / "b.jpg", dummyPath2 / "b_moved.jpg")).InSequence(secondFileSequence);
+
+    ProcessorConfig config = createProcessorConfigWithOneMatcher(dummyPath1);
+    config.matchers()->matchers[0].actions = {
+        createCopyAction(dummyPath2, "${name}_copy"),
+        createMoveAction(dummyPath2, "${name}_moved"),
+    };
+    ThreadPoolFilesystemExecutor filesystemExecutor{filesystem, 2};
+    Processor processor{config, eventQueue, filesystem};
+    processor.setFilesystemExecutor(&filesystemExecutor, 4);
+
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "a.jpg");
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "b.jpg");
+    pushInterruptEvent();
+    processor.run();
+}
+
+TEST_F(ProcessorTest, givenFilesystemExecutorWhenMultipleEventsForTheSameFileArePushedThenDoNotExecuteThemConcurrently) {
+    std::atomic_int operationsInFlight = 0;
+    std::atomic_int maxOperationsInFlight = 0;
+    auto copy = [&](const fs::path &, const fs::path &) -> OptionalError {
+        const int current = ++operationsInFlight;
+        maxOperationsInFlight = std::max(maxOperationsInFlight.load(), current);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        operationsInFlight--;
+        return {};
+    };
+
+    MockFilesystem filesystem{};
+    EXPECT_CALL(filesystem, copy(dummyPath1 / "b.jpg", dummyPath2 / "aaa.jpg")).Times(3).WillRepeatedly(copy);
+
+    ProcessorConfig config = createProcessorConfigWithOneMatcher(dummyPath1);
+    config.matchers()->matchers[0].actions = {createCopyAction(dummyPath2, "aaa")};
+    ThreadPoolFilesystemExecutor filesystemExecutor{filesystem, 3};
+    Processor processor{config, eventQueue, filesystem};
+    processor.setFilesystemExecutor(&filesystemExecutor, 3);
+
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "b.jpg");
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "b.jpg");
+    pushFileCreationEvent(dummyPath1, dummyPath1 / "b.jpg");
+    pushInterruptEvent();
+    processor.run();
+
+    EXPECT_EQ(1, maxOperationsInFlight);
+}
+
+TEST_F(ProcessorTest, givenFilesystemExecutorAndCrossDeviceLinkErrorWhenMoveOperationIsTriggerredThenFallbackToMoveAcrossDevices) {
+    MockFilesystem filesystem{};
+    {
+        InSequence seq{};
+        EXPECT_CALL(filesystem, move(fs::path("a/src"), fs::path("b/dst"))).WillOnce(Return(std::make_error_code(std::errc::cross_device_link)));
+        EXPECT_CALL(filesystem, moveAcrossDevices(fs::path("a/src"), fs::path("b/dst")));
+    }
+
+    MockLogger logger{};
+    auto loggerSetup = logger.raiiSetup();
+    EXPECT_CALL(logger, log(LogLevel::Info, "Processor moving file a/src to b/dst"));
+    EXPECT_CALL(logger, log(LogLevel::Info, "Move operation had to be performed across devices."));
+    EXPECT_CALL(logger, log(LogLevel::VerboseInfo, "Operation succeeded"));
+
+    ProcessorConfig config = createProcessorConfigWithOneMatcher("a");
+    config.matchers()->matchers[0].actions = {createMoveAction("b", "dst")};
+    ThreadPoolFilesystemExecutor filesystemExecutor{filesystem, 1};
+    Processor processor{config, eventQueue, filesystem};
+    processor.setFilesystemExecutor(&filesystemExecutor, 1);
+
+    pushFileCreationEvent("a", "a/src");
+    pushInterruptEvent();
+    processor.run();
+}
@@ -0,0 +1,98 @@
+#include "charon/util/async_logger.h"
+#include "unit_tests/mocks/mock_logger.h"
+
+#include <atomic>
+#include <future>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using ::testing::InSequence;
+
+struct CountingLogger : Logger {
+    void log(LogLevel, const std::string &) override { messagesCount++; }
+    void flush() override { flushesCount++; }
+    std::atomic_size_t messagesCount = 0u;
+    std::atomic_size_t flushesCount = 0u;
+};
+
+TEST(AsyncLoggerTest, whenMessagesAreLoggedThenPassThemToTargetLoggerInOrder) {
+    MockLogger target{};
+    {
+        InSequence sequence{};
+        EXPECT_CALL(target, log(LogLevel::Info, "1"));
+        EXPECT_CALL(target, log(LogLevel::Error, "2 abc"));
+        EXPECT_CALL(target, log(LogLevel::Warning, "3"));
+    }
+
+    AsyncLogger logger{target, 16, AsyncLogger::OverflowPolicy::Block};
+    EXPECT_TRUE(logger.isThreadSafe());
+    log(LogLevel::Info, &logger) << 1;
+    log(LogLevel::Error, &logger) << 2 << " abc";
+    logger.log(LogLevel::Warning, "3");
+    logger.flush();
+    EXPECT_EQ(0u, logger.getDroppedMessagesCount());
+}
+
+TEST(AsyncLoggerTest, whenLoggerIsDestroyedThenWriteAllMessagesAndFlushTargetLogger) {
+    CountingLogger target{};
+    {
+        AsyncLogger logger{target, 1024, AsyncLogger::OverflowPolicy::Block};
+        for (int i = 0; i < 1000; i++) {
+            log(LogLevel::Info, &logger) << "message " << i;
+        }
+    }
+    EXPECT_EQ(1000u, target.messagesCount.load());
+    EXPECT_LE(1u, target.flushesCount.load());
+}
+
+TEST(AsyncLoggerTest, givenBlockPolicyAndManyThreadsWhenQueueIsFullThenDoNotLoseAnyMessages) {
+    CountingLogger target{};
+    AsyncLogger logger{target, 4, AsyncLogger::OverflowPolicy::Block};
+
+    std::vector<std::thread> threads{};
+    for (int threadIndex = 0; threadIndex < 4; threadIndex++) {
+        threads.emplace_back([&logger, threadIndex]() {
+            for (int i = 0; i < 1000; i++) {
+                log(LogLevel::Info, &logger) << "thread " << threadIndex << " message " << i;
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    logger.flush();
+    EXPECT_EQ(4000u, target.messagesCount.load());
+    EXPECT_EQ(0u, logger.getDroppedMessagesCount());
+}
+
+TEST(AsyncLoggerTest, givenDropPolicyWhenQueueIsFullThenDropNewMessagesAndReportThem) {
+    std::promise<void> firstMessageWriting{};
+    std::promise<void> firstMessageUnblocked{};
+    std::shared_future<void> unblocked = firstMessageUnblocked.get_future().share();
+
+    MockLogger target{};
+    {
+        InSequence sequence{};
+        EXPECT_CALL(target, log(LogLevel::Info, "1")).WillOnce([&](LogLevel, const std::string &) {
+            firstMessageWriting.set_value();
+            unblocked.wait();
+        });
+        EXPECT_CALL(target, log(LogLevel::Info, "2"));
+        EXPECT_CALL(target, log(LogLevel::Warning, "Dropped 2 log messages, because the log queue was full."));
+    }
+
+    AsyncLogger logger{target, 2, AsyncLogger::OverflowPolicy::Drop};
+    logger.log(LogLevel::Info, "1");
+    firstMessageWriting.get_future().wait();
+
+    // First message still occupies its slot, so there is room only for one more
+    logger.log(LogLevel::Info, "2");
+    logger.log(LogLevel::Info, "3");
+    logger.log(LogLevel::Info, "4");
+    EXPECT_EQ(2u, logger.getDroppedMessagesCount());
+
+    firstMessageUnblocked.set_value();
+    logger.flush();
+}
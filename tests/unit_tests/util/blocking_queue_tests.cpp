@@ -0,0 +1,44 @@
+#include "charon/util/blocking_queue.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(BlockingQueueTest, givenBatchOfValuesWhenPushedThenValuesArePoppedInOrderAndBatchIsCleared) {
+    BlockingQueue<int> queue{};
+    std::vector<int> batch{1, 2, 3};
+    queue.pushBatch(batch);
+    EXPECT_TRUE(batch.empty());
+
+    int value{};
+    for (int expectedValue : {1, 2, 3}) {
+        EXPECT_TRUE(queue.nonBlockingPop(value));
+        EXPECT_EQ(expectedValue, value);
+    }
+    EXPECT_FALSE(queue.nonBlockingPop(value));
+}
+
+TEST(BlockingQueueTest, givenEmptyBatchWhenPushedThenQueueRemainsEmpty) {
+    BlockingQueue<int> queue{};
+    std::vector<int> batch{};
+    queue.pushBatch(batch);
+
+    int value{};
+    EXPECT_FALSE(queue.blockingPop(value, 1ms));
+}
+
+TEST(BlockingQueueTest, givenConsumerWaitingWhenBatchIsPushedThenConsumerIsWokenUp) {
+    BlockingQueue<int> queue{};
+    int value{};
+    bool popped = false;
+    std::thread consumer{[&]() {
+        popped = queue.blockingPop(value, 10s);
+    }};
+
+    std::vector<int> batch{4, 5};
+    queue.pushBatch(batch);
+    consumer.join();
+    EXPECT_TRUE(popped);
+    EXPECT_EQ(4, value);
+}
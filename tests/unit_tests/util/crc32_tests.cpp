@@ -0,0 +1,29 @@
+#include "charon/util/crc32.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(Crc32Test, givenEmptyDataWhenComputingCrcThenReturnZero) {
+    EXPECT_EQ(0u, updateCrc32(0, nullptr, 0));
+}
+
+TEST(Crc32Test, givenCheckStringWhenComputingCrcThenReturnStandardCheckValue) {
+    const std::string data = "123456789";
+    EXPECT_EQ(0xCBF43926u, updateCrc32(0, data.data(), data.size()));
+}
+
+TEST(Crc32Test, givenDataSplitIntoChunksWhenComputingCrcThenResultIsTheSameAsForWholeData) {
+    std::string data{};
+    for (int i = 0; i < 1000; i++) {
+        data.push_back(static_cast<char>(i * 7));
+    }
+    const uint32_t expectedCrc = updateCrc32(0, data.data(), data.size());
+
+    for (size_t chunkSize : {1u, 3u, 4u, 5u, 64u, 999u}) {
+        uint32_t crc = 0;
+        for (size_t offset = 0; offset < data.size(); offset += chunkSize) {
+            crc = updateCrc32(crc, data.data() + offset, std::min(chunkSize, data.size() - offset));
+        }
+        EXPECT_EQ(expectedCrc, crc) << "chunkSize=" << chunkSize;
+    }
+}
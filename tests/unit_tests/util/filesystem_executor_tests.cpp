@@ -0,0 +1,46 @@
+#include "charon/util/filesystem_executor.h"
+#include "unit_tests/mocks/mock_filesystem.h"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+using ::testing::Return;
+
+TEST(ThreadPoolFilesystemExecutorTest, givenSubmittedOperationsWhenReapingThenCallCompletionsWithResults) {
+    const std::error_code error = std::make_error_code(std::errc::permission_denied);
+    MockFilesystem filesystem{};
+    EXPECT_CALL(filesystem, copy(fs::path("a"), fs::path("b")));
+    EXPECT_CALL(filesystem, remove(fs::path("c"))).WillOnce(Return(error));
+
+    ThreadPoolFilesystemExecutor executor{filesystem, 2};
+    OptionalError copyResult = std::make_error_code(std::errc::io_error);
+    OptionalError removeResult{};
+    executor.submit(FilesystemOperation{FilesystemOperation::Type::Copy, "a", "b"}, [&](const OptionalError &result) { copyResult = result; });
+    executor.submit(FilesystemOperation{FilesystemOperation::Type::Remove, "c", {}}, [&](const OptionalError &result) { removeResult = result; });
+    EXPECT_EQ(2u, executor.getOperationsInFlightCount());
+
+    while (executor.getOperationsInFlightCount() > 0) {
+        executor.reap(10ms);
+    }
+    EXPECT_FALSE(copyResult.has_value());
+    EXPECT_EQ(error, removeResult);
+}
+
+TEST(ThreadPoolFilesystemExecutorTest, givenCompletionSubmittingNewOperationWhenReapingThenExecuteTheNewOperation) {
+    MockFilesystem filesystem{};
+    EXPECT_CALL(filesystem, move(fs::path("a"), fs::path("b"))).WillOnce(Return(std::make_error_code(std::errc::cross_device_link)));
+    EXPECT_CALL(filesystem, moveAcrossDevices(fs::path("a"), fs::path("b")));
+
+    ThreadPoolFilesystemExecutor executor{filesystem, 1};
+    bool fallbackCompleted = false;
+    executor.submit(FilesystemOperation{FilesystemOperation::Type::Move, "a", "b"}, [&](const OptionalError &) {
+        executor.submit(FilesystemOperation{FilesystemOperation::Type::MoveAcrossDevices, "a", "b"}, [&](const OptionalError &result) {
+            fallbackCompleted = !result.has_value();
+        });
+    });
+
+    while (executor.getOperationsInFlightCount() > 0) {
+        executor.reap(10ms);
+    }
+    EXPECT_TRUE(fallbackCompleted);
+}
@@ -0,0 +1,92 @@
+#include "charon/util/lock_free_queue.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(LockFreeQueueTest, givenPushedValuesWhenPoppingThenReturnThemInOrder) {
+    LockFreeQueue<int> queue{};
+    queue.push(1);
+    queue.push(2);
+    std::vector<int> batch{3, 4};
+    queue.pushBatch(batch);
+    EXPECT_TRUE(batch.empty());
+    EXPECT_EQ(4u, queue.size());
+
+    int value{};
+    for (int expectedValue : {1, 2, 3, 4}) {
+        EXPECT_TRUE(queue.nonBlockingPop(value));
+        EXPECT_EQ(expectedValue, value);
+    }
+    EXPECT_FALSE(queue.nonBlockingPop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(LockFreeQueueTest, givenEmptyQueueWhenBlockingPopWithTimeoutIsCalledThenReturnFalse) {
+    LockFreeQueue<int> queue{};
+    int value{};
+    EXPECT_FALSE(queue.blockingPop(value, 1ms));
+}
+
+TEST(LockFreeQueueTest, givenBlockingPopIsInterruptedThenReturnFalseOnce) {
+    LockFreeQueue<int> queue{};
+    int value{};
+    bool popResult = true;
+    std::thread consumer{[&]() {
+        popResult = queue.blockingPop(value);
+    }};
+    queue.interruptBlockingPop();
+    consumer.join();
+    EXPECT_FALSE(popResult);
+
+    queue.push(5);
+    EXPECT_TRUE(queue.blockingPop(value, 1ms));
+    EXPECT_EQ(5, value);
+}
+
+TEST(LockFreeQueueTest, givenQueueIsFullWhenPushingThenWaitForConsumer) {
+    LockFreeQueue<int> queue{4};
+    constexpr int valuesCount = 1000;
+    std::thread producer{[&]() {
+        for (int i = 0; i < valuesCount; i++) {
+            queue.push(i);
+        }
+    }};
+
+    int value{};
+    for (int i = 0; i < valuesCount; i++) {
+        ASSERT_TRUE(queue.blockingPop(value, 10s));
+        EXPECT_EQ(i, value);
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(LockFreeQueueTest, givenMultipleProducersWhenPushingThenConsumerReceivesAllValuesInPerProducerOrder) {
+    LockFreeQueue<int> queue{64};
+    constexpr int producersCount = 4;
+    constexpr int valuesPerProducer = 10000;
+
+    std::vector<std::thread> producers{};
+    for (int producerIndex = 0; producerIndex < producersCount; producerIndex++) {
+        producers.emplace_back([&queue, producerIndex]() {
+            for (int i = 0; i < valuesPerProducer; i++) {
+                queue.push(producerIndex * valuesPerProducer + i);
+            }
+        });
+    }
+
+    std::vector<int> lastValues(producersCount, -1);
+    int value{};
+    for (int i = 0; i < producersCount * valuesPerProducer; i++) {
+        ASSERT_TRUE(queue.blockingPop(value, 10s));
+        const int producerIndex = value / valuesPerProducer;
+        EXPECT_LT(lastValues[producerIndex], value);
+        lastValues[producerIndex] = value;
+    }
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+    EXPECT_FALSE(queue.nonBlockingPop(value));
+}
@@ -0,0 +1,98 @@
+#include "charon/util/logger.h"
+#include "unit_tests/mocks/mock_logger.h"
+
+#include <gtest/gtest.h>
+
+struct RecordingLogger : Logger {
+    void log(LogLevel, const std::string &message) override { texts.push_back(message); }
+    void logRecord(LogLevel, const LogRecord &record) override {
+        records.emplace_back();
+        records.back().assign(record);
+    }
+    bool acceptsRecords() const override { return true; }
+
+    std::vector<std::string> texts = {};
+    std::vector<LogRecord> records = {};
+};
+
+TEST(LogRecordTest, givenLoggerAcceptingRecordsWhenRaiiLogIsCalledThenPassRecordWithLiteralsInFormat) {
+    RecordingLogger logger{};
+    const std::string string = "abc";
+    const char *cString = "def";
+    log(LogLevel::Info, &logger) << "Value " << 5 << " and " << string << cString;
+
+    ASSERT_EQ(1u, logger.records.size());
+    EXPECT_TRUE(logger.texts.empty());
+    const LogRecord &record = logger.records[0];
+    const std::string expectedFormat = std::string{"Value "} + LogRecord::argumentPlaceholder + " and " + LogRecord::argumentPlaceholder + LogRecord::argumentPlaceholder;
+    EXPECT_EQ(expectedFormat, record.getFormat());
+    EXPECT_EQ("Value 5 and abcdef", record.getText());
+    EXPECT_NE(0, record.getTimestamp());
+}
+
+TEST(LogRecordTest, givenVariousArgumentTypesWhenRecordIsRenderedThenTextIsTheSameAsFormattedByStream) {
+    RecordingLogger logger{};
+    MockLogger textLogger{};
+
+    const auto logBoth = [&](auto... args) {
+        auto recordLog = log(LogLevel::Info, &logger);
+        auto textLog = log(LogLevel::Info, &textLogger);
+        ((recordLog << args), ...);
+        ((textLog << args), ...);
+    };
+
+    std::vector<std::string> texts{};
+    EXPECT_CALL(textLogger, log).WillRepeatedly([&](LogLevel, const std::string &message) { texts.push_back(message); });
+    logBoth(-17, 42u, uint64_t{18446744073709551615ull}, int64_t{-9223372036854775807ll});
+    logBoth(1.5, 0.1f, 123456789.0, true, 'x');
+    logBoth(fs::path{"dir/file.txt"}, std::string{}, "");
+    logBoth("crc32=", std::hex, 255u, " ", 3.14159265);
+
+    ASSERT_EQ(4u, logger.records.size());
+    ASSERT_EQ(4u, texts.size());
+    for (size_t i = 0; i < texts.size(); i++) {
+        EXPECT_EQ(texts[i], logger.records[i].getText());
+    }
+    EXPECT_EQ("crc32=ff 3.14159", texts[3]);
+}
+
+TEST(LogRecordTest, givenSameFormatWhenRecordsAreCreatedThenTheirFormatIdsAreEqual) {
+    RecordingLogger logger{};
+    for (int i = 0; i < 2; i++) {
+        log(LogLevel::Info, &logger) << "File " << fs::path{"a"} << " has been created";
+    }
+    log(LogLevel::Info, &logger) << "File " << fs::path{"a"} << " has been removed";
+
+    ASSERT_EQ(3u, logger.records.size());
+    EXPECT_EQ(logger.records[0].getFormatId(), logger.records[1].getFormatId());
+    EXPECT_NE(logger.records[0].getFormatId(), logger.records[2].getFormatId());
+}
+
+TEST(LogRecordTest, givenMultiplexedLoggerWithRecordAndTextLoggersWhenLoggingThenEachGetsItsForm) {
+    RecordingLogger recordLogger{};
+    MockLogger textLogger{};
+    EXPECT_CALL(textLogger, log(LogLevel::Error, "message 1"));
+
+    MultiplexedLogger logger{&textLogger};
+    EXPECT_FALSE(logger.acceptsRecords());
+    logger.add(&recordLogger);
+    EXPECT_TRUE(logger.acceptsRecords());
+
+    log(LogLevel::Error, &logger) << "message " << 1;
+    ASSERT_EQ(1u, recordLogger.records.size());
+    EXPECT_EQ("message 1", recordLogger.records[0].getText());
+}
+
+TEST(LogRecordTest, givenMalformedArgumentsWhenRenderingThenReturnFalse) {
+    LogRecord record{};
+    record.appendFormat("a", 1);
+    record.appendSigned(5);
+    const std::string &arguments = record.getArguments();
+
+    std::string text{};
+    EXPECT_TRUE(LogRecord::render(record.getFormat(), arguments.data(), arguments.size(), text));
+    EXPECT_EQ("a5", text);
+    EXPECT_FALSE(LogRecord::render(record.getFormat(), arguments.data(), arguments.size() - 1, text));
+    EXPECT_FALSE(LogRecord::render(record.getFormat() + LogRecord::argumentPlaceholder, arguments.data(), arguments.size(), text));
+    EXPECT_FALSE(LogRecord::render("a", arguments.data(), arguments.size(), text));
+}
@@ -11,7 +11,9 @@ TEST(LoggerTest, givenVariousLogLevelsWhenRaiiLogIsCalledThenPrependTheLogWithLo
     EXPECT_CALL(logger, log(LogLevel::Error, "a 1"));
     EXPECT_CALL(logger, log(LogLevel::Info, "b 1"));
     EXPECT_CALL(logger, log(LogLevel::Warning, "c 1"));
-    EXPECT_CALL(logger, log(LogLevel::Debug, "d 1"));
+    if ((LogLevel::Debug & compiledLogLevels) != LogLevel(0)) {
+        EXPECT_CALL(logger, log(LogLevel::Debug, "d 1"));
+    }
 
     log(LogLevel::Error, &logger) << "a " << 1;
     log(LogLevel::Info, &logger) << "b " << 1;
@@ -19,6 +21,62 @@ TEST(LoggerTest, givenVariousLogLevelsWhenRaiiLogIsCalledThenPrependTheLogWithLo
     log(LogLevel::Debug, &logger) << "d " << 1;
 }
 
+struct FormattingCounter {
+    size_t &count;
+};
+std::ostream &operator<<(std::ostream &out, const FormattingCounter &counter) {
+    counter.count++;
+    return out;
+}
+
+TEST(LoggerTest, givenDisabledLogLevelWhenRaiiLogIsCalledThenDoNotFormatTheMessage) {
+    MockLogger logger{};
+    logger.setEnabledLogLevels(LogLevel::Error);
+    EXPECT_CALL(logger, log(LogLevel::Error, "a"));
+
+    size_t formattingsCount = 0u;
+    log(LogLevel::Info, &logger) << FormattingCounter{formattingsCount} << fs::path{"path"};
+    log(LogLevel::VerboseInfo, &logger) << FormattingCounter{formattingsCount};
+    EXPECT_EQ(0u, formattingsCount);
+
+    log(LogLevel::Error, &logger) << "a" << FormattingCounter{formattingsCount};
+    EXPECT_EQ(1u, formattingsCount);
+}
+
+TEST(LoggerTest, whenMultiplexedLoggerIsCreatedThenEnableLevelsOfAllItsLoggers) {
+    MockLogger logger1{};
+    MockLogger logger2{};
+    logger1.setEnabledLogLevels(LogLevel::Error);
+    logger2.setEnabledLogLevels(LogLevel::Info | LogLevel::Warning);
+
+    MultiplexedLogger logger{};
+    EXPECT_EQ(LogLevel(0), logger.getEnabledLogLevels());
+    logger.add(&logger1, &logger2);
+    EXPECT_EQ(LogLevel::Error | LogLevel::Info | LogLevel::Warning, logger.getEnabledLogLevels());
+    EXPECT_FALSE(logger.isLevelEnabled(LogLevel::VerboseInfo));
+}
+
+TEST(LoggerTest, givenFormattingFlagsChangedWhenNextMessageIsLoggedThenUseDefaultFlags) {
+    MockLogger logger{};
+    EXPECT_CALL(logger, log(LogLevel::Info, "ff"));
+    EXPECT_CALL(logger, log(LogLevel::Info, "255"));
+
+    log(LogLevel::Info, &logger) << std::hex << 255;
+    log(LogLevel::Info, &logger) << 255;
+}
+
+TEST(LoggerTest, givenMessageIsLoggedWhileFormattingAnotherMessageThenLogBothMessages) {
+    MockLogger logger{};
+    EXPECT_CALL(logger, log(LogLevel::Info, "inner"));
+    EXPECT_CALL(logger, log(LogLevel::Info, "outer 1"));
+
+    const auto logInner = [&]() {
+        log(LogLevel::Info, &logger) << "inner";
+        return 1;
+    };
+    log(LogLevel::Info, &logger) << "outer " << logInner();
+}
+
 TEST(LoggerTest, givenLoggerIsSetUpWhenLogFunctionIsCalledThenUsedTheLogger) {
     MockLogger logger1{};
     MockLogger logger2{};
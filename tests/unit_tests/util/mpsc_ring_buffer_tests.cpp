@@ -0,0 +1,62 @@
+#include "charon/util/mpsc_ring_buffer.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(MpscRingBufferTest, givenPublishedValuesWhenConsumingThenReturnThemInOrder) {
+    MpscRingBuffer<int> ring{4, RingOverflowPolicy::Block};
+    for (int value : {1, 2, 3}) {
+        size_t position{};
+        EXPECT_TRUE(ring.reserve(position));
+        ring.at(position) = value;
+        ring.publish(position);
+    }
+    EXPECT_EQ(3u, ring.size());
+
+    for (int expectedValue : {1, 2, 3}) {
+        ASSERT_NE(nullptr, ring.front());
+        EXPECT_EQ(expectedValue, *ring.front());
+        ring.pop();
+    }
+    EXPECT_EQ(nullptr, ring.front());
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(MpscRingBufferTest, givenReservedButUnpublishedValueWhenConsumingThenDoNotReturnIt) {
+    MpscRingBuffer<int> ring{4, RingOverflowPolicy::Block};
+    size_t position{};
+    EXPECT_TRUE(ring.reserve(position));
+    EXPECT_EQ(nullptr, ring.front());
+    EXPECT_TRUE(ring.isEmpty());
+
+    ring.publish(position);
+    EXPECT_NE(nullptr, ring.front());
+}
+
+TEST(MpscRingBufferTest, givenDropPolicyAndFullRingWhenReservingThenFailUntilValueIsConsumed) {
+    MpscRingBuffer<int> ring{2, RingOverflowPolicy::Drop};
+    size_t position{};
+    for (size_t i = 0; i < ring.getCapacity(); i++) {
+        EXPECT_TRUE(ring.reserve(position));
+        ring.publish(position);
+    }
+    EXPECT_FALSE(ring.reserve(position));
+
+    ring.pop();
+    EXPECT_TRUE(ring.reserve(position));
+}
+
+TEST(MpscRingBufferTest, givenConsumedValueWhenSlotIsReusedThenKeepItsBuffer) {
+    MpscRingBuffer<std::string> ring{2, RingOverflowPolicy::Block};
+    ring.at(0).reserve(100);
+    const size_t capacity = ring.at(0).capacity();
+
+    size_t position{};
+    for (size_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(ring.reserve(position));
+        ring.at(position).assign("message");
+        ring.publish(position);
+        ring.pop();
+    }
+    EXPECT_EQ(capacity, ring.at(0).capacity());
+}
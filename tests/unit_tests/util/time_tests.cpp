@@ -0,0 +1,35 @@
+#include "charon/util/time.h"
+
+#include <gtest/gtest.h>
+#include <iomanip>
+#include <sstream>
+
+std::string formatWithStream(std::time_t time) {
+    std::ostringstream out{};
+    out << std::put_time(std::localtime(&time), "%d-%m-%Y %H:%M:%S");
+    return out.str();
+}
+
+std::string formatWithTimeImpl(std::time_t time) {
+    std::ostringstream out{};
+    TimeImpl::writeTime(out, time);
+    return out.str();
+}
+
+TEST(TimeTest, givenTheSameAndDifferentSecondsWhenWritingTimeThenTextIsTheSameAsFormattedByStream) {
+    const std::time_t time = 1700000000;
+    for (std::time_t value : {time, time, time + 1, time + 1, time + 3600 * 24 * 40, time}) {
+        EXPECT_EQ(formatWithStream(value), formatWithTimeImpl(value));
+    }
+}
+
+TEST(TimeTest, whenWritingCurrentTimeThenWriteTimeOfTheCurrentSecond) {
+    const std::time_t before = std::time(nullptr);
+    std::ostringstream out{};
+    TimeImpl{}.writeCurrentTime(out);
+    const std::time_t after = std::time(nullptr);
+
+    // Coarse clock can lag behind by a few milliseconds
+    const std::string text = out.str();
+    EXPECT_TRUE(text == formatWithStream(before - 1) || text == formatWithStream(before) || text == formatWithStream(after)) << text;
+}
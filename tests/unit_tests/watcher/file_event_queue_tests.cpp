@@ -0,0 +1,153 @@
+#include "charon/watcher/file_event_queue.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static FileEvent createEvent(const char *fileName, FileEvent::Type type = FileEvent::Type::Add) {
+    return FileEvent{"/watched", type, fs::path{"/watched"} / fileName};
+}
+
+TEST(FileEventQueueTest, givenUnboundedQueueWhenPushingEventsThenAllEventsArePoppedInOrder) {
+    FileEventQueue queue{};
+    queue.push(createEvent("a"));
+    std::vector<FileEvent> batch{createEvent("b"), createEvent("c")};
+    queue.pushBatch(batch);
+    EXPECT_TRUE(batch.empty());
+    EXPECT_EQ(3u, queue.size());
+    EXPECT_EQ(3u, queue.getHighWaterMark());
+
+    FileEvent event{};
+    for (const char *fileName : {"a", "b", "c"}) {
+        EXPECT_TRUE(queue.nonBlockingPop(event));
+        EXPECT_EQ(createEvent(fileName), event);
+    }
+    EXPECT_FALSE(queue.nonBlockingPop(event));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(FileEventQueueTest, givenBlockPolicyWhenQueueIsFullThenProducerWaitsForConsumer) {
+    FileEventQueue queue{};
+    queue.setCapacity(2, FileEventQueue::OverflowPolicy::Block);
+    queue.push(createEvent("a"));
+    queue.push(createEvent("b"));
+
+    std::atomic_bool pushed = false;
+    std::thread producer{[&]() {
+        queue.push(createEvent("c"));
+        pushed = true;
+    }};
+    std::this_thread::sleep_for(10ms);
+    EXPECT_FALSE(pushed.load());
+
+    FileEvent event{};
+    EXPECT_TRUE(queue.blockingPop(event, 1s));
+    EXPECT_EQ(createEvent("a"), event);
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+
+    for (const char *fileName : {"b", "c"}) {
+        EXPECT_TRUE(queue.blockingPop(event, 1s));
+        EXPECT_EQ(createEvent(fileName), event);
+    }
+    EXPECT_EQ(2u, queue.getHighWaterMark());
+}
+
+TEST(FileEventQueueTest, givenSpillPolicyWhenQueueIsFullThenEventsAreSpilledAndPoppedInOrder) {
+    const fs::path journalPath = fs::temp_directory_path() / "charon_file_event_queue_tests.journal";
+    {
+        FileEventQueue queue{};
+        queue.setCapacity(2, FileEventQueue::OverflowPolicy::Spill, journalPath);
+        for (const char *fileName : {"a", "b", "c", "d", "e"}) {
+            queue.push(createEvent(fileName));
+        }
+        EXPECT_EQ(5u, queue.size());
+        EXPECT_EQ(5u, queue.getHighWaterMark());
+        EXPECT_EQ(3u, queue.getSpilledEventsCount());
+        EXPECT_TRUE(fs::exists(journalPath));
+
+        FileEvent event{};
+        for (const char *fileName : {"a", "b", "c", "d"}) {
+            EXPECT_TRUE(queue.blockingPop(event, 1s));
+            EXPECT_EQ(createEvent(fileName), event);
+        }
+        queue.push(createEvent("f"));
+        for (const char *fileName : {"e", "f"}) {
+            EXPECT_TRUE(queue.blockingPop(event, 1s));
+            EXPECT_EQ(createEvent(fileName), event);
+        }
+        EXPECT_TRUE(queue.empty());
+        EXPECT_FALSE(queue.blockingPop(event, 1ms));
+    }
+    EXPECT_FALSE(fs::exists(journalPath));
+}
+
+TEST(FileEventQueueTest, givenSpillPolicyAndWaitingConsumerWhenEventsAreSpilledThenConsumerReceivesThem) {
+    const fs::path journalPath = fs::temp_directory_path() / "charon_file_event_queue_tests.journal";
+    FileEventQueue queue{};
+    queue.setCapacity(2, FileEventQueue::OverflowPolicy::Spill, journalPath);
+
+    constexpr size_t eventsCount = 1000;
+    std::thread producer{[&]() {
+        for (size_t i = 0; i < eventsCount; i++) {
+            queue.push(createEvent(std::to_string(i).c_str()));
+        }
+    }};
+
+    FileEvent event{};
+    for (size_t i = 0; i < eventsCount; i++) {
+        ASSERT_TRUE(queue.blockingPop(event, 10s));
+        EXPECT_EQ(createEvent(std::to_string(i).c_str()), event);
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(FileEventQueueTest, givenCoalescePolicyWhenQueueIsFullThenDuplicatedEventsAreDropped) {
+    FileEventQueue queue{};
+    queue.setCapacity(2, FileEventQueue::OverflowPolicy::Coalesce);
+    queue.push(createEvent("a"));
+    queue.push(createEvent("b", FileEvent::Type::Modify));
+    queue.push(createEvent("a"));
+    queue.push(createEvent("b", FileEvent::Type::Modify));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(2u, queue.getCoalescedEventsCount());
+
+    FileEvent event{};
+    EXPECT_TRUE(queue.nonBlockingPop(event));
+    EXPECT_EQ(createEvent("a"), event);
+
+    // Event of a different type is not a duplicate
+    queue.push(createEvent("b"));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(2u, queue.getCoalescedEventsCount());
+
+    EXPECT_TRUE(queue.nonBlockingPop(event));
+    EXPECT_EQ(createEvent("b", FileEvent::Type::Modify), event);
+    EXPECT_TRUE(queue.nonBlockingPop(event));
+    EXPECT_EQ(createEvent("b"), event);
+    EXPECT_FALSE(queue.nonBlockingPop(event));
+}
+
+TEST(FileEventQueueTest, givenCoalescePolicyWhenQueueIsNotFullThenDuplicatedEventsAreKept) {
+    FileEventQueue queue{};
+    queue.setCapacity(4, FileEventQueue::OverflowPolicy::Coalesce);
+    queue.push(createEvent("a"));
+    queue.push(createEvent("a"));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(0u, queue.getCoalescedEventsCount());
+}
+
+TEST(FileEventQueueTest, givenBoundedQueueWhenBlockingPopIsInterruptedThenReturnFalse) {
+    FileEventQueue queue{};
+    queue.setCapacity(2, FileEventQueue::OverflowPolicy::Spill, fs::temp_directory_path() / "charon_file_event_queue_tests.journal");
+    FileEvent event{};
+    bool popResult = true;
+    std::thread consumer{[&]() {
+        popResult = queue.blockingPop(event);
+    }};
+    queue.interruptBlockingPop();
+    consumer.join();
+    EXPECT_FALSE(popResult);
+}